@@ -0,0 +1,406 @@
+#include "Behavior.h"
+#include "DogActions.h"
+#include "Servo.h"
+#include "Posture.h"
+#include "Delay.h"
+#include "Buzzer.h"
+#include "LED.h"
+#include "Key.h"
+#include "Ultrasonic.h"
+#include "IMU.h"
+#include "PowerGovernor.h"
+#include "FlashStore.h"
+#include "Locomotion.h"
+#include "Profile.h"
+#include "EventBus.h"
+#include <stddef.h>
+
+#define BEHAVIOR_VERSION    1   // 指令编码或记录格式改变时加1
+#define BEHAVIOR_RUN_POLL_MS 5  // Behavior_Run等待时的查询间隔
+#define BEHAVIOR_NO_EVENT   0xFF // 后台执行时不发布动作事件
+
+// Flash记录：长度 + 程序，长度固定
+typedef struct {
+    uint8_t length;
+    uint8_t reserved[3];
+    uint8_t code[BEHAVIOR_CODE_MAX];
+} BehaviorRecord;
+
+// 各指令的字节数（含操作码），解码时先按它检查不越界，执行时不再逐个检查操作数
+static const uint8_t OpLength[BHV_OP_NUM] = {
+    1, // END
+    5, // POSE
+    3, // SERVO
+    7, // MOVE
+    1, // STAND
+    3, // WAIT
+    2, // LOOP
+    1, // NEXT
+    3, // BEEP
+    3, // LED
+    2, // JUMP
+    6, // BRANCH
+    2, // POSTURE
+    1, // YIELD
+};
+
+// 内置行为，原来DogActions里手写的动作
+static const uint8_t HelloCode[] = {
+    BHV_LOOP(2),
+        BHV_SERVO(SERVO_FRONT_RIGHT, 45), BHV_WAIT(300), // 抬起右前腿挥手
+        BHV_SERVO(SERVO_FRONT_RIGHT, 90), BHV_WAIT(300), // 放下
+    BHV_NEXT(),
+    BHV_STAND(),
+    BHV_END()
+};
+
+static const uint8_t SitDownCode[] = {
+    BHV_POSTURE(0),
+    BHV_MOVE(60, 120, 120, 60, 30 * DOG_POSE_MS_PER_DEG), // 髋关节各转30度，时长与原来的姿态切换相同
+    BHV_WAIT(1000),
+    BHV_END()
+};
+
+static const uint8_t ShakeBodyCode[] = {
+    BHV_POSTURE(0),
+    BHV_LOOP(3),
+        BHV_POSE(95, 85, 95, 85), BHV_WAIT(150),
+        BHV_POSE(85, 95, 85, 95), BHV_WAIT(150),
+    BHV_NEXT(),
+    BHV_STAND(),
+    BHV_END()
+};
+
+static void (* const LedOn[4])(void) = {LED1_ON, LED2_ON, LED3_ON, LED4_ON};
+static void (* const LedOff[4])(void) = {LED1_OFF, LED2_OFF, LED3_OFF, LED4_OFF};
+
+// 后台执行内置行为时发布的动作事件来源(DogMode)，与DogActions里阻塞执行时相同
+static const uint8_t LaunchModes[BEHAVIOR_NUM] = {
+    BEHAVIOR_NO_EVENT, MODE_HELLO, MODE_SIT_DOWN, MODE_SHAKE_BODY
+};
+
+static BehaviorRecord user;
+static BehaviorVM task;    // 后台行为，status不是BHV_RUNNING时空闲
+static uint8_t task_mode = BEHAVIOR_NO_EVENT;
+
+static uint16_t Behavior_U16(const uint8_t *p)
+{
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint8_t Behavior_Fail(BehaviorVM *vm)
+{
+    Behavior_Stop(vm);
+    vm->status = BHV_ERROR;
+    return 0;
+}
+
+// 相对跳转：偏移从下一条指令算起，可以跳到程序末尾（等于结束）
+static uint8_t Behavior_Jump(BehaviorVM *vm, uint8_t rel)
+{
+    int32_t target = (int32_t)vm->pc + (int8_t)rel;
+
+    if(target < 0 || target > vm->length) return 0;
+    vm->pc = (uint16_t)target;
+    return 1;
+}
+
+// 传感器读数，单位见BehaviorSensor；超声波还没有有效读数时按最远算，不会误触发"太近"
+static int32_t Behavior_ReadSensor(uint8_t sensor)
+{
+    UltrasonicSample sample;
+    IMU_Attitude att;
+    int32_t value = 0;
+    uint8_t i;
+
+    switch(sensor) {
+        case BHV_SENSOR_DISTANCE:
+            sample = Ultrasonic_GetSample();
+            value = sample.valid ? (int32_t)sample.distance : 0xFFFF;
+            break;
+        case BHV_SENSOR_PITCH:
+            IMU_GetAttitude(&att);
+            value = att.pitch / 1000;
+            break;
+        case BHV_SENSOR_ROLL:
+            IMU_GetAttitude(&att);
+            value = att.roll / 1000;
+            break;
+        case BHV_SENSOR_BATTERY:
+            value = PowerGovernor_GetBattery_mV();
+            break;
+        case BHV_SENSOR_KEY:
+            for(i = 0; i < KEY_NUM; i++) {
+                if(Key_IsPressed(i + 1)) value |= 1 << i;
+            }
+            break;
+    }
+    return value;
+}
+
+void Behavior_Start(BehaviorVM *vm, const uint8_t *code, uint16_t length)
+{
+    vm->code = code;
+    vm->length = length;
+    vm->pc = 0;
+    vm->loop_depth = 0;
+    vm->wait_move = 0;
+    vm->beeping = 0;
+    vm->wait_until = Delay_GetTick();
+    vm->status = BHV_RUNNING;
+}
+
+// 停止解释，舵机停在当前设定的角度（插值由DogActions继续走完）
+void Behavior_Stop(BehaviorVM *vm)
+{
+    if(vm->beeping) Buzzer_Off();
+    vm->beeping = 0;
+    vm->wait_move = 0;
+    if(vm->status == BHV_RUNNING) vm->status = BHV_STOPPED;
+}
+
+/**
+  * @brief  执行行为，直到遇到等待类指令或用完本次的指令数
+  * @param  vm: 解释器状态
+  * @retval 1还在运行，0已结束（status为BHV_DONE/BHV_STOPPED/BHV_ERROR）
+  * @detail 每条指令先按OpLength检查不越界，然后由一个switch分派；
+  *         等待中的调用只比较一次时间或插值标志就返回。Dog_Abort会让行为停止
+  */
+uint8_t Behavior_Step(BehaviorVM *vm)
+{
+    const uint8_t *p;
+    uint8_t op, budget, i;
+    int32_t value;
+
+    if(vm->status != BHV_RUNNING) return 0;
+    if(Dog_IsAborted()) {
+        Behavior_Stop(vm);
+        return 0;
+    }
+    if(vm->wait_move) {
+        if(Dog_IsMoving()) return 1;
+        vm->wait_move = 0;
+    }
+    if((int32_t)(Delay_GetTick() - vm->wait_until) < 0) return 1;
+    if(vm->beeping) {
+        Buzzer_Off();
+        vm->beeping = 0;
+    }
+
+    for(budget = BEHAVIOR_STEP_BUDGET; budget; budget--) {
+        if(vm->pc >= vm->length) break; // 程序末尾没有END也算结束
+        op = vm->code[vm->pc];
+        if(op >= BHV_OP_NUM || vm->pc + OpLength[op] > vm->length) return Behavior_Fail(vm);
+        p = &vm->code[vm->pc + 1];
+        vm->pc += OpLength[op];
+
+        switch(op) {
+            case BHV_OP_END:
+                vm->status = BHV_DONE;
+                return 0;
+
+            case BHV_OP_POSE:
+                Dog_StartPose(p[0], p[1], p[2], p[3], 0, TRAJ_MIN_JERK);
+                break;
+
+            case BHV_OP_SERVO:
+                if(p[0] < 1 || p[0] > SERVO_NUM) return Behavior_Fail(vm);
+                Servo_SetCommand(p[0], p[1]);
+                break;
+
+            case BHV_OP_MOVE:
+                Dog_StartPose(p[0], p[1], p[2], p[3], Behavior_U16(&p[4]), TRAJ_MIN_JERK);
+                vm->wait_move = 1;
+                return 1;
+
+            case BHV_OP_STAND:
+                Dog_StartStand();
+                vm->wait_move = 1;
+                return 1;
+
+            case BHV_OP_WAIT:
+                vm->wait_until = Delay_GetTick() + Behavior_U16(p);
+                return 1;
+
+            case BHV_OP_LOOP:
+                if(vm->loop_depth >= BEHAVIOR_LOOP_DEPTH) return Behavior_Fail(vm);
+                vm->loop_pc[vm->loop_depth] = vm->pc;
+                vm->loop_count[vm->loop_depth] = p[0] ? p[0] : 1; // 0次按1次
+                vm->loop_depth++;
+                break;
+
+            case BHV_OP_NEXT:
+                if(vm->loop_depth == 0) return Behavior_Fail(vm);
+                if(--vm->loop_count[vm->loop_depth - 1]) {
+                    vm->pc = vm->loop_pc[vm->loop_depth - 1];
+                } else {
+                    vm->loop_depth--;
+                }
+                break;
+
+            case BHV_OP_BEEP:
+                Buzzer_On();
+                vm->beeping = 1;
+                vm->wait_until = Delay_GetTick() + Behavior_U16(p);
+                return 1;
+
+            case BHV_OP_LED:
+                for(i = 0; i < 4; i++) {
+                    if(!(p[0] & (1 << i))) continue;
+                    if(p[1] & (1 << i)) LedOn[i](); else LedOff[i]();
+                }
+                break;
+
+            case BHV_OP_JUMP:
+                if(!Behavior_Jump(vm, p[0])) return Behavior_Fail(vm);
+                break;
+
+            case BHV_OP_BRANCH:
+                if(p[0] >= BHV_SENSOR_NUM || p[1] > BHV_CMP_EQ) return Behavior_Fail(vm);
+                value = Behavior_ReadSensor(p[0]);
+                if((p[1] == BHV_CMP_LT && value < (int16_t)Behavior_U16(&p[2])) ||
+                   (p[1] == BHV_CMP_GT && value > (int16_t)Behavior_U16(&p[2])) ||
+                   (p[1] == BHV_CMP_EQ && value == (int16_t)Behavior_U16(&p[2]))) {
+                    if(!Behavior_Jump(vm, p[4])) return Behavior_Fail(vm);
+                }
+                break;
+
+            case BHV_OP_POSTURE:
+                Posture_Enable(p[0]);
+                break;
+
+            case BHV_OP_YIELD:
+                return 1;
+        }
+    }
+    if(vm->pc >= vm->length) {
+        vm->status = BHV_DONE;
+        return 0;
+    }
+    return 1; // 本次的指令数用完（例如没有等待的循环），下次接着执行
+}
+
+const uint8_t *Behavior_GetCode(BehaviorId id, uint16_t *length)
+{
+    switch(id) {
+        case BEHAVIOR_USER:       *length = user.length;          return user.code;
+        case BEHAVIOR_HELLO:      *length = sizeof(HelloCode);     return HelloCode;
+        case BEHAVIOR_SIT_DOWN:   *length = sizeof(SitDownCode);   return SitDownCode;
+        case BEHAVIOR_SHAKE_BODY: *length = sizeof(ShakeBodyCode); return ShakeBodyCode;
+        default:                  *length = 0;                    return NULL;
+    }
+}
+
+/**
+  * @brief  阻塞执行一个行为到结束
+  * @param  id: 哪个行为
+  * @retval 1执行完，0被Dog_Abort中止、程序出错或为空
+  */
+uint8_t Behavior_Run(BehaviorId id)
+{
+    BehaviorVM vm;
+    uint16_t length;
+    const uint8_t *code = Behavior_GetCode(id, &length);
+
+    if(code == NULL || length == 0) return 0;
+    Behavior_Start(&vm, code, length);
+    while(Behavior_Step(&vm)) {
+        Delay_ms(BEHAVIOR_RUN_POLL_MS);
+    }
+    return vm.status == BHV_DONE;
+}
+
+// 后台行为结束：内置动作发布完成/取消事件
+static void Behavior_Finish(void)
+{
+    if(task_mode == BEHAVIOR_NO_EVENT) return;
+    EventBus_Publish(task.status == BHV_DONE ? EVENT_ACTION_COMPLETE : EVENT_ACTION_CANCEL, task_mode, 0);
+    task_mode = BEHAVIOR_NO_EVENT;
+}
+
+/**
+  * @brief  在后台启动一个行为，立即返回
+  * @param  id: 哪个行为，正在执行的后台行为先被取消
+  * @retval 1已启动，0程序为空
+  * @detail 内置动作和阻塞执行时一样发布开始/完成/取消事件；
+  *         连续步态正在收步时先等它回到站姿，再开始执行
+  */
+uint8_t Behavior_Launch(BehaviorId id)
+{
+    uint16_t length;
+    const uint8_t *code = Behavior_GetCode(id, &length);
+
+    Behavior_Cancel();
+    if(code == NULL || length == 0) return 0;
+    Behavior_Start(&task, code, length);
+    task_mode = LaunchModes[id];
+    if(task_mode != BEHAVIOR_NO_EVENT) EventBus_Publish(EVENT_ACTION_START, task_mode, 0);
+    return 1;
+}
+
+void Behavior_Cancel(void)
+{
+    if(task.status != BHV_RUNNING) return;
+    Behavior_Stop(&task);
+    Behavior_Finish();
+}
+
+uint8_t Behavior_IsRunning(void)
+{
+    return task.status == BHV_RUNNING;
+}
+
+void Behavior_Task(void)
+{
+    PROFILE_BEGIN(PROFILE_BEHAVIOR_STEP);
+    if(Locomotion_GetCommand() != LOCO_STOP) {
+        Behavior_Cancel(); // 开始走路后让给步态，两者不能同时驱动舵机
+    } else if(!Locomotion_IsRunning() && task.status == BHV_RUNNING) {
+        if(!Behavior_Step(&task)) Behavior_Finish(); // 步态收步期间不执行，回到站姿后再继续
+    }
+    PROFILE_END(PROFILE_BEHAVIOR_STEP);
+}
+
+// 用户程序被改写前先停下正在执行它的后台行为
+static void Behavior_ReleaseUser(void)
+{
+    if(task.code == user.code) Behavior_Cancel();
+}
+
+void Behavior_UserClear(void)
+{
+    Behavior_ReleaseUser();
+    user.length = 0;
+}
+
+uint8_t Behavior_UserAppend(const uint8_t *data, uint8_t length)
+{
+    uint8_t i;
+
+    if(user.length + length > BEHAVIOR_CODE_MAX) return 0;
+    for(i = 0; i < length; i++) {
+        user.code[user.length + i] = data[i]; // 后台行为按启动时的长度执行，追加不影响它
+    }
+    user.length += length;
+    return 1;
+}
+
+uint8_t Behavior_UserSave(void)
+{
+    return FlashStore_Save(FLASH_STORE_BEHAVIOR, BEHAVIOR_VERSION, &user, sizeof(user));
+}
+
+// 直接读到user里（失败时不改动）
+uint8_t Behavior_UserLoad(void)
+{
+    Behavior_ReleaseUser();
+    if(!FlashStore_Load(FLASH_STORE_BEHAVIOR, BEHAVIOR_VERSION, &user, sizeof(user))) return 0;
+    if(user.length > BEHAVIOR_CODE_MAX) user.length = 0;
+    return user.length != 0;
+}
+
+void Behavior_Init(void)
+{
+    task.status = BHV_DONE;
+    Behavior_UserLoad();
+}
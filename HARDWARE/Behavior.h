@@ -0,0 +1,128 @@
+#ifndef __BEHAVIOR_H
+#define __BEHAVIOR_H
+
+#include "stm32f10x.h"
+
+// 行为字节码：动作写成一串字节，由解释器逐条执行，不再是手写的舵机/延时循环。
+// 等待类指令（WAIT/MOVE/STAND/BEEP/YIELD）只记下条件就让出，解释器在主循环里协作式运行，
+// 每次调用最多执行BEHAVIOR_STEP_BUDGET条指令；也可以用Behavior_Run阻塞跑完（DogActions的单次动作）。
+// 指令格式：1字节操作码 + 操作数，16位数小端，角度单位度，跳转偏移相对下一条指令
+//   END                          结束
+//   POSE  fl fr rl rr            四个髋关节直接设定（经过舵机限速）
+//   SERVO id angle               单个舵机直接设定
+//   MOVE  fl fr rl rr ms16       髋关节最小加加速度过渡，走完再继续
+//   STAND                        过渡到标定的站姿，走完再继续
+//   WAIT  ms16                   等待
+//   LOOP  n                      循环开始，与NEXT之间的指令执行n次（最多嵌套BEHAVIOR_LOOP_DEPTH层）
+//   NEXT                         循环结束
+//   BEEP  ms16                   蜂鸣器响ms，响完再继续
+//   LED   mask value             LED1~LED4对应bit0~bit3，mask中的灯设为value对应位
+//   JUMP  rel8                   无条件跳转
+//   BRANCH sensor cmp value16 rel8  传感器读数与value比较，成立则跳转
+//   POSTURE on                   打开/关闭姿态闭环
+//   YIELD                        让出到下一次调用
+// 新的行为可通过蓝牙上传到用户程序区并保存在Flash，见Bluetooth.c的$BHV命令
+
+#define BEHAVIOR_CODE_MAX       128   // 用户程序最大字节数
+#define BEHAVIOR_LOOP_DEPTH     4
+#define BEHAVIOR_STEP_BUDGET    16    // 每次Behavior_Step最多执行的指令数
+
+typedef enum {
+    BHV_OP_END = 0,
+    BHV_OP_POSE,
+    BHV_OP_SERVO,
+    BHV_OP_MOVE,
+    BHV_OP_STAND,
+    BHV_OP_WAIT,
+    BHV_OP_LOOP,
+    BHV_OP_NEXT,
+    BHV_OP_BEEP,
+    BHV_OP_LED,
+    BHV_OP_JUMP,
+    BHV_OP_BRANCH,
+    BHV_OP_POSTURE,
+    BHV_OP_YIELD,
+    BHV_OP_NUM
+} BehaviorOp;
+
+typedef enum {
+    BHV_SENSOR_DISTANCE = 0, // 超声波距离(cm)
+    BHV_SENSOR_PITCH,        // 俯仰(度)，抬头为正
+    BHV_SENSOR_ROLL,         // 横滚(度)
+    BHV_SENSOR_BATTERY,      // 电池电压(mV)
+    BHV_SENSOR_KEY,          // 按下的按键，K1~K4对应bit0~bit3
+    BHV_SENSOR_NUM
+} BehaviorSensor;
+
+typedef enum {
+    BHV_CMP_LT = 0,
+    BHV_CMP_GT,
+    BHV_CMP_EQ
+} BehaviorCompare;
+
+typedef enum {
+    BHV_RUNNING = 0,
+    BHV_DONE,
+    BHV_STOPPED,             // Behavior_Stop或动作被中止
+    BHV_ERROR                // 非法指令、越界跳转、循环嵌套过深
+} BehaviorStatus;
+
+// 在C代码里写字节码用的宏
+#define BHV_U16(x)                  ((x) & 0xFF), (((x) >> 8) & 0xFF)
+#define BHV_END()                   BHV_OP_END
+#define BHV_POSE(fl, fr, rl, rr)    BHV_OP_POSE, (fl), (fr), (rl), (rr)
+#define BHV_SERVO(id, angle)        BHV_OP_SERVO, (id), (angle)
+#define BHV_MOVE(fl, fr, rl, rr, ms) BHV_OP_MOVE, (fl), (fr), (rl), (rr), BHV_U16(ms)
+#define BHV_STAND()                 BHV_OP_STAND
+#define BHV_WAIT(ms)                BHV_OP_WAIT, BHV_U16(ms)
+#define BHV_LOOP(n)                 BHV_OP_LOOP, (n)
+#define BHV_NEXT()                  BHV_OP_NEXT
+#define BHV_BEEP(ms)                BHV_OP_BEEP, BHV_U16(ms)
+#define BHV_LED(mask, value)        BHV_OP_LED, (mask), (value)
+#define BHV_JUMP(rel)               BHV_OP_JUMP, (uint8_t)(rel)
+#define BHV_BRANCH(sensor, cmp, value, rel) BHV_OP_BRANCH, (sensor), (cmp), BHV_U16((uint16_t)(value)), (uint8_t)(rel)
+#define BHV_POSTURE(on)             BHV_OP_POSTURE, (on)
+#define BHV_YIELD()                 BHV_OP_YIELD
+
+// 内置行为，BEHAVIOR_USER是蓝牙上传的用户程序
+typedef enum {
+    BEHAVIOR_USER = 0,
+    BEHAVIOR_HELLO,
+    BEHAVIOR_SIT_DOWN,
+    BEHAVIOR_SHAKE_BODY,
+    BEHAVIOR_NUM
+} BehaviorId;
+
+typedef struct {
+    const uint8_t *code;
+    uint16_t length;
+    uint16_t pc;
+    uint16_t loop_pc[BEHAVIOR_LOOP_DEPTH];    // 循环体第一条指令
+    uint8_t loop_count[BEHAVIOR_LOOP_DEPTH];  // 剩余次数
+    uint8_t loop_depth;
+    uint8_t wait_move;       // 等舵机插值走完
+    uint8_t beeping;         // 等待结束时关蜂鸣器
+    uint32_t wait_until;     // 等到这个时刻(ms)
+    uint8_t status;          // BehaviorStatus
+} BehaviorVM;
+
+void Behavior_Init(void);                                   // 从Flash读回用户程序
+void Behavior_Start(BehaviorVM *vm, const uint8_t *code, uint16_t length);
+uint8_t Behavior_Step(BehaviorVM *vm);                      // 执行到让出为止，返回0表示已结束
+void Behavior_Stop(BehaviorVM *vm);
+uint8_t Behavior_Run(BehaviorId id);                        // 阻塞执行到结束，返回0表示被中止或出错
+const uint8_t *Behavior_GetCode(BehaviorId id, uint16_t *length);
+
+// 后台行为：在主循环里协作式运行，同一时间只有一个
+uint8_t Behavior_Launch(BehaviorId id);                     // 返回0表示程序为空；内置动作结束时发布动作事件
+void Behavior_Cancel(void);
+uint8_t Behavior_IsRunning(void);
+void Behavior_Task(void);                                   // 主循环中调用
+
+// 用户程序：上传、保存
+void Behavior_UserClear(void);
+uint8_t Behavior_UserAppend(const uint8_t *data, uint8_t length); // 返回0表示超出BEHAVIOR_CODE_MAX
+uint8_t Behavior_UserSave(void);
+uint8_t Behavior_UserLoad(void);
+
+#endif
@@ -1,15 +1,44 @@
 #include "Bluetooth.h"
 #include "stm32f10x_usart.h"
 #include "Delay.h"
-#include "stdio.h"
+#include "Format.h"
 #include "DogActions.h"
+#include "ControlSystem.h"
+#include "EventBus.h"
+#include "Locomotion.h"
+#include "Macro.h"
+#include "Behavior.h"
+#include "Profile.h"
+#include "OLED.h"
 
 // 全局变量
-static volatile uint8_t rx_buffer[256];
-static volatile uint16_t rx_index = 0;
+static volatile char rx_buffer[BT_LINE_MAX];  // '$'开头的文本行
+static volatile uint8_t rx_index = 0;
+static volatile uint8_t line_mode = 0;         // 正在接收文本行
+static volatile uint8_t line_received = 0;     // 一行已收完，等待Bluetooth_GetLine取走
 static volatile uint8_t command_received = 0;
 static volatile uint8_t current_command = 0;
-static WorkMode current_mode = MODE_MANUAL;
+static uint32_t action_start_time = 0;
+
+// 动作事件上报（总线回调）："ACT: <DogMode> done|cancel <步数> steps <耗时> ms"
+static void Bluetooth_OnActionEvent(const BusEvent *e)
+{
+    char msg[40];
+    char *p = msg;
+
+    if(e->type == EVENT_ACTION_START) {
+        action_start_time = e->timestamp;
+        return;
+    }
+    p += Format_Str(p, "ACT: ");
+    p += Format_UInt(p, e->source, 0, ' ');
+    p += Format_Str(p, (e->type == EVENT_ACTION_CANCEL) ? " cancel " : " done ");
+    p += Format_UInt(p, e->arg, 0, ' ');
+    p += Format_Str(p, " steps ");
+    p += Format_UInt(p, e->timestamp - action_start_time, 0, ' ');
+    Format_Str(p, " ms\r\n");
+    Bluetooth_SendString(msg);
+}
 
 void Bluetooth_Init(void)
 {
@@ -44,7 +73,7 @@ void Bluetooth_Init(void)
     USART_ITConfig(USART2, USART_IT_RXNE, ENABLE);
     
     NVIC_InitStructure.NVIC_IRQChannel = USART2_IRQn;
-    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 1;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 1; // 高于舵机帧，9600波特率下接收不溢出
     NVIC_InitStructure.NVIC_IRQChannelSubPriority = 1;
     NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
     NVIC_Init(&NVIC_InitStructure);
@@ -55,14 +84,20 @@ void Bluetooth_Init(void)
     // 发送初始化完成信息
     Bluetooth_SendString("BT Ready\r\n");
     Bluetooth_SendString("Smart Dog Connected\r\n");
+    
+    // 每个动作结束时上报结果和耗时
+    EventBus_Subscribe(EVENT_MASK(EVENT_ACTION_START) | EVENT_MASK(EVENT_ACTION_COMPLETE) |
+                       EVENT_MASK(EVENT_ACTION_CANCEL), Bluetooth_OnActionEvent);
 }
 
 void Bluetooth_SendString(char *str)
 {
+    PROFILE_BEGIN(PROFILE_BT_SEND);
     while(*str) {
         USART_SendData(USART2, *str++);
         while(USART_GetFlagStatus(USART2, USART_FLAG_TC) == RESET);
     }
+    PROFILE_END(PROFILE_BT_SEND);
 }
 
 void Bluetooth_SendData(uint8_t *data, uint16_t len)
@@ -82,9 +117,24 @@ uint8_t Bluetooth_GetCommand(void)
     return 0;
 }
 
-WorkMode Bluetooth_GetMode(void)
+/**
+  * @brief  取走收到的文本行
+  * @param  line: 输出，不含开头的'$'和结尾的回车换行
+  * @param  size: line的大小，超长部分截掉
+  * @retval 1取到一行，0没有
+  */
+uint8_t Bluetooth_GetLine(char *line, uint8_t size)
 {
-    return current_mode;
+    uint8_t i;
+
+    if(!line_received || size == 0) return 0;
+    for(i = 0; i + 1 < size && i < rx_index; i++) {
+        line[i] = rx_buffer[i];
+    }
+    line[i] = '\0';
+    rx_index = 0;
+    line_received = 0; // 取走之后才接收下一行
+    return 1;
 }
 
 uint8_t Bluetooth_Available(void)
@@ -95,6 +145,7 @@ uint8_t Bluetooth_Available(void)
 void Bluetooth_ProcessCommand(uint8_t cmd)
 {
     char status_msg[32];
+    char *p;
     
     switch(cmd) {
         case CMD_STAND:
@@ -131,7 +182,10 @@ void Bluetooth_ProcessCommand(uint8_t cmd)
             Bluetooth_SendString("CMD: Reset\r\n");
             break;
         default:
-            sprintf(status_msg, "Unknown CMD: %c\r\n", cmd);
+            p = status_msg;
+            p += Format_Str(p, "Unknown CMD: ");
+            p += Format_Char(p, cmd);
+            Format_Str(p, "\r\n");
             Bluetooth_SendString(status_msg);
             break;
     }
@@ -140,19 +194,560 @@ void Bluetooth_ProcessCommand(uint8_t cmd)
 void Bluetooth_SendStatus(void)
 {
     char status_msg[64];
-    sprintf(status_msg, "Status: Mode=%d, Speed=%d\r\n", 
-            current_mode, Dog_GetWalkSpeed());
+    char *p = status_msg;
+    p += Format_Str(p, "Status: Mode=");
+    p += Format_Str(p, ControlSystem_GetStateName());
+    p += Format_Str(p, ", Speed=");
+    p += Format_UInt(p, Dog_GetWalkSpeed(), 0, ' ');
+    Format_Str(p, "\r\n");
     Bluetooth_SendString(status_msg);
 }
 
+// 行首是否为关键字word（后面是空格或结尾），是则跳过它
+static uint8_t Bluetooth_Match(const char **line, const char *word)
+{
+    const char *s = *line;
+
+    while(*s == ' ') s++;
+    while(*word) {
+        if(*s++ != *word++) return 0;
+    }
+    if(*s != ' ' && *s != '\0') return 0;
+    *line = s;
+    return 1;
+}
+
+// "CAL <id> <stand> <sit> <lift_high> <lift_low> <push_high> <push_low>"，角度保留一位小数
+static void Bluetooth_ReportConfig(uint8_t id)
+{
+    ServoAngles cfg = Dog_GetServoConfig(id);
+    const float values[6] = {cfg.stand, cfg.sit, cfg.lift_high, cfg.lift_low, cfg.push_high, cfg.push_low};
+    char msg[64];
+    char *p = msg;
+    uint8_t i;
+
+    p += Format_Str(p, "CAL ");
+    p += Format_UInt(p, id, 0, ' ');
+    for(i = 0; i < 6; i++) {
+        p += Format_Char(p, ' ');
+        p += Format_Fixed(p, (int32_t)(values[i] * 10.0f + 0.5f), 1, 0);
+    }
+    Format_Str(p, "\r\n");
+    Bluetooth_SendString(msg);
+}
+
+// $CAL <id> [6个角度]：不带角度时查询，带角度时修改（内存里，$SAVE才写Flash）
+static void Bluetooth_Calibrate(const char *args)
+{
+    int32_t id, v[6];
+    uint8_t n, i;
+
+    n = Format_ParseFixed(args, &id, 0);
+    if(!n || id < 1 || id > SERVO_NUM) {
+        Bluetooth_SendString("ERR: servo id\r\n");
+        return;
+    }
+    args += n;
+    for(i = 0; i < 6; i++) {
+        n = Format_ParseFixed(args, &v[i], 2);
+        if(!n) break;
+        if(v[i] < 0 || v[i] > 18000) {
+            Bluetooth_SendString("ERR: angle 0~180\r\n");
+            return;
+        }
+        args += n;
+    }
+    if(i != 0 && i != 6) {
+        Bluetooth_SendString("ERR: need 6 angles\r\n");
+        return;
+    }
+    if(i == 6) {
+        Dog_AdjustServoConfig((uint8_t)id, v[0] / 100.0f, v[1] / 100.0f, v[2] / 100.0f,
+                              v[3] / 100.0f, v[4] / 100.0f, v[5] / 100.0f);
+    }
+    Bluetooth_ReportConfig((uint8_t)id);
+}
+
+// $SLEW：上报各舵机限速起作用的帧数并清零；$SLEW <id> <速度> <加速度>：设置限速，id为0表示全部舵机
+static void Bluetooth_Slew(const char *args)
+{
+    int32_t id, speed, accel;
+    char msg[sizeof("SLEW \r\n") + (SERVO_NUM + 1) * (FORMAT_UINT_MAX_LEN + 1)]; // 总数和每个舵机各一个数字加空格，含'\0'
+    char *p = msg;
+    uint8_t n, i;
+
+    n = Format_ParseFixed(args, &id, 0);
+    if(n) {
+        args += n;
+        n = Format_ParseFixed(args, &speed, 0);
+        if(n) args += n;
+        if(!n || !Format_ParseFixed(args, &accel, 0) || id < 0 || id > SERVO_NUM || speed < 0 || accel < 0) {
+            Bluetooth_SendString("ERR: SLEW <id> <deg/s> <deg/s^2>\r\n");
+            return;
+        }
+        for(i = 1; i <= SERVO_NUM; i++) {
+            if(id == 0 || id == i) Servo_SetSlewLimit(i, (float)speed, (float)accel);
+        }
+        Bluetooth_SendString("OK: slew\r\n");
+        return;
+    }
+    p += Format_Str(p, "SLEW ");
+    p += Format_UInt(p, Servo_GetLimitCount(0), 0, ' ');
+    for(i = 1; i <= SERVO_NUM; i++) {
+        p += Format_Char(p, ' ');
+        p += Format_UInt(p, Servo_GetLimitCount(i), 0, ' ');
+    }
+    Format_Str(p, "\r\n");
+    Servo_ResetLimitCount();
+    Bluetooth_SendString(msg);
+}
+
+// "GAIT <摆幅> <支撑相> <曲线> <相位差x4>"，摆幅为度（两位小数），支撑相和相位差为‰
+static void Bluetooth_ReportGait(void)
+{
+    GaitParams g;
+    char msg[64];
+    char *p = msg;
+    uint8_t i;
+
+    Locomotion_GetGait(&g);
+    p += Format_Str(p, "GAIT ");
+    p += Format_Fixed(p, g.amplitude, 2, 0);
+    p += Format_Char(p, ' ');
+    p += Format_UInt(p, g.duty, 0, ' ');
+    p += Format_Char(p, ' ');
+    p += Format_UInt(p, g.profile, 0, ' ');
+    for(i = 0; i < GAIT_LEGS; i++) {
+        p += Format_Char(p, ' ');
+        p += Format_UInt(p, g.offset[i], 0, ' ');
+    }
+    Format_Str(p, "\r\n");
+    Bluetooth_SendString(msg);
+}
+
+/**
+  * @brief  $GAIT子命令：查询/修改连续步态的参数
+  * @param  args: "GAIT"之后的部分
+  * @retval 无
+  * @detail 不带参数时查询；<摆幅 0~45度> <支撑相 100~900‰> <曲线 0三次/1正弦> [相位差‰x4]修改，
+  *         不给相位差时保持原值；DEFAULT恢复默认的对角小跑。下一帧生效，步频和转向仍由命令决定
+  */
+static void Bluetooth_Gait(const char *args)
+{
+    GaitParams g;
+    int32_t amp, duty, profile, offset;
+    uint8_t n, i;
+
+    Locomotion_GetGait(&g);
+    if(Bluetooth_Match(&args, "DEFAULT")) {
+        GaitGen_DefaultParams(&g);
+        Locomotion_SetGait(&g);
+    } else if((n = Format_ParseFixed(args, &amp, 2)) != 0) {
+        args += n;
+        n = Format_ParseFixed(args, &duty, 0);
+        if(n) args += n;
+        if(!n || !(n = Format_ParseFixed(args, &profile, 0)) || amp < 0 || amp > 4500 ||
+           duty < 100 || duty > 900 || profile < GAIT_PROFILE_CUBIC || profile > GAIT_PROFILE_SINE) {
+            Bluetooth_SendString("ERR: GAIT <deg> <duty 100~900> <0|1> [offset x4]\r\n");
+            return;
+        }
+        args += n;
+        for(i = 0; i < GAIT_LEGS; i++) {
+            n = Format_ParseFixed(args, &offset, 0);
+            if(!n) break;
+            if(offset < 0 || offset > 999) {
+                Bluetooth_SendString("ERR: offset 0~999\r\n");
+                return;
+            }
+            g.offset[i] = (uint16_t)offset;
+            args += n;
+        }
+        if(i != 0 && i != GAIT_LEGS) {
+            Bluetooth_SendString("ERR: need 4 offsets\r\n");
+            return;
+        }
+        g.amplitude = (int16_t)amp;
+        g.duty = (uint16_t)duty;
+        g.profile = (uint8_t)profile;
+        Locomotion_SetGait(&g);
+    }
+    Bluetooth_ReportGait();
+}
+
+// $HOLD：已停发脉冲的舵机和累计停发时间（舵机·毫秒）
+static void Bluetooth_ReportHold(void)
+{
+    char msg[40];
+    char *p = msg;
+
+    p += Format_Str(p, "HOLD 0x");
+    p += Format_Hex(p, Servo_GetHeldMask(), 0);
+    p += Format_Char(p, ' ');
+    p += Format_UInt(p, Servo_GetHeldMs(), 0, ' ');
+    Format_Str(p, " ms\r\n");
+    Bluetooth_SendString(msg);
+}
+
+// $CACHE：舵机写入缓存的命中/实际写入次数
+static void Bluetooth_ReportCache(void)
+{
+    char msg[40];
+    char *p = msg;
+    uint32_t hits, misses;
+
+    Servo_GetCacheStats(&hits, &misses);
+    p += Format_Str(p, "CACHE ");
+    p += Format_UInt(p, hits, 0, ' ');
+    p += Format_Char(p, ' ');
+    p += Format_UInt(p, misses, 0, ' ');
+    Format_Str(p, "\r\n");
+    Bluetooth_SendString(msg);
+}
+
+// 一条宏步骤，格式与上传命令相同："M <间隔ms> <命令字符> <参数>"
+static void Bluetooth_SendMacroStep(const MacroStep *step)
+{
+    char msg[24];
+    char *p = msg;
+
+    p += Format_Str(p, "M ");
+    p += Format_UInt(p, step->delay_ms, 0, ' ');
+    p += Format_Char(p, ' ');
+    p += Format_Char(p, step->cmd);
+    p += Format_Char(p, ' ');
+    p += Format_UInt(p, step->arg, 0, ' ');
+    Format_Str(p, "\r\n");
+    Bluetooth_SendString(msg);
+}
+
+// $MACRO ADD <间隔ms> <命令字符> [参数]：上传一条
+static void Bluetooth_MacroAdd(const char *args)
+{
+    MacroStep step;
+    int32_t delay, arg = 0;
+    uint8_t n;
+
+    n = Format_ParseFixed(args, &delay, 0);
+    args += n;
+    while(*args == ' ') args++;
+    if(!n || delay < 0 || delay > 0xFFFF || *args < 'A' || *args > 'Z') {
+        Bluetooth_SendString("ERR: MACRO ADD <ms> <cmd> [arg]\r\n");
+        return;
+    }
+    step.cmd = *args++;
+    Format_ParseFixed(args, &arg, 0);
+    step.delay_ms = (uint16_t)delay;
+    step.arg = (uint8_t)arg;
+    Bluetooth_SendString(Macro_AddStep(&step) ? "OK: add\r\n" : "ERR: full or busy\r\n");
+}
+
+/**
+  * @brief  $MACRO子命令：录制、回放、保存和上传/下载
+  * @param  args: "MACRO"之后的部分
+  * @retval 无
+  * @detail REC开始录制（清空），STOP结束录制或回放，PLAY回放，SAVE/LOAD存取Flash，
+  *         CLEAR清空，DUMP下载（先回"MACRO <步数>"，再每步一行"M ..."），ADD上传一条
+  */
+static void Bluetooth_Macro(const char *args)
+{
+    MacroStep step;
+    char msg[24];
+    char *p = msg;
+    uint8_t i;
+
+    if(Bluetooth_Match(&args, "REC")) {
+        Macro_StartRecord();
+        Bluetooth_SendString("OK: recording\r\n");
+    } else if(Bluetooth_Match(&args, "STOP")) {
+        Macro_Stop();
+        p += Format_Str(p, "OK: ");
+        p += Format_UInt(p, Macro_GetCount(), 0, ' ');
+        Format_Str(p, " steps\r\n");
+        Bluetooth_SendString(msg);
+    } else if(Bluetooth_Match(&args, "PLAY")) {
+        Bluetooth_SendString(Macro_Play() ? "OK: playing\r\n" : "ERR: empty\r\n");
+    } else if(Bluetooth_Match(&args, "SAVE")) {
+        if(Locomotion_IsRunning()) {
+            Bluetooth_SendString("ERR: busy\r\n");
+        } else {
+            Bluetooth_SendString(Macro_Save() ? "OK: saved\r\n" : "ERR: flash\r\n");
+        }
+    } else if(Bluetooth_Match(&args, "LOAD")) {
+        Bluetooth_SendString(Macro_Load() ? "OK: loaded\r\n" : "ERR: no saved macro\r\n");
+    } else if(Bluetooth_Match(&args, "CLEAR")) {
+        Macro_Clear();
+        Bluetooth_SendString("OK: clear\r\n");
+    } else if(Bluetooth_Match(&args, "DUMP")) {
+        p += Format_Str(p, "MACRO ");
+        p += Format_UInt(p, Macro_GetCount(), 0, ' ');
+        Format_Str(p, "\r\n");
+        Bluetooth_SendString(msg);
+        for(i = 0; Macro_GetStep(i, &step); i++) {
+            Bluetooth_SendMacroStep(&step);
+        }
+    } else if(Bluetooth_Match(&args, "ADD")) {
+        Bluetooth_MacroAdd(args);
+    } else {
+        Bluetooth_SendString("ERR: MACRO REC|STOP|PLAY|SAVE|LOAD|CLEAR|DUMP|ADD\r\n");
+    }
+}
+
+// 十六进制字符的值，不是十六进制字符返回0xFF
+static uint8_t Bluetooth_HexValue(char c)
+{
+    if(c >= '0' && c <= '9') return c - '0';
+    if(c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if(c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return 0xFF;
+}
+
+// $BHV W <十六进制字节>：追加到用户程序，字节之间可以有空格，每行最多约28字节
+static void Bluetooth_BehaviorWrite(const char *args)
+{
+    uint8_t code[BT_LINE_MAX / 2];
+    uint8_t n = 0, hi, lo;
+
+    while(*args) {
+        if(*args == ' ') {
+            args++;
+            continue;
+        }
+        hi = Bluetooth_HexValue(args[0]);
+        lo = (hi == 0xFF) ? 0xFF : Bluetooth_HexValue(args[1]);
+        if(lo == 0xFF || n >= sizeof(code)) {
+            Bluetooth_SendString("ERR: BHV W <hex bytes>\r\n");
+            return;
+        }
+        code[n++] = (uint8_t)(hi << 4 | lo);
+        args += 2;
+    }
+    Bluetooth_SendString(Behavior_UserAppend(code, n) ? "OK: write\r\n" : "ERR: full\r\n");
+}
+
+// $BHV DUMP：先回"BHV <字节数>"，再每16字节一行"W <十六进制>"，格式与上传相同
+static void Bluetooth_BehaviorDump(void)
+{
+    const uint8_t *code;
+    uint16_t length, i;
+    char msg[40];
+    char *p = msg;
+
+    code = Behavior_GetCode(BEHAVIOR_USER, &length);
+    p += Format_Str(p, "BHV ");
+    p += Format_UInt(p, length, 0, ' ');
+    Format_Str(p, "\r\n");
+    Bluetooth_SendString(msg);
+    for(i = 0; i < length; i++) {
+        if(i % 16 == 0) p = msg + Format_Str(msg, "W ");
+        p += Format_Hex(p, code[i], 2);
+        if(i % 16 == 15 || i + 1 == length) {
+            Format_Str(p, "\r\n");
+            Bluetooth_SendString(msg);
+        }
+    }
+}
+
+/**
+  * @brief  $BHV子命令：行为字节码的上传、保存和后台运行
+  * @param  args: "BHV"之后的部分
+  * @retval 无
+  * @detail CLEAR清空用户程序，W追加字节，SAVE/LOAD存取Flash，DUMP下载，
+  *         RUN [编号]在后台运行（0用户程序，1挥手，2蹲下，3抖动，默认0），STOP停止
+  */
+static void Bluetooth_Behavior(const char *args)
+{
+    int32_t id = BEHAVIOR_USER;
+
+    if(Bluetooth_Match(&args, "CLEAR")) {
+        Behavior_UserClear();
+        Bluetooth_SendString("OK: clear\r\n");
+    } else if(Bluetooth_Match(&args, "W")) {
+        Bluetooth_BehaviorWrite(args);
+    } else if(Bluetooth_Match(&args, "SAVE")) {
+        if(Locomotion_IsRunning()) {
+            Bluetooth_SendString("ERR: busy\r\n");
+        } else {
+            Bluetooth_SendString(Behavior_UserSave() ? "OK: saved\r\n" : "ERR: flash\r\n");
+        }
+    } else if(Bluetooth_Match(&args, "LOAD")) {
+        Bluetooth_SendString(Behavior_UserLoad() ? "OK: loaded\r\n" : "ERR: no saved behavior\r\n");
+    } else if(Bluetooth_Match(&args, "DUMP")) {
+        Bluetooth_BehaviorDump();
+    } else if(Bluetooth_Match(&args, "RUN")) {
+        Format_ParseFixed(args, &id, 0);
+        if(id < 0 || id >= BEHAVIOR_NUM) {
+            Bluetooth_SendString("ERR: behavior id\r\n");
+        } else if(Locomotion_IsRunning()) {
+            Bluetooth_SendString("ERR: busy\r\n"); // 与步态同时驱动舵机会互相打架
+        } else {
+            Bluetooth_SendString(Behavior_Launch((BehaviorId)id) ? "OK: running\r\n" : "ERR: empty\r\n");
+        }
+    } else if(Bluetooth_Match(&args, "STOP")) {
+        Behavior_Cancel();
+        Bluetooth_SendString("OK: stop\r\n");
+    } else {
+        Bluetooth_SendString("ERR: BHV CLEAR|W|SAVE|LOAD|DUMP|RUN|STOP\r\n");
+    }
+}
+
+#if PROFILE_ENABLE
+// $PROF：每个统计中的区域一行"<名称> <次数> <最小> <平均> <最大>"，单位为CPU周期
+static void Bluetooth_SendProfile(void)
+{
+    ProfileStats stats;
+    char msg[64];
+    char *p;
+    uint8_t i;
+
+    Bluetooth_SendString("PROF zone count min avg max (cycles)\r\n");
+    for(i = 0; i < PROFILE_ZONE_NUM; i++) {
+        if(!(Profile_GetMask() & (1u << i)) || !Profile_GetStats(i, &stats)) continue;
+        p = msg;
+        p += Format_Str(p, Profile_GetName(i));
+        p += Format_Char(p, ' ');
+        p += Format_UInt(p, stats.Count, 0, ' ');
+        p += Format_Char(p, ' ');
+        p += Format_UInt(p, stats.Min, 0, ' ');
+        p += Format_Char(p, ' ');
+        p += Format_UInt(p, stats.Count ? (uint32_t)(stats.Total / stats.Count) : 0, 0, ' ');
+        p += Format_Char(p, ' ');
+        p += Format_UInt(p, stats.Max, 0, ' ');
+        Format_Str(p, "\r\n");
+        Bluetooth_SendString(msg);
+    }
+}
+
+// $PROF OLED：小字体每个区域一行"<名称> <平均>/<最大>"，单位为微秒；
+// 画完交给ControlSystem保持BT_PROFILE_OLED_MS，期间各状态不重画
+static void Bluetooth_ShowProfile(void)
+{
+    ProfileStats stats;
+    uint32_t cycles_per_us = SystemCoreClock / 1000000;
+    char msg[32];
+    char *p;
+    uint8_t i;
+
+    OLED_Clear();
+    for(i = 0; i < PROFILE_ZONE_NUM; i++) {
+        Profile_GetStats(i, &stats);
+        p = msg;
+        p += Format_Str(p, Profile_GetName(i));
+        while(p < msg + 6) *p++ = ' ';
+        p += Format_UInt(p, stats.Count ? (uint32_t)(stats.Total / stats.Count) / cycles_per_us : 0, 6, ' ');
+        p += Format_Char(p, '/');
+        Format_UInt(p, stats.Max / cycles_per_us, 6, ' ');
+        OLED_ShowString6x8(i + 1, 1, msg);
+    }
+    ControlSystem_HoldDisplay(BT_PROFILE_OLED_MS);
+}
+
+/**
+  * @brief  $PROF子命令：查看耗时统计
+  * @param  args: "PROF"之后的部分
+  * @retval 无
+  * @detail 不带参数时上报统计，RESET清零，OLED显示到屏幕上（避障时拒绝），MASK <位掩码>选择统计的区域（十进制）
+  */
+static void Bluetooth_Profile(const char *args)
+{
+    int32_t mask;
+
+    if(Bluetooth_Match(&args, "RESET")) {
+        Profile_Reset();
+        Bluetooth_SendString("OK: reset\r\n");
+    } else if(Bluetooth_Match(&args, "OLED")) {
+        if(ControlSystem_IsIn(CS_AVOIDANCE)) {
+            Bluetooth_SendString("ERR: busy\r\n"); // 保持期间不做避障决策
+            return;
+        }
+        Bluetooth_ShowProfile();
+        Bluetooth_SendString("OK: oled\r\n");
+    } else if(Bluetooth_Match(&args, "MASK")) {
+        if(!Format_ParseFixed(args, &mask, 0) || mask < 0) {
+            Bluetooth_SendString("ERR: PROF MASK <bits>\r\n");
+            return;
+        }
+        Profile_SetMask((uint32_t)mask);
+        Bluetooth_SendString("OK: mask\r\n");
+    } else {
+        Bluetooth_SendProfile();
+    }
+}
+#endif
+
+/**
+  * @brief  处理一行'$'命令（标定）
+  * @param  line: 不含'$'的命令行
+  * @retval 无
+  * @detail $CAL <id> [角度x6]  查询/修改舵机配置，立即生效（下一次起步或姿态切换时用到）
+  *         $SAVE               保存到Flash；擦页时CPU停顿约20ms，连续步态运行中拒绝
+  *         $LOAD               从Flash读回
+  *         $DEFAULT            恢复出厂配置（不写Flash，需要的话再$SAVE）
+  *         $SLEW [id 速度 加速度] 查询（并清零）限速次数，或设置限速
+  *         $GAIT [摆幅 支撑相 曲线 [相位差x4]] 查询/修改连续步态参数，见Bluetooth_Gait
+  *         $HOLD               查询保持超时停发脉冲的舵机和累计停发时间
+  *         $CACHE              查询舵机写入缓存的命中/实际写入次数
+  *         $MACRO ...          命令宏，见Bluetooth_Macro
+  *         $BHV ...            行为字节码，见Bluetooth_Behavior
+  *         $PROF ...           耗时统计，见Bluetooth_Profile（PROFILE_ENABLE为1时）
+  */
+void Bluetooth_ProcessLine(const char *line)
+{
+    PROFILE_BEGIN(PROFILE_BT_LINE);
+    if(Bluetooth_Match(&line, "CAL")) {
+        Bluetooth_Calibrate(line);
+    } else if(Bluetooth_Match(&line, "SAVE")) {
+        if(Locomotion_IsRunning()) {
+            Bluetooth_SendString("ERR: busy\r\n");
+        } else {
+            Bluetooth_SendString(Dog_SaveServoConfig() ? "OK: saved\r\n" : "ERR: flash\r\n");
+        }
+    } else if(Bluetooth_Match(&line, "LOAD")) {
+        Bluetooth_SendString(Dog_LoadServoConfig() ? "OK: loaded\r\n" : "ERR: no saved config\r\n");
+    } else if(Bluetooth_Match(&line, "DEFAULT")) {
+        Dog_ResetServoConfig();
+        Bluetooth_SendString("OK: default\r\n");
+    } else if(Bluetooth_Match(&line, "SLEW")) {
+        Bluetooth_Slew(line);
+    } else if(Bluetooth_Match(&line, "GAIT")) {
+        Bluetooth_Gait(line);
+    } else if(Bluetooth_Match(&line, "HOLD")) {
+        Bluetooth_ReportHold();
+    } else if(Bluetooth_Match(&line, "CACHE")) {
+        Bluetooth_ReportCache();
+    } else if(Bluetooth_Match(&line, "MACRO")) {
+        Bluetooth_Macro(line);
+    } else if(Bluetooth_Match(&line, "BHV")) {
+        Bluetooth_Behavior(line);
+#if PROFILE_ENABLE
+    } else if(Bluetooth_Match(&line, "PROF")) {
+        Bluetooth_Profile(line);
+#endif
+    } else {
+        Bluetooth_SendString("ERR: unknown\r\n");
+    }
+    PROFILE_END(PROFILE_BT_LINE);
+}
+
 // USART2中断服务函数
 void USART2_IRQHandler(void)
 {
     if(USART_GetITStatus(USART2, USART_IT_RXNE) != RESET) {
         uint8_t data = USART_ReceiveData(USART2);
         
-        // 简单的命令处理：单个字符命令
-        if(data >= 'A' && data <= 'Z') {
+        // '$'开头到回车/换行是一行文本（标定等带参数的命令），行内的大写字母不当作单字符命令
+        // 上一行还没取走时新的一行整行丢弃
+        if(data == '$') {
+            line_mode = 1;
+            if(!line_received) rx_index = 0;
+        } else if(line_mode) {
+            if(data == '\r' || data == '\n') {
+                line_mode = 0;
+                line_received = 1;
+            } else if(!line_received && rx_index < BT_LINE_MAX) {
+                rx_buffer[rx_index++] = data;
+            }
+        } else if(data >= 'A' && data <= 'Z') {
+            // 简单的命令处理：单个字符命令
             current_command = data;
             command_received = 1;
             
@@ -18,21 +18,19 @@ typedef enum {
     CMD_RESET = 'X'          // 重置
 } BluetoothCommand;
 
-// 工作模式
-typedef enum {
-    MODE_MANUAL = 0,     // 手动遥控模式
-    MODE_AUTO = 1,       // 自主模式
-    MODE_FOLLOW = 2      // 跟随模式
-} WorkMode;
+// 带参数的命令以'$'开头、回车或换行结尾，例如"$CAL 1 90 45 110 70 120 60"
+#define BT_LINE_MAX     64
+#define BT_PROFILE_OLED_MS  3000  // $PROF OLED占用屏幕的时间，期间状态机不重画
 
 // 函数声明
 void Bluetooth_Init(void);
 void Bluetooth_SendString(char *str);
 void Bluetooth_SendData(uint8_t *data, uint16_t len);
 uint8_t Bluetooth_GetCommand(void);
-WorkMode Bluetooth_GetMode(void);
+uint8_t Bluetooth_GetLine(char *line, uint8_t size); // 取一行'$'命令，返回0表示没有
+void Bluetooth_ProcessLine(const char *line);        // 执行'$'命令：CAL/SAVE/LOAD/DEFAULT/SLEW/GAIT/HOLD/CACHE/MACRO/BHV/PROF(PROFILE_ENABLE时)，见Bluetooth.c
 uint8_t Bluetooth_Available(void);
 void Bluetooth_ProcessCommand(uint8_t cmd);
-void Bluetooth_SendStatus(void);
+void Bluetooth_SendStatus(void);       // 上报当前模式（ControlSystem状态）和速度
 
 #endif
@@ -5,6 +5,8 @@
 #include "OLED.h"
 #include "Buzzer.h"
 #include "LED.h"
+#include "Delay.h"
+#include "Format.h"
 
 static uint8_t bluetooth_active = 0;
 
@@ -39,87 +41,10 @@ void BluetoothControl_Update(void)
     }
 }
 
+// 命令交给模式状态机处理（只有蓝牙遥控模式会执行动作），这里只上报状态
 void BluetoothControl_ProcessCommand(uint8_t cmd)
 {
-    char display_msg[17];
-    
-    switch(cmd) {
-        case CMD_STAND:
-            Control_Stand();
-            OLED_ShowString(2, 1, "Action: Stand    ");
-            break;
-            
-        case CMD_SIT:
-            Control_Sit();
-            OLED_ShowString(2, 1, "Action: Sit      ");
-            break;
-            
-        case CMD_WALK_FORWARD:
-            Control_WalkForward(1);
-            OLED_ShowString(2, 1, "Action: Forward  ");
-            break;
-            
-        case CMD_WALK_BACKWARD:
-            Control_WalkBackward(1);
-            OLED_ShowString(2, 1, "Action: Backward ");
-            break;
-            
-        case CMD_TURN_LEFT:
-            Control_TurnLeft(1);
-            OLED_ShowString(2, 1, "Action: Turn Left");
-            break;
-            
-        case CMD_TURN_RIGHT:
-            Control_TurnRight(1);
-            OLED_ShowString(2, 1, "Action:Turn Right");
-            break;
-            
-        case CMD_STOP:
-            Control_Stop();
-            OLED_ShowString(2, 1, "Action: Stop     ");
-            break;
-            
-        case CMD_SPEED_UP:
-            {
-                uint8_t speed = Dog_GetWalkSpeed();
-                if(speed < 10) {
-                    Dog_SetWalkSpeed(speed + 1);
-                    sprintf(display_msg, "Speed: %d/10    ", speed + 1);
-                    OLED_ShowString(3, 1, display_msg);
-                    Buzzer_Beep(50);
-                }
-            }
-            break;
-            
-        case CMD_SPEED_DOWN:
-            {
-                uint8_t speed = Dog_GetWalkSpeed();
-                if(speed > 1) {
-                    Dog_SetWalkSpeed(speed - 1);
-                    sprintf(display_msg, "Speed: %d/10    ", speed - 1);
-                    OLED_ShowString(3, 1, display_msg);
-                    Buzzer_Beep(50);
-                }
-            }
-            break;
-            
-        case CMD_TEST:
-            OLED_ShowString(2, 1, "Action: Test     ");
-            Dog_TestServos();
-            break;
-            
-        case CMD_RESET:
-            OLED_ShowString(2, 1, "Action: Reset    ");
-            Dog_ResetPose();
-            break;
-            
-        default:
-            sprintf(display_msg, "Unknown: %c       ", cmd);
-            OLED_ShowString(2, 1, display_msg);
-            break;
-    }
-    
-    // 更新状态显示
+    ControlSystem_Post(CS_EVT_BT_CMD, cmd, 0);
     Bluetooth_SendStatus();
 }
 
@@ -0,0 +1,207 @@
+#include "Boot.h"
+#include "Delay.h"
+#include "OLED.h"
+#include "LED.h"
+#include "Key.h"
+#include "Buzzer.h"
+#include "Ultrasonic.h"
+#include "DogActions.h"
+#include "Servo.h"
+#include "Bluetooth.h"
+#include "Format.h"
+#include "adc_dma.h"
+#include "MPU6050.h"
+#include "Posture.h"
+#include "FallDetect.h"
+#include "Locomotion.h"
+#include "Behavior.h"
+#include "Profile.h"
+
+// 启动/自检步骤
+typedef enum {
+    BOOT_WAIT_OLED = 0,  // 等OLED上电稳定后再配置
+    BOOT_SERVO_60,       // 舵机4摆动自检
+    BOOT_SERVO_120,
+    BOOT_SERVO_90,
+    BOOT_SENSOR,         // 超声波自检
+    BOOT_DONE
+} BootStep;
+
+#define BOOT_SERVO_STEP_MS  200
+
+static BootStep boot_step = BOOT_WAIT_OLED;
+static uint32_t step_time = 0;       // 当前步骤开始时刻
+static uint32_t ready_time = 0;
+static uint32_t first_cmd_time = 0;
+static uint8_t servo_tested = 0;
+
+// 通过蓝牙上报 "Boot: <label><ms> ms"
+static void Boot_Report(const char *label, uint32_t ms)
+{
+    char msg[40];
+    char *p = msg;
+    p += Format_Str(p, "Boot: ");
+    p += Format_Str(p, label);
+    p += Format_UInt(p, ms, 0, ' ');
+    Format_Str(p, " ms\r\n");
+    Bluetooth_SendString(msg);
+}
+
+/**
+  * @brief  初始化外设，舵机直接进入站立姿态
+  * @param  无
+  * @retval 无
+  * @detail 快速模式下只做不需要等待的初始化就返回，OLED和自检交给Boot_Task；
+  *         非快速模式下在这里把自检全部做完
+  */
+void Boot_Start(void)
+{
+    // 2位抢占+2位子优先级，必须在任何NVIC_Init之前设置，之后不再改动。抢占优先级分配：
+    //   0  超声波回波EXTI：边沿时间戳要准，可以打断其它所有中断
+    //   1  MPU6050 I2C/DMA/INT、USART2接收：字节级时序，不能被舵机帧耽误
+    //   2  TIM3舵机帧、ADC DMA
+    //   3  SysTick(SysTick_Config设为最低)，节拍回调可被以上全部打断
+    NVIC_PriorityGroupConfig(NVIC_PriorityGroup_2);
+    Delay_Init(); // 节拍从这里开始计时，之后所有启动耗时都以它为零点
+    Profile_Init(); // DWT周期计数器，PROFILE_ENABLE为0时为空
+
+#if !BOOT_FAST_MODE
+    OLED_Init();
+#endif
+    LED_Init();
+    Key_Init();
+    Buzzer_Init();
+    Ultrasonic_Init();
+    Ultrasonic_StartRanging(); // 后台测距，之后读距离不再阻塞
+    Dog_Init();
+    Behavior_Init(); // 读回上传过的行为字节码
+    Bluetooth_Init();
+    ADC_DMA_Init(); // 电池/温度后台采样
+    MPU6050_Init(); // 没接IMU时返回0，不影响其它功能
+    Posture_Init(); // 有IMU时启用姿态闭环
+    FallDetect_Init();
+    Locomotion_Init(); // 连续步态，跑在舵机帧中断里
+
+#if !BOOT_FAST_MODE
+    while(boot_step != BOOT_DONE) {
+        Boot_Task(1);
+    }
+#endif
+
+    ready_time = Delay_GetTick();
+    Boot_Report("ready in ", ready_time);
+}
+
+/**
+  * @brief  推进启动自检，每次调用只做一小步，不阻塞
+  * @param  idle: 当前是否处于空闲模式。非空闲时跳过舵机自检，不和用户指令抢舵机
+  * @retval 无
+  */
+void Boot_Task(uint8_t idle)
+{
+    uint32_t now = Delay_GetTick();
+    UltrasonicSample sample;
+
+    switch(boot_step) {
+        case BOOT_WAIT_OLED:
+            if(now < OLED_POWERUP_MS) break;
+#if BOOT_FAST_MODE
+            OLED_Setup();
+#endif
+            OLED_ShowString(1, 1, "Smart Puppy V2.1");
+            OLED_ShowString(2, 1, "Initializing...");
+            boot_step = BOOT_SERVO_60;
+            step_time = now;
+            break;
+
+        case BOOT_SERVO_60:
+            if(!idle) {
+                boot_step = BOOT_SENSOR;
+                step_time = now;
+                break;
+            }
+            LED4_ON();
+            Servo_SetAngle(SERVO_REAR_RIGHT, 60);
+            boot_step = BOOT_SERVO_120;
+            step_time = now;
+            break;
+
+        case BOOT_SERVO_120:
+        case BOOT_SERVO_90:
+            if(!idle) {
+                LED4_OFF();
+                boot_step = BOOT_SENSOR;
+                step_time = now;
+                break;
+            }
+            if(now - step_time < BOOT_SERVO_STEP_MS) break;
+            step_time = now;
+            if(boot_step == BOOT_SERVO_120) {
+                Servo_SetAngle(SERVO_REAR_RIGHT, 120);
+                boot_step = BOOT_SERVO_90;
+            } else {
+                Servo_SetAngle(SERVO_REAR_RIGHT, 90);
+                LED4_OFF();
+                servo_tested = 1;
+                boot_step = BOOT_SENSOR;
+            }
+            break;
+
+        case BOOT_SENSOR:
+            // 等后台测距出结果，最多等三个测距周期
+            sample = Ultrasonic_GetSample();
+            if(!sample.valid && now - step_time < 3 * ULTRASONIC_PERIOD_MS) break;
+            if(sample.valid) {
+                OLED_ShowString(4, 1, "US: OK | BT: OK  ");
+                Bluetooth_SendString("SelfTest: US OK\r\n");
+            } else {
+                OLED_ShowString(4, 1, "US: FAIL | BT: OK");
+                Bluetooth_SendString("SelfTest: US FAIL\r\n");
+            }
+            Bluetooth_SendString(servo_tested ? "SelfTest: Servo OK\r\n" : "SelfTest: Servo SKIP\r\n");
+            Bluetooth_SendString(!MPU6050_IsPresent() ? "SelfTest: IMU NONE\r\n" :
+                                 MPU6050_GetFrameCount() ? "SelfTest: IMU OK\r\n" : "SelfTest: IMU FAIL\r\n");
+            if(idle) {
+                Buzzer_BeepPattern(BEEP_TRIPLE_BEEP); // 开机就绪提示音
+            }
+            boot_step = BOOT_DONE;
+            break;
+
+        default:
+            break;
+    }
+}
+
+uint8_t Boot_IsDone(void)
+{
+    return boot_step == BOOT_DONE;
+}
+
+uint8_t Boot_SelfTestBusy(void)
+{
+    return boot_step == BOOT_SERVO_120 || boot_step == BOOT_SERVO_90;
+}
+
+/**
+  * @brief  记录第一次被接受的指令（按键或蓝牙），上报从上电到可操作的耗时
+  * @param  无
+  * @retval 无
+  */
+void Boot_MarkCommand(void)
+{
+    if(first_cmd_time == 0) {
+        first_cmd_time = Delay_GetTick();
+        if(first_cmd_time == 0) first_cmd_time = 1;
+        Boot_Report("first cmd at ", first_cmd_time);
+    }
+}
+
+uint32_t Boot_GetReadyTime(void)
+{
+    return ready_time;
+}
+
+uint32_t Boot_GetFirstCommandTime(void)
+{
+    return first_cmd_time;
+}
@@ -0,0 +1,20 @@
+#ifndef __BOOT_H
+#define __BOOT_H
+
+#include "stm32f10x.h"
+
+// 1: 快速启动，外设初始化完立即进入主循环（站立、可接收按键/蓝牙指令），
+//    OLED上电等待和舵机/超声波自检在主循环里后台完成
+// 0: 与旧版一致，自检全部做完再进入主循环
+#define BOOT_FAST_MODE      1
+
+// 函数声明
+void Boot_Start(void);                 // 初始化外设并进入可控站立状态
+void Boot_Task(uint8_t idle);          // 主循环中调用，推进后台自检；idle表示当前处于空闲模式
+uint8_t Boot_IsDone(void);             // 自检是否全部结束
+uint8_t Boot_SelfTestBusy(void);       // 自检正在占用舵机（空闲循环此时不要重发站立）
+void Boot_MarkCommand(void);           // 第一次接受指令时调用，记录并上报启动耗时
+uint32_t Boot_GetReadyTime(void);      // 进入主循环时刻(ms)
+uint32_t Boot_GetFirstCommandTime(void); // 第一次接受指令时刻(ms)，0表示还没有
+
+#endif
@@ -1,5 +1,49 @@
 #include "Buzzer.h"
 #include "Delay.h"
+#include <stddef.h>
+
+// 鸣叫模式：响、停交替的时长(ms)，以0结束
+static const uint16_t Pattern_SingleShort[] = {100, 0};
+static const uint16_t Pattern_SingleLong[] = {500, 0};
+static const uint16_t Pattern_Double[] = {100, 100, 100, 0};
+static const uint16_t Pattern_Triple[] = {80, 80, 80, 80, 80, 0};
+static const uint16_t Pattern_SOS[] = {100, 100, 100, 100, 100, 300,    // S: ...
+                                       300, 100, 300, 100, 300, 300,    // O: ---
+                                       100, 100, 100, 100, 100, 0};     // S: ...
+static const uint16_t Pattern_Default[] = {200, 0};
+
+static const uint16_t * volatile beep_step = NULL; // 正在播放的一段，NULL表示空闲
+static volatile uint16_t beep_left = 0;            // 这一段剩余的毫秒数
+static uint8_t beep_on = 0;
+static uint16_t beep_single[2];                    // Buzzer_StartBeep用的单段模式
+static uint8_t beep_hook_added = 0;
+
+// 1ms节拍回调：一段结束时切换响/停，到0结束
+static void Buzzer_Tick(void)
+{
+    if(beep_step == NULL || --beep_left) return;
+    beep_step++;
+    if(*beep_step == 0) {
+        Buzzer_Off();
+        beep_step = NULL;
+        return;
+    }
+    beep_on = !beep_on;
+    if(beep_on) Buzzer_On(); else Buzzer_Off();
+    beep_left = *beep_step;
+}
+
+// 开始播放，打断正在播放的模式；节拍回调没有注册时不响，免得停不下来
+static void Buzzer_Start(const uint16_t *steps)
+{
+    if(!beep_hook_added) return;
+    __disable_irq();
+    beep_step = steps;
+    beep_left = steps[0];
+    beep_on = 1;
+    Buzzer_On();
+    __enable_irq();
+}
 
 /**
   * @brief  蜂鸣器初始化
@@ -23,8 +67,13 @@ void Buzzer_Init(void)
     /* 3. 初始状态关闭蜂鸣器 - 输出高电平 */
     GPIO_SetBits(BEEP_GPIO_PORT, BEEP_GPIO_PIN);  // 确保初始为高电平
     
-    /* 4. 初始化成功提示 */
-    Buzzer_Beep(50);
+    /* 4. 关闭蜂鸣器。开机提示音由调用者决定（快速启动时放到后台自检里），这里不再阻塞50ms */
+    Buzzer_Off();
+
+    /* 5. 后台播放由1ms节拍驱动（需先调用Delay_Init），重复调用不重复注册 */
+    if(!beep_hook_added) {
+        beep_hook_added = Delay_AddTickHook(Buzzer_Tick);
+    }
 }
 
 /**
@@ -59,56 +108,68 @@ void Buzzer_Beep(uint16_t duration_ms)
     Buzzer_Off();
 }
 
+// 模式编号对应的时长表
+static const uint16_t *Buzzer_GetPattern(uint8_t pattern)
+{
+    switch(pattern)
+    {
+        case BEEP_SINGLE_SHORT: return Pattern_SingleShort; // 单次短鸣
+        case BEEP_SINGLE_LONG:  return Pattern_SingleLong;  // 单次长鸣
+        case BEEP_DOUBLE_BEEP:  return Pattern_Double;      // 双鸣
+        case BEEP_TRIPLE_BEEP:  return Pattern_Triple;      // 三连鸣
+        case BEEP_SOS:          return Pattern_SOS;         // SOS信号: ...---...
+        default:                return Pattern_Default;     // 默认鸣叫
+    }
+}
+
 /**
-  * @brief  播放预设的鸣叫模式
+  * @brief  播放预设的鸣叫模式，放完才返回
   * @param  pattern: 鸣叫模式，见Buzzer.h中的定义
   * @retval 无
   */
 void Buzzer_BeepPattern(uint8_t pattern)
 {
-    switch(pattern)
-    {
-        case BEEP_SINGLE_SHORT:     // 单次短鸣
-            Buzzer_Beep(100);
-            break;
-            
-        case BEEP_SINGLE_LONG:      // 单次长鸣
-            Buzzer_Beep(500);
-            break;
-            
-        case BEEP_DOUBLE_BEEP:      // 双鸣
-            Buzzer_Beep(100);
-            Delay_ms(100);
-            Buzzer_Beep(100);
-            break;
-            
-        case BEEP_TRIPLE_BEEP:      // 三连鸣
-            Buzzer_Beep(80);
-            Delay_ms(80);
-            Buzzer_Beep(80);
-            Delay_ms(80);
-            Buzzer_Beep(80);
-            break;
-            
-        case BEEP_SOS:              // SOS信号: ...---...
-            // S: ... (3短)
-            Buzzer_Beep(100); Delay_ms(100);
-            Buzzer_Beep(100); Delay_ms(100); 
-            Buzzer_Beep(100); Delay_ms(300);
-            // O: --- (3长)
-            Buzzer_Beep(300); Delay_ms(100);
-            Buzzer_Beep(300); Delay_ms(100);
-            Buzzer_Beep(300); Delay_ms(300);
-            // S: ... (3短)
-            Buzzer_Beep(100); Delay_ms(100);
-            Buzzer_Beep(100); Delay_ms(100);
-            Buzzer_Beep(100);
-            break;
-            
-        default:
-            Buzzer_Beep(200);       // 默认鸣叫
-            break;
+    const uint16_t *p = Buzzer_GetPattern(pattern);
+    uint8_t on = 1;
+
+    beep_step = NULL; // 停下后台播放
+    for(; *p; p++, on = !on) {
+        if(on) Buzzer_On(); else Buzzer_Off();
+        Delay_ms(*p);
     }
+    Buzzer_Off();
+}
+
+/**
+  * @brief  后台播放预设的鸣叫模式，立即返回
+  * @param  pattern: 鸣叫模式，见Buzzer.h中的定义
+  * @retval 无
+  * @detail 响/停由1ms节拍切换，可在状态机的事件处理里调用；新的模式打断正在播放的
+  */
+void Buzzer_StartPattern(uint8_t pattern)
+{
+    Buzzer_Start(Buzzer_GetPattern(pattern));
+}
+
+/**
+  * @brief  后台鸣叫指定时间，立即返回
+  * @param  duration_ms: 鸣叫持续时间(毫秒)，0不响
+  * @retval 无
+  */
+void Buzzer_StartBeep(uint16_t duration_ms)
+{
+    if(duration_ms == 0) return;
+    __disable_irq();
+    beep_step = NULL; // 先停下，再改写单段模式
+    beep_single[0] = duration_ms;
+    beep_single[1] = 0;
+    __enable_irq();
+    Buzzer_Start(beep_single);
+}
+
+uint8_t Buzzer_IsBusy(void)
+{
+    return beep_step != NULL;
 }
 
 /**
@@ -9,6 +9,9 @@ void Buzzer_On(void);                      // 打开蜂鸣器
 void Buzzer_Off(void);                     // 关闭蜂鸣器
 void Buzzer_Beep(uint16_t duration_ms);    // 蜂鸣器鸣叫指定时间
 void Buzzer_BeepPattern(uint8_t pattern);  // 播放预设的鸣叫模式
+void Buzzer_StartBeep(uint16_t duration_ms); // 同Buzzer_Beep但不等待，由1ms节拍关闭
+void Buzzer_StartPattern(uint8_t pattern); // 同Buzzer_BeepPattern但不等待
+uint8_t Buzzer_IsBusy(void);               // 后台播放还没结束
 
 // 引脚定义 - 现在在头文件中定义，方便修改
 #define BEEP_GPIO_PORT    GPIOA
@@ -3,101 +3,825 @@
 #include "LED.h"
 #include "Buzzer.h"
 #include "OLED.h"
+#include "Key.h"
+#include "Delay.h"
+#include "Bluetooth.h"
+#include "Format.h"
+#include "Boot.h"
+#include "Ultrasonic.h"
+#include "ObstacleMap.h"
+#include "PowerGovernor.h"
+#include "FallDetect.h"
+#include "EventBus.h"
+#include "Locomotion.h"
+#include "Macro.h"
+#include "Behavior.h"
+#include <stddef.h>
 
-static SystemState CurrentState = SYS_IDLE;
+typedef struct {
+    ControlState parent;
+    void (*entry)(void);
+    void (*exit)(void);
+    ControlState (*init)(void);                 // 复合状态进入后的初始子状态，叶子状态为NULL
+    uint8_t (*handler)(const ControlEvent *e);  // 返回1表示已处理，0交给父状态
+    const char *name;
+} ControlStateDesc;
 
-void ControlSystem_Init(void)
+typedef enum {
+    AVOID_CLEAR = 0, AVOID_WARNING, AVOID_DANGER
+} AvoidState;
+
+static uint8_t Root_Handler(const ControlEvent *e);
+static ControlState Idle_Init(void);
+static void Idle_Entry(void);
+static void Idle_Exit(void);
+static uint8_t Idle_Ready_Handler(const ControlEvent *e);
+static uint8_t Idle_LowBattery_Handler(const ControlEvent *e);
+static uint8_t Idle_Fallen_Handler(const ControlEvent *e);
+static void Active_Exit(void);
+static void Moving_Exit(void);
+static void Avoidance_Entry(void);
+static uint8_t Avoidance_Handler(const ControlEvent *e);
+static uint8_t Bluetooth_Handler(const ControlEvent *e);
+static void Hello_Entry(void);
+static void Hello_Exit(void);
+static uint8_t Hello_Handler(const ControlEvent *e);
+
+static const ControlStateDesc states[CS_STATE_NUM] = {
+    /* CS_ROOT             */ {CS_ROOT,   NULL,            NULL,        NULL,      Root_Handler,            "ROOT"},
+    /* CS_IDLE             */ {CS_ROOT,   Idle_Entry,      Idle_Exit,   Idle_Init, NULL,                    "IDLE"},
+    /* CS_IDLE_READY       */ {CS_IDLE,   NULL,            NULL,        NULL,      Idle_Ready_Handler,      "READY"},
+    /* CS_IDLE_LOW_BATTERY */ {CS_IDLE,   NULL,            NULL,        NULL,      Idle_LowBattery_Handler, "LOW_BATTERY"},
+    /* CS_IDLE_FALLEN      */ {CS_IDLE,   NULL,            NULL,        NULL,      Idle_Fallen_Handler,     "FALLEN"},
+    /* CS_ACTIVE           */ {CS_ROOT,   NULL,            Active_Exit, NULL,      NULL,                    "ACTIVE"},
+    /* CS_AVOIDANCE        */ {CS_ACTIVE, Avoidance_Entry, Moving_Exit, NULL,      Avoidance_Handler,       "AVOIDANCE"},
+    /* CS_BLUETOOTH        */ {CS_ACTIVE, NULL,            Moving_Exit, NULL,      Bluetooth_Handler,       "BLUETOOTH"},
+    /* CS_ACTION_HELLO     */ {CS_ACTIVE, Hello_Entry,     Hello_Exit,  NULL,      Hello_Handler,           "HELLO"}
+};
+
+static ControlState current = CS_ROOT;
+static ControlState tran_target = CS_ROOT;
+static uint8_t tran_pending = 0;
+
+static ControlEvent queue[CONTROL_QUEUE_SIZE];
+static volatile uint8_t queue_head = 0;
+static volatile uint8_t queue_tail = 0;
+static volatile uint32_t queue_dropped = 0;
+
+static uint8_t timer_armed = 0;        // 状态定时器，到期投递CS_EVT_TIMEOUT
+static uint8_t timer_seq = 0;          // 每次设定、取消都加1，队列里过期的CS_EVT_TIMEOUT靠它丢弃
+static uint32_t timer_deadline = 0;
+
+static char *feedback_text = NULL;     // 切换模式的提示，转换完成后显示
+static uint8_t feedback_showing = 0;   // 屏幕被提示或ControlSystem_HoldDisplay占用
+static uint32_t feedback_until = 0;
+
+static uint32_t action_counter = 0; // 避障动作次数
+static uint8_t avoid_turning = 0;   // 避障转向中，转完才重新决策
+
+// ===================== 状态机核心 =====================
+
+// a是否为s的真祖先
+static uint8_t ControlSystem_IsAncestor(ControlState a, ControlState s)
+{
+    while(s != CS_ROOT) {
+        s = states[s].parent;
+        if(s == a) return 1;
+    }
+    return 0;
+}
+
+// 设定状态定时器：ms后投递一次CS_EVT_TIMEOUT，之前的设定作废；转换时自动重设
+static void ControlSystem_Arm(uint32_t ms)
+{
+    timer_seq++;
+    timer_deadline = Delay_GetTick() + ms;
+    timer_armed = 1;
+}
+
+// 取消状态定时器，由其它事件推进
+static void ControlSystem_Disarm(void)
+{
+    timer_seq++;
+    timer_armed = 0;
+}
+
+// 请求转换，在当前事件处理完后执行；只能在handler里调用
+static void ControlSystem_Tran(ControlState target)
+{
+    tran_target = target;
+    tran_pending = 1;
+}
+
+// 从当前状态退出到与目标的最近公共祖先，再依次进入目标及其初始子状态；
+// 目标是当前状态或其祖先时，目标本身也会退出再进入（外部转换）。
+// 新状态的定时器设为立即到期，先执行一次周期动作，entry可以另行设定
+static void ControlSystem_DoTransition(ControlState target)
+{
+    ControlState path[CONTROL_MAX_DEPTH];
+    ControlState s = current;
+    uint8_t n = 0;
+
+    ControlSystem_Arm(0);
+
+    while(s != CS_ROOT && !ControlSystem_IsAncestor(s, target)) {
+        if(states[s].exit) states[s].exit();
+        s = states[s].parent;
+    }
+    current = s;
+
+    for(; target != s; target = states[target].parent) {
+        path[n++] = target;
+    }
+    while(n) {
+        current = path[--n];
+        if(states[current].entry) states[current].entry();
+    }
+    while(states[current].init) {
+        current = states[current].init();
+        if(states[current].entry) states[current].entry();
+    }
+}
+
+// 转换完成后显示切换模式的提示；显示期间不投递CS_EVT_TIMEOUT，各状态不会重画屏幕
+static void ControlSystem_ShowFeedback(void)
 {
-    Dog_Init();
-    Dog_SetActionCompleteCallback(ControlSystem_Update);
-    CurrentState = SYS_IDLE;
-    
     OLED_Clear();
-    OLED_ShowString(1, 1, "Control System OK");
-    OLED_ShowString(2, 1, "State: IDLE");
-    
-    Buzzer_BeepPattern(BEEP_SINGLE_SHORT);
-}
-
-void ControlSystem_Update(void)
-{
-    switch(CurrentState) {
-        case SYS_WALKING:
-        case SYS_TURNING:
-            CurrentState = SYS_STANDING;
-            OLED_ShowString(2, 1, "State: STANDING ");
-            LED2_ON();
-            LED1_OFF(); LED3_OFF(); LED4_OFF();
-            break;
-            
-        case SYS_SITTING:
-            CurrentState = SYS_IDLE;
-            OLED_ShowString(2, 1, "State: IDLE      ");
-            LED1_ON();
-            LED2_OFF(); LED3_OFF(); LED4_OFF();
-            break;
-            
+    OLED_ShowString(1, 1, feedback_text);
+    feedback_text = NULL;
+    ControlSystem_HoldDisplay(CONTROL_FEEDBACK_MS);
+}
+
+// 从当前叶子状态开始向上找处理者，处理完再执行转换（运行到完成）
+static void ControlSystem_Dispatch(const ControlEvent *e)
+{
+    ControlState s = current;
+
+    if(e->sig == CS_EVT_TIMEOUT && e->param != timer_seq) return; // 投递后定时器已重设或状态已转换
+    tran_pending = 0;
+    for(;;) {
+        if(states[s].handler && states[s].handler(e)) break;
+        if(s == CS_ROOT) break;
+        s = states[s].parent;
+    }
+    if(tran_pending) {
+        tran_pending = 0;
+        ControlSystem_DoTransition(tran_target);
+    }
+    if(feedback_text) ControlSystem_ShowFeedback();
+}
+
+static uint8_t ControlSystem_Pop(ControlEvent *e)
+{
+    if(queue_tail == queue_head) return 0;
+    *e = queue[queue_tail];
+    queue_tail = (queue_tail + 1) % CONTROL_QUEUE_SIZE;
+    return 1;
+}
+
+/**
+  * @brief  投递一个事件
+  * @param  sig: ControlSignal
+  * @param  param, detail: 事件参数，含义见ControlSignal
+  * @retval 1成功，0队列已满（事件丢弃）
+  * @detail 中断和主循环都会投递，入队时短暂关中断
+  */
+uint8_t ControlSystem_Post(uint8_t sig, uint8_t param, uint8_t detail)
+{
+    uint32_t primask = __get_PRIMASK();
+    uint8_t next, ok = 0;
+
+    __disable_irq();
+    next = (queue_head + 1) % CONTROL_QUEUE_SIZE;
+    if(next != queue_tail) {
+        queue[queue_head].sig = sig;
+        queue[queue_head].param = param;
+        queue[queue_head].detail = detail;
+        queue_head = next;
+        ok = 1;
+    } else {
+        queue_dropped++;
+    }
+    if(!primask) __enable_irq();
+    return ok;
+}
+
+// 按键和蓝牙
+static void ControlSystem_PollInputs(void)
+{
+    KeyEvent key;
+    uint8_t cmd;
+    char line[BT_LINE_MAX + 1];
+
+    while(Key_GetEvent(&key)) {
+        // 松开和连发没有状态使用，不入队
+        if(key.Type == KEY_EVENT_RELEASE || key.Type == KEY_EVENT_REPEAT) continue;
+        ControlSystem_Post(CS_EVT_KEY, key.Key, key.Type);
+    }
+    cmd = Bluetooth_GetCommand();
+    if(cmd) {
+        Macro_Record(cmd, 0); // 录制时记下时间和命令
+        ControlSystem_Post(CS_EVT_BT_CMD, cmd, 0);
+    }
+    Macro_Task(); // 回放的命令从这里投递，与真实蓝牙命令相同
+    Behavior_Task(); // 后台行为：$BHV RUN和各状态启动的单次动作
+    // '$'标定命令与模式无关，直接处理
+    if(Bluetooth_GetLine(line, sizeof(line))) Bluetooth_ProcessLine(line);
+}
+
+// 电量等级变化上报，与当前状态无关
+static void ControlSystem_ReportPower(PowerLevel level)
+{
+    char msg[32];
+    char *p = msg;
+
+    p += Format_Str(p, (level == POWER_CRITICAL) ? "Power: CRITICAL " :
+                       (level == POWER_LOW) ? "Power: LOW " : "Power: OK ");
+    p += Format_Fixed(p, PowerGovernor_GetBattery_mV() / 10, 2, 0);
+    Format_Str(p, "V\r\n");
+    Bluetooth_SendString(msg);
+}
+
+// 提示显示完后清屏；状态定时器到期时投递CS_EVT_TIMEOUT，队列满时下一轮再投
+static void ControlSystem_PollTimer(void)
+{
+    uint32_t now = Delay_GetTick();
+
+    if(feedback_showing) {
+        if((int32_t)(now - feedback_until) < 0) return;
+        feedback_showing = 0;
+        OLED_Clear();
+    }
+    if(timer_armed && (int32_t)(now - timer_deadline) >= 0 &&
+       ControlSystem_Post(CS_EVT_TIMEOUT, timer_seq, 0)) {
+        timer_armed = 0;
+    }
+}
+
+// 超声波阈值回调（中断上下文），只投递事件
+static void ControlSystem_ObstacleCallback(float distance, uint8_t below)
+{
+    (void)distance;
+    ControlSystem_Post(CS_EVT_OBSTACLE, below, 0);
+}
+
+// 动作结束（总线回调）：转成状态机事件，param为动作(DogMode)，detail为1表示被中止
+static void ControlSystem_OnActionEnd(const BusEvent *e)
+{
+    ControlSystem_Post(CS_EVT_ACTION_DONE, e->source, e->type == EVENT_ACTION_CANCEL);
+}
+
+// 动作进度（总线回调）：在第4行显示完成百分比
+static void ControlSystem_ShowProgress(const BusEvent *e)
+{
+    char msg[17];
+    char *p = msg;
+    p += Format_Str(p, "Step ");
+    p += Format_UInt(p, e->arg, 3, ' ');
+    Format_Str(p, "%      ");
+    OLED_ShowString(4, 1, msg);
+}
+
+/**
+  * @brief  初始化状态机并进入空闲状态（需在Boot_Start之后调用）
+  * @param  无
+  * @retval 无
+  */
+void ControlSystem_Init(void)
+{
+    queue_head = queue_tail = 0;
+    Ultrasonic_AddThreshold(20.0f, ControlSystem_ObstacleCallback); // 与Avoidance_Decision的警告/危险距离一致
+    Ultrasonic_AddThreshold(10.0f, ControlSystem_ObstacleCallback);
+    Dog_SetStepCallback(ObstacleMap_OnStep); // 走路/转向时持续填充障碍物地图
+    EventBus_Subscribe(EVENT_MASK(EVENT_ACTION_COMPLETE) | EVENT_MASK(EVENT_ACTION_CANCEL), ControlSystem_OnActionEnd);
+    EventBus_Subscribe(EVENT_MASK(EVENT_ACTION_PROGRESS), ControlSystem_ShowProgress);
+
+    current = CS_ROOT;
+    ControlSystem_DoTransition(CS_IDLE);
+}
+
+/**
+  * @brief  收集事件源：按键、蓝牙、电量等级、摔倒、状态定时器
+  * @param  无
+  * @retval 无
+  */
+void ControlSystem_Poll(void)
+{
+    PowerLevel level;
+
+    EventBus_Dispatch(); // 中断里发布的总线事件
+    Locomotion_Task();
+    ControlSystem_PollInputs();
+    if(PowerGovernor_Task()) {
+        level = PowerGovernor_GetLevel();
+        ControlSystem_ReportPower(level);
+        ControlSystem_Post(CS_EVT_POWER, level, 0);
+    }
+    if(FallDetect_Task()) {
+        ControlSystem_Post(CS_EVT_FALL, FallDetect_GetState(), 0);
+    }
+    ControlSystem_PollTimer();
+}
+
+/**
+  * @brief  分发队列中的全部事件
+  * @param  无
+  * @retval 无
+  * @detail 周期动作由状态定时器的CS_EVT_TIMEOUT触发，队列为空时直接返回
+  */
+void ControlSystem_Run(void)
+{
+    ControlEvent e;
+
+    while(ControlSystem_Pop(&e)) {
+        ControlSystem_Dispatch(&e);
+    }
+}
+
+/**
+  * @brief  暂时占用屏幕：ms内不投递CS_EVT_TIMEOUT，各状态不重画，到期清屏后恢复
+  * @param  ms: 保持时间
+  * @retval 无
+  * @detail 调用者先画好屏幕再调用；保持期间各状态的周期动作也暂停，
+  *         按键等其它事件照常处理，模式切换提示会覆盖屏幕并重新计时
+  */
+void ControlSystem_HoldDisplay(uint32_t ms)
+{
+    feedback_until = Delay_GetTick() + ms;
+    feedback_showing = 1;
+}
+
+ControlState ControlSystem_GetState(void)
+{
+    return current;
+}
+
+uint8_t ControlSystem_IsIn(ControlState state)
+{
+    return current == state || ControlSystem_IsAncestor(state, current);
+}
+
+const char *ControlSystem_GetStateName(void)
+{
+    return states[current].name;
+}
+
+uint32_t ControlSystem_GetDropCount(void)
+{
+    return queue_dropped;
+}
+
+// ===================== 各状态 =====================
+
+static uint8_t Key_Pressed(const ControlEvent *e)
+{
+    return (e->sig == CS_EVT_KEY && e->detail == KEY_EVENT_PRESS) ? e->param : 0;
+}
+
+// 停下后台动作和连续步态；随后启动的单次动作由Behavior_Task等步态回到站姿再开始
+static void ControlSystem_StopMoving(void)
+{
+    Behavior_Cancel();
+    Locomotion_Stop();
+}
+
+// 站姿/坐姿只在没有别的东西驱动舵机时发：步态收步、后台动作、姿态过渡进行中都不打断
+static uint8_t ControlSystem_ServosFree(void)
+{
+    return !Locomotion_IsRunning() && !Behavior_IsRunning() && !Dog_IsMoving();
+}
+
+// 切换模式的提示：提示音 + 短暂显示（转换完成后显示CONTROL_FEEDBACK_MS，不等待）
+static void Mode_Feedback(char *text)
+{
+    Boot_MarkCommand();
+    Buzzer_StartBeep(20);
+    feedback_text = text;
+}
+
+static uint8_t Root_Handler(const ControlEvent *e)
+{
+    switch(Key_Pressed(e)) {
+        case 1:
+            Mode_Feedback("Mode -> BLUETOOTH");
+            ControlSystem_Tran(CS_BLUETOOTH);
+            return 1;
+        case 2:
+            Mode_Feedback("Mode -> AVOIDANCE");
+            ControlSystem_Tran(CS_AVOIDANCE);
+            return 1;
+        case 3:
+            Mode_Feedback("Mode -> HELLO");
+            ControlSystem_Tran(CS_ACTION_HELLO);
+            return 1;
+        case 4:
+            Mode_Feedback("Mode -> IDLE");
+            FallDetect_Reset(); // 摔倒后放弃起身的状态下，按K4恢复舵机输出
+            ControlSystem_StopMoving(); // 回到站姿由IDLE_READY的周期动作完成
+            ControlSystem_Tran(CS_IDLE);
+            return 1;
         default:
             break;
     }
+
+    switch(e->sig) {
+        case CS_EVT_POWER:
+            if(e->param == POWER_CRITICAL) {
+                // 电量严重不足：报警，坐下省电由IDLE_LOW_BATTERY完成
+                OLED_Clear();
+                ControlSystem_StopMoving();
+                Buzzer_StartPattern(BEEP_DOUBLE_BEEP);
+                ControlSystem_Tran(CS_IDLE);
+            }
+            break;
+
+        case CS_EVT_FALL:
+            // 起身时Dog_ClearAbort清掉了中止标志，被打断的后台行为要在这里取消，否则会接着执行
+            ControlSystem_StopMoving();
+            ControlSystem_Tran(CS_IDLE); // 摔倒后不恢复原来的模式，等待新的指令
+            break;
+
+        default:
+            break; // 其余事件在没有状态关心时丢弃
+    }
+    return 1;
+}
+
+// ---------- IDLE ----------
+
+static ControlState Idle_Init(void)
+{
+    if(PowerGovernor_GetLevel() == POWER_CRITICAL) return CS_IDLE_LOW_BATTERY;
+    if(FallDetect_GetState() == FALL_GAVE_UP) return CS_IDLE_FALLEN;
+    return CS_IDLE_READY;
+}
+
+static void Idle_Entry(void)
+{
+    OLED_Clear();
+    Servo_SetHoldTimeout(0, CONTROL_IDLE_HOLD_MS); // 待机时重复发的站立命令角度不变，不会唤醒舵机
+}
+
+static void Idle_Exit(void)
+{
+    Servo_SetHoldTimeout(0, 0); // 离开待机前恢复全部舵机的保持力矩
+}
+
+static uint8_t Idle_Ready_Handler(const ControlEvent *e)
+{
+    if(e->sig != CS_EVT_TIMEOUT) return 0;
+
+    OLED_ShowString(1, 1, "  (^ v ^) Zzz ");
+    OLED_ShowString(2, 1, " K1: BLUETOOTH  ");
+    OLED_ShowString(3, 1, " K2: AVOIDANCE  ");
+    OLED_ShowString(4, 1, " K3: HELLO      ");
+
+    // 后台自检摆舵机时不要打断它；连续步态正在收步时由它自己回到站姿
+    if(!Boot_SelfTestBusy() && ControlSystem_ServosFree()) Dog_StartStand();
+    ControlSystem_Arm(100);
+    return 1;
+}
+
+static uint8_t Idle_LowBattery_Handler(const ControlEvent *e)
+{
+    uint8_t key = Key_Pressed(e);
+
+    if(key && key != 4) {
+        Buzzer_StartPattern(BEEP_DOUBLE_BEEP); // 电量不足，拒绝需要走动的模式
+        return 1;
+    }
+    if(e->sig == CS_EVT_POWER && e->param != POWER_CRITICAL) {
+        ControlSystem_Tran(CS_IDLE); // 电量恢复，回到待机
+        return 1;
+    }
+    if(e->sig == CS_EVT_TIMEOUT) {
+        // 步态停下后坐下并保持，不再每轮重发站立
+        OLED_ShowString(1, 1, "  (x _ x) Low!  ");
+        OLED_ShowString(2, 1, " BATTERY LOW    ");
+        OLED_ShowString(3, 1, " Please charge  ");
+        OLED_ShowString(4, 1, "                ");
+        if(ControlSystem_ServosFree()) Dog_StartSit();
+        ControlSystem_Arm(100);
+        return 1;
+    }
+    return 0;
+}
+
+static uint8_t Idle_Fallen_Handler(const ControlEvent *e)
+{
+    uint8_t key = Key_Pressed(e);
+
+    if(key && key != 4) {
+        Buzzer_StartPattern(BEEP_DOUBLE_BEEP); // 舵机已卸力，先按K4恢复
+        return 1;
+    }
+    if(e->sig == CS_EVT_TIMEOUT) {
+        // 起身失败，舵机已卸力：等人扶起后按K4
+        OLED_ShowString(1, 1, "  (x _ x) Fell! ");
+        OLED_ShowString(2, 1, " Servos OFF     ");
+        OLED_ShowString(3, 1, " Lift me, K4    ");
+        OLED_ShowString(4, 1, "                ");
+        ControlSystem_Arm(100);
+        return 1;
+    }
+    return 0;
+}
+
+// ---------- ACTIVE ----------
+
+static void Active_Exit(void)
+{
+    LED1_OFF(); LED2_OFF(); LED3_OFF(); LED4_OFF();
+}
+
+// 避障和遥控退出时停止连续步态（在下一个相位边界回到站姿）
+static void Moving_Exit(void)
+{
+    Locomotion_Stop();
+}
+
+// ---------- AVOIDANCE ----------
+
+// 读取后台测距缓存，不阻塞；从未测到过时返回-1
+// 回波丢失时仍返回最后的滤波距离，由置信度说明它是否可信
+static float Safe_Ultrasonic_GetDistance(uint8_t *confidence)
+{
+    UltrasonicSample sample = Ultrasonic_GetSample();
+    *confidence = sample.valid ? sample.confidence : 0;
+    if(sample.distance > 0) {
+        return sample.distance;
+    }
+    return -1;
+}
+
+static AvoidState Avoidance_Decision(float distance, uint8_t confidence)
+{
+    if(distance < 0)    return AVOID_WARNING;  // 没有任何读数：停下等待，不能当作安全
+    else if(distance < 10.0) return AVOID_DANGER;  // 10cm内：危险（近距离丢回波时沿用最后的距离，照样转向）
+    else if(distance < 20.0) return AVOID_WARNING; // 20cm内：警告
+    else if(confidence < ULTRASONIC_MIN_CONFIDENCE) return AVOID_WARNING; // 读数不可信：先停下
+    else return AVOID_CLEAR; // 20cm外：安全
+}
+
+static void Draw_Avoidance_Radar(float distance)
+{
+    OLED_ShowString(3, 1, "Distance:       ");
+    if(distance >= 0) {
+        OLED_ShowNum(3, 10, (uint16_t)distance, 3);
+        OLED_ShowString(3, 13, "cm");
+    } else {
+        OLED_ShowString(3, 10, "Error");
+    }
+}
+
+// 执行避障动作，返回决策后保持的时间(ms)；转向时置avoid_turning，转完由CS_EVT_ACTION_DONE触发下一次决策
+static uint32_t Execute_Avoidance_Action(AvoidState state)
+{
+    uint8_t turn_steps;
+
+    action_counter++;
+
+    switch(state) {
+        case AVOID_CLEAR:
+            OLED_ShowString(1, 1, " (> _ <) Run!  ");
+            LED3_ON(); LED1_OFF(); LED2_OFF(); LED4_OFF();
+            Locomotion_Run(LOCO_FORWARD, 0); // 一直走，直到下一次决策改变方向
+            break;
+
+        case AVOID_WARNING:
+            OLED_ShowString(1, 1, " (o _ O) !!    ");
+            LED2_ON(); LED1_OFF(); LED3_OFF(); LED4_OFF();
+            Buzzer_StartBeep(50);
+            Locomotion_Stop();
+            if(ControlSystem_ServosFree()) Dog_StartStand();
+            return 800;
+
+        case AVOID_DANGER:
+            OLED_ShowString(1, 1, " (@ _ @) ??    ");
+            LED1_ON(); LED2_OFF(); LED3_OFF(); LED4_OFF();
+            Buzzer_StartPattern(BEEP_DOUBLE_BEEP);
+
+            // 查障碍物地图，转向更空旷的一侧
+            // 从行走直接切换到转向，不先站立
+            if(ObstacleMap_ChooseTurn(&turn_steps) == OBSTACLE_TURN_LEFT) {
+                OLED_ShowString(2, 1, "ACTION: TURN LEFT ");
+                Locomotion_Run(LOCO_TURN_LEFT, turn_steps);
+            } else {
+                OLED_ShowString(2, 1, "ACTION: TURN RIGHT");
+                Locomotion_Run(LOCO_TURN_RIGHT, turn_steps);
+            }
+            avoid_turning = 1; // 转完之前不重新决策
+            break;
+    }
+    return 0;
 }
 
-SystemState ControlSystem_GetState(void)
+static void Avoidance_Entry(void)
 {
-    return CurrentState;
+    action_counter = 0;
+    avoid_turning = 0;
+    ObstacleMap_Reset();
 }
 
-void Control_Stand(void)
+static uint8_t Avoidance_Handler(const ControlEvent *e)
 {
-    CurrentState = SYS_STANDING;
-    OLED_ShowString(2, 1, "State: STANDING ");
-    Dog_Stand();
-    LED2_ON();
-    LED1_OFF(); LED3_OFF(); LED4_OFF();
-    Buzzer_Beep(50);
+    uint8_t confidence;
+    float distance;
+    uint32_t hold;
+
+    switch(e->sig) {
+        case CS_EVT_OBSTACLE:
+            avoid_turning = 0;
+            ControlSystem_Arm(0); // 距离穿越阈值，立即重新决策（转向中也一样）
+            return 1;
+
+        case CS_EVT_ACTION_DONE:
+            if(!avoid_turning) return 0;
+            avoid_turning = 0;
+            ControlSystem_Arm(2 * ULTRASONIC_PERIOD_MS); // 转完后等一个新的测距结果
+            return 1;
+
+        case CS_EVT_TIMEOUT:
+            distance = Safe_Ultrasonic_GetDistance(&confidence);
+            ObstacleMap_Update();
+            Draw_Avoidance_Radar(distance);
+
+            hold = Execute_Avoidance_Action(Avoidance_Decision(distance, confidence));
+            if(avoid_turning) {
+                ControlSystem_Disarm();
+            } else {
+                // 地图在每一步都已采样，这里只需等一个新的测距结果
+                ControlSystem_Arm(hold + 2 * ULTRASONIC_PERIOD_MS);
+            }
+            return 1;
+
+        default:
+            return 0;
+    }
+}
+
+// ---------- BLUETOOTH ----------
+
+// 在第3行显示当前速度档位
+static void Show_Speed(uint8_t speed)
+{
+    char oled_msg[17];
+    char *p = oled_msg;
+    p += Format_Str(p, "Speed: ");
+    p += Format_UInt(p, speed, 0, ' ');
+    Format_Str(p, "/10    ");
+    OLED_ShowString(3, 1, oled_msg);
 }
 
-void Control_Sit(void)
+static void Bluetooth_Execute(uint8_t cmd)
 {
-    CurrentState = SYS_SITTING;
-    OLED_ShowString(2, 1, "State: SITTING   ");
-    Dog_Sit();
-    LED3_ON();
-    LED1_OFF(); LED2_OFF(); LED4_OFF();
-    Buzzer_Beep(50);
+    char oled_msg[17];
+    char *p;
+    uint8_t speed;
+
+    Boot_MarkCommand();
+    Buzzer_StartBeep(20); // 收到任何有效指令，嘀一声
+
+    switch(cmd) {
+        case CMD_WALK_FORWARD:
+            OLED_ShowString(2, 1, "Action: Forward  ");
+            Bluetooth_SendString("OK: Forward\r\n");
+            Locomotion_Run(LOCO_FORWARD, 0);
+            break;
+
+        case CMD_WALK_BACKWARD:
+            OLED_ShowString(2, 1, "Action: Backward ");
+            Bluetooth_SendString("OK: Backward\r\n");
+            Locomotion_Run(LOCO_BACKWARD, 0);
+            break;
+
+        case CMD_TURN_LEFT:
+            OLED_ShowString(2, 1, "Action: Turn Left");
+            Bluetooth_SendString("OK: Turn Left\r\n");
+            Locomotion_Run(LOCO_TURN_LEFT, 0);
+            break;
+
+        case CMD_TURN_RIGHT:
+            OLED_ShowString(2, 1, "Action:Turn Right");
+            Bluetooth_SendString("OK: Turn Right\r\n");
+            Locomotion_Run(LOCO_TURN_RIGHT, 0);
+            break;
+
+        case CMD_STAND:
+        case CMD_STOP:
+            OLED_ShowString(2, 1, "Action: Stand    ");
+            Bluetooth_SendString("OK: Stand\r\n");
+            ControlSystem_StopMoving(); // 收完当前相位回到站姿
+            if(ControlSystem_ServosFree()) Dog_StartStand();
+            break;
+
+        case CMD_SIT:
+            OLED_ShowString(2, 1, "Action: Sit      ");
+            Bluetooth_SendString("OK: Sit\r\n");
+            ControlSystem_StopMoving();
+            Behavior_Launch(BEHAVIOR_SIT_DOWN); // 坐完后站起来，见Bluetooth_Handler
+            break;
+
+        case CMD_SPEED_UP:
+            speed = Dog_GetWalkSpeed();
+            if(speed < 10) speed++;
+            Dog_SetWalkSpeed(speed);
+            Show_Speed(speed);
+            Bluetooth_SendString("OK: Speed Up\r\n");
+            break;
+
+        case CMD_SPEED_DOWN:
+            speed = Dog_GetWalkSpeed();
+            if(speed > 1) speed--;
+            Dog_SetWalkSpeed(speed);
+            Show_Speed(speed);
+            Bluetooth_SendString("OK: Speed Down\r\n");
+            break;
+
+        case CMD_TEST:
+            OLED_ShowString(2, 1, "Action: Hello!   ");
+            Bluetooth_SendString("OK: Hello\r\n");
+            Buzzer_StartPattern(BEEP_TRIPLE_BEEP);
+            ControlSystem_StopMoving();
+            Behavior_Launch(BEHAVIOR_HELLO);
+            break;
+
+        case CMD_RESET:
+            OLED_ShowString(2, 1, "Action: ShakeBody");
+            Bluetooth_SendString("OK: Shake Body\r\n");
+            ControlSystem_StopMoving();
+            Behavior_Launch(BEHAVIOR_SHAKE_BODY);
+            break;
+
+        default:
+            p = oled_msg;
+            p += Format_Str(p, "Unknown: ");
+            p += Format_Char(p, cmd);
+            Format_Str(p, "     ");
+            OLED_ShowString(2, 1, oled_msg);
+            Bluetooth_SendString("ERR: Unknown CMD\r\n");
+            Buzzer_StartPattern(BEEP_DOUBLE_BEEP); // 收到未知指令，播放错误音
+            break;
+    }
+    // 行走/转向命令不再回到站姿，步态一直运行到停止命令或退出遥控模式
 }
 
-void Control_WalkForward(uint8_t steps)
+static uint8_t Bluetooth_Handler(const ControlEvent *e)
 {
-    CurrentState = SYS_WALKING;
-    OLED_ShowString(2, 1, "State: WALKING   ");
-    LED4_ON();
-    LED1_OFF(); LED2_OFF(); LED3_OFF();
-    Buzzer_BeepPattern(BEEP_DOUBLE_BEEP);
-    Dog_WalkForward(steps);
+    switch(e->sig) {
+        case CS_EVT_BT_CMD:
+            Bluetooth_Execute(e->param);
+            return 1;
+
+        case CS_EVT_ACTION_DONE:
+            if(e->param != MODE_SIT_DOWN || e->detail) return 0;
+            Dog_StartStand(); // 坐下保持1秒后站起来
+            return 1;
+
+        case CS_EVT_TIMEOUT:
+            OLED_ShowString(1, 1, " (o_o) BT Mode ");
+            OLED_ShowString(2, 1, "Waiting CMD...  ");
+            OLED_ShowString(4, 1, " (K4 back IDLE)");
+            ControlSystem_Arm(50);
+            return 1;
+
+        default:
+            return 0;
+    }
 }
 
-void Control_TurnLeft(uint8_t steps)
+// ---------- ACTION_HELLO ----------
+
+static void Hello_Entry(void)
 {
-    CurrentState = SYS_TURNING;
-    OLED_ShowString(2, 1, "State: TURNING   ");
-    LED4_ON();
-    LED1_OFF(); LED2_OFF(); LED3_OFF();
-    Buzzer_Beep(100);
-    Dog_TurnLeft(steps);
+    LED1_ON(); LED2_ON();
+    Buzzer_StartPattern(BEEP_TRIPLE_BEEP); // "你好"专属音效
+    ControlSystem_StopMoving();
+    Behavior_Launch(BEHAVIOR_HELLO); // 后台执行，结束时通过事件总线投递CS_EVT_ACTION_DONE
 }
 
-void Control_TurnRight(uint8_t steps)
+static void Hello_Exit(void)
 {
-    CurrentState = SYS_TURNING;
-    OLED_ShowString(2, 1, "State: TURNING   ");
-    LED4_ON();
-    LED1_OFF(); LED2_OFF(); LED3_OFF();
-    Buzzer_Beep(100);
-    Dog_TurnRight(steps);
+    Behavior_Cancel(); // 动作没做完就切换了模式
+    OLED_Clear();
 }
 
-void Control_Stop(void)
+static uint8_t Hello_Handler(const ControlEvent *e)
 {
-    Control_Stand();
+    switch(e->sig) {
+        case CS_EVT_TIMEOUT:
+            // 转换后的第一次到期（模式提示显示完之后）画一次画面，不再重设定时器
+            OLED_Clear();
+            OLED_ShowString(1, 1, "== ACTION ==");
+            OLED_ShowString(2, 1, "  (^ o ^)/ Hi! ");
+            return 1;
+
+        case CS_EVT_ACTION_DONE:
+            if(e->param != MODE_HELLO) return 0;
+            ControlSystem_Tran(CS_IDLE);
+            return 1;
+
+        default:
+            return 0;
+    }
 }
@@ -3,27 +3,66 @@
 
 #include "stm32f10x.h"
 
-// 系统状态
+// 系统模式层次状态机：按键、蓝牙、传感器和动作完成都变成事件放进队列，
+// 主循环逐个分发，每个事件处理完（包括退出/进入动作）才处理下一个。
+// 子状态不处理的事件交给父状态，层次最多3层，一次转换的代价是常数。
+// 处理函数不等待：要过一段时间再做的事由状态定时器到期投递CS_EVT_TIMEOUT，
+// 单次动作在后台执行，结束时投递CS_EVT_ACTION_DONE。
+//
+//   ROOT                    K1/K2/K3切换模式，K4回到空闲，摔倒/电量严重不足回到空闲
+//   ├─ IDLE                 不走动；进入时按条件选择子状态
+//   │   ├─ IDLE_READY       待机菜单，保持站立
+//   │   ├─ IDLE_LOW_BATTERY 电量严重不足，坐下，拒绝K1~K3
+//   │   └─ IDLE_FALLEN      起身失败，舵机卸力，等K4
+//   └─ ACTIVE               会走动的模式
+//       ├─ AVOIDANCE        超声波避障
+//       ├─ BLUETOOTH        蓝牙遥控
+//       └─ ACTION_HELLO     单次动作，完成后回到空闲
+
+#define CONTROL_QUEUE_SIZE      16
+#define CONTROL_MAX_DEPTH       3     // 状态层次深度（不含ROOT）
+#define CONTROL_FEEDBACK_MS     300   // 切换模式时提示文字的显示时间
+#define CONTROL_IDLE_HOLD_MS    5000  // 待机时舵机静止这么久就停发脉冲卸力，有动作时自动恢复
+
 typedef enum {
-    SYS_IDLE = 0,
-    SYS_STANDING,
-    SYS_WALKING,
-    SYS_TURNING,
-    SYS_SITTING
-} SystemState;
+    CS_ROOT = 0,
+    CS_IDLE,
+    CS_IDLE_READY,
+    CS_IDLE_LOW_BATTERY,
+    CS_IDLE_FALLEN,
+    CS_ACTIVE,
+    CS_AVOIDANCE,
+    CS_BLUETOOTH,
+    CS_ACTION_HELLO,
+    CS_STATE_NUM
+} ControlState;
+
+typedef enum {
+    CS_EVT_NONE = 0,
+    CS_EVT_TIMEOUT,       // 状态定时器到期，执行当前状态的周期动作；param: 定时器序号（过期的不分发）
+    CS_EVT_KEY,           // param: 按键编号，detail: KeyEventType
+    CS_EVT_BT_CMD,        // param: 蓝牙命令字符
+    CS_EVT_OBSTACLE,      // 超声波阈值穿越（中断中投递），param: 1靠近 0远离
+    CS_EVT_POWER,         // 电量等级变化，param: PowerLevel
+    CS_EVT_FALL,          // 处理完一次摔倒，param: FallState
+    CS_EVT_ACTION_DONE    // 动作结束（来自EventBus），param: DogMode，detail: 1被中止
+} ControlSignal;
+
+typedef struct {
+    uint8_t sig;          // ControlSignal
+    uint8_t param;
+    uint8_t detail;
+} ControlEvent;
 
 // 函数声明
 void ControlSystem_Init(void);
-void ControlSystem_Update(void);
-SystemState ControlSystem_GetState(void);
-
-// 用户控制接口
-void Control_Stand(void);
-void Control_Sit(void);
-void Control_WalkForward(uint8_t steps);
-void Control_WalkBackward(uint8_t steps);
-void Control_TurnLeft(uint8_t steps);
-void Control_TurnRight(uint8_t steps);
-void Control_Stop(void);
+void ControlSystem_Poll(void);                 // 把按键、蓝牙、电量、摔倒转换成事件
+void ControlSystem_Run(void);                  // 分发队列中的全部事件
+uint8_t ControlSystem_Post(uint8_t sig, uint8_t param, uint8_t detail); // 可在中断中调用，返回0表示队列已满
+ControlState ControlSystem_GetState(void);
+uint8_t ControlSystem_IsIn(ControlState state); // 当前状态是state或其子状态
+const char *ControlSystem_GetStateName(void);
+uint32_t ControlSystem_GetDropCount(void);
+void ControlSystem_HoldDisplay(uint32_t ms);   // 画好屏幕后调用，ms内状态不重画
 
 #endif
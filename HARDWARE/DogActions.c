@@ -1,14 +1,32 @@
 #include "DogActions.h"
 #include "Servo.h"
+#include "PWM.h"
 #include "Delay.h"
 #include "stddef.h"
+#include "PowerGovernor.h"
+#include "Posture.h"
+#include "EventBus.h"
+#include "FlashStore.h"
+#include "Behavior.h"
+#include "Profile.h"
 
 // 全局变量
 static uint8_t WalkSpeed = 5;
 static void (*ActionCompleteCallback)(void) = NULL;
+static DogStepCallback StepCallback = NULL;
+static int16_t Heading = 0; // 推算航向(度)，左转为正
+static volatile uint8_t Aborted = 0;
+static DogMode ActionMode = MODE_INIT; // 正在执行的动作，用作事件来源
+static uint8_t ActionSteps = 0;        // 总步数，0表示不是步态
+static uint8_t ActionDone = 0;         // 已完成的步数
+static const uint8_t LegIds[DOG_LEG_NUM] = {SERVO_FRONT_LEFT, SERVO_FRONT_RIGHT, SERVO_REAR_LEFT, SERVO_REAR_RIGHT}; // 各腿髋关节，顺序同DogLeg
+static Trajectory Moves[SERVO_NUM];     // 各舵机的插值轨迹，下标为舵机编号-1
+static volatile uint16_t MoveMask = 0;  // 正在插值的舵机，帧回调走完一个清一位
+static uint8_t MoveHooked = 0;
 
-// 舵机角度配置
-static ServoAngles ServoConfig[5] = {
+// 舵机角度出厂配置，按舵机编号；膝关节只用stand/sit/lift_high（摆动相抬腿时的角度），侧摆关节只用stand/sit
+// 标定后的配置保存在Flash里，Dog_Init时读回ServoConfig，没有保存过就用这张表
+static const ServoAngles ServoConfigDefault[SERVO_NUM + 1] = {
     {0, 0, 0, 0, 0, 0}, // 索引0不用
     // 舵机1 - 前右腿
     {90.0f,  45.0f,  110.0f, 70.0f,  120.0f, 60.0f},
@@ -17,35 +35,250 @@ static ServoAngles ServoConfig[5] = {
     // 舵机3 - 后左腿
     {90.0f,  135.0f, 70.0f,  110.0f, 60.0f,  120.0f},
     // 舵机4 - 后右腿
-    {90.0f,  45.0f,  110.0f, 70.0f,  120.0f, 60.0f}
+    {90.0f,  45.0f,  110.0f, 70.0f,  120.0f, 60.0f},
+#if DOG_JOINT_NUM >= 2
+    // 舵机5~8 - 膝关节（前右 前左 后左 后右），左右两侧安装方向相反
+    {90.0f,  60.0f,  120.0f, 90.0f,  90.0f,  90.0f},
+    {90.0f,  120.0f, 60.0f,  90.0f,  90.0f,  90.0f},
+    {90.0f,  120.0f, 60.0f,  90.0f,  90.0f,  90.0f},
+    {90.0f,  60.0f,  120.0f, 90.0f,  90.0f,  90.0f},
+#endif
+#if DOG_JOINT_NUM >= 3
+    // 舵机9~12 - 侧摆关节，保持竖直
+    {90.0f,  90.0f,  90.0f,  90.0f,  90.0f,  90.0f},
+    {90.0f,  90.0f,  90.0f,  90.0f,  90.0f,  90.0f},
+    {90.0f,  90.0f,  90.0f,  90.0f,  90.0f,  90.0f},
+    {90.0f,  90.0f,  90.0f,  90.0f,  90.0f,  90.0f},
+#endif
 };
+static ServoAngles ServoConfig[SERVO_NUM + 1];
+
+// 舵机帧回调（中断上下文）：推进各舵机的轨迹
+static void Dog_MoveFrame(void)
+{
+    uint16_t mask = MoveMask;
+    uint8_t i;
+
+    if(!mask) return;
+    if(Aborted) {
+        MoveMask = 0; // 停在当前角度
+        return;
+    }
+    PROFILE_BEGIN(PROFILE_DOG_FRAME);
+    for(i = 0; i < SERVO_NUM; i++) {
+        if(!(mask & (1 << i))) continue;
+        Servo_SetCommand(i + 1, Trajectory_Step(&Moves[i], 1000 / PWM_FRAME_HZ) / 100.0f);
+        if(Trajectory_IsDone(&Moves[i])) mask &= ~(1 << i);
+    }
+    MoveMask = mask;
+    PROFILE_END(PROFILE_DOG_FRAME);
+}
+
+/**
+  * @brief  腿的某个关节对应的舵机
+  * @param  leg: 哪条腿
+  * @param  joint: 哪个关节
+  * @retval 舵机编号，0表示这个版本没有该关节
+  * @detail 关节j的舵机编号 = 髋关节编号 + 4*j，与PWM通道表的顺序一致
+  */
+uint8_t Dog_GetJointServo(DogLeg leg, DogJoint joint)
+{
+    if(leg >= DOG_LEG_NUM || joint >= DOG_JOINT_NUM) return 0;
+    return LegIds[leg] + DOG_LEG_NUM * joint;
+}
 
 void Dog_Init(void)
 {
+    Dog_ResetServoConfig();
+    Dog_LoadServoConfig(); // 没有保存过或格式不对时保持出厂配置
     Servo_Init();
-    Dog_ResetPose();
+    if(!MoveHooked) {
+        MoveHooked = Servo_AddFrameHook(Dog_MoveFrame);
+    }
+    Dog_Stand(); // 站立姿态即全90度，不再等待Dog_ResetPose的500ms
+}
+
+// 实际使用的速度：用户设定值，但不超过电量允许的上限
+static uint8_t Dog_EffectiveSpeed(void)
+{
+    uint8_t max_speed = PowerGovernor_GetLimits()->max_speed;
+    return (WalkSpeed > max_speed) ? max_speed : WalkSpeed;
 }
 
+// 四条腿按电量限制分批启动，电量不足时避免四个舵机同时起步拉低电压
 void Dog_SetAllServos(float fl_angle, float fr_angle, float rl_angle, float rr_angle)
 {
-    Servo_SetAngle(SERVO_FRONT_LEFT, fl_angle);
-    Servo_SetAngle(SERVO_FRONT_RIGHT, fr_angle);
-    Servo_SetAngle(SERVO_REAR_LEFT, rl_angle);
-    Servo_SetAngle(SERVO_REAR_RIGHT, rr_angle);
+    const PowerLimits *limits = PowerGovernor_GetLimits();
+    const uint8_t ids[4] = {SERVO_FRONT_LEFT, SERVO_FRONT_RIGHT, SERVO_REAR_LEFT, SERVO_REAR_RIGHT};
+    float angles[4];
+    uint8_t i, started = 0;
+
+    MoveMask = 0; // 直接设定角度时放弃未走完的插值
+    angles[0] = fl_angle; angles[1] = fr_angle; angles[2] = rl_angle; angles[3] = rr_angle;
+    for(i = 0; i < 4; i++) {
+        if(Servo_GetAngle(ids[i]) == angles[i]) continue; // 角度没变的腿不占分批名额，也不等待
+        if(started && started % limits->max_concurrent == 0) {
+            Delay_ms(limits->stagger_ms);
+        }
+        Servo_SetAngle(ids[i], angles[i]);
+        started++;
+    }
 }
 
+// 低电量时放慢：按电量限制的倍率拉长过渡时间
+static uint16_t Dog_ScaleDuration(uint16_t duration_ms)
+{
+    uint32_t ms = (uint32_t)duration_ms * PowerGovernor_GetLimits()->slew_percent / 100;
+    return (ms > 0xFFFF) ? 0xFFFF : (uint16_t)ms;
+}
+
+// 在中断里用到的轨迹要整体替换，关中断避免帧回调读到一半
+static void Dog_StartMove(uint8_t servo_id, float from, float to, uint16_t duration_ms,
+                          TrajProfile profile, int16_t v0, int16_t v1)
+{
+    uint8_t i = servo_id - 1;
+    __disable_irq();
+    Trajectory_Start(&Moves[i], (int16_t)(from * 100), (int16_t)(to * 100), duration_ms, profile);
+    Trajectory_SetSlopes(&Moves[i], v0, v1);
+    MoveMask |= 1 << i;
+    __enable_irq();
+}
+
+// 等待所有舵机走完轨迹
+static uint8_t Dog_WaitMove(void)
+{
+    while(MoveMask && !Aborted) {
+        Delay_ms(1000 / PWM_FRAME_HZ);
+    }
+    return !Aborted;
+}
+
+/**
+  * @brief  单个舵机平滑转动（最小加加速度曲线，逐帧插值）
+  * @param  servo_id: 舵机编号 [1, SERVO_NUM]
+  * @param  start_angle: 起始角度
+  * @param  end_angle: 目标角度
+  * @param  duration_ms: 时长，低电量时按电量限制拉长
+  * @retval 无
+  */
 void Dog_SmoothMove(uint8_t servo_id, float start_angle, float end_angle, uint16_t duration_ms)
 {
-    const uint8_t steps = 10;
-    float current_angle = start_angle;
-    float increment = (end_angle - start_angle) / steps;
-    uint16_t step_delay = duration_ms / steps;
-    
-    for(uint8_t i = 0; i <= steps; i++) {
-        Servo_SetAngle(servo_id, current_angle);
-        current_angle += increment;
-        Delay_ms(step_delay);
+    if(servo_id < 1 || servo_id > SERVO_NUM) return;
+    Dog_StartMove(servo_id, start_angle, end_angle, Dog_ScaleDuration(duration_ms), TRAJ_MIN_JERK, 0, 0);
+    Dog_WaitMove();
+}
+
+/**
+  * @brief  四条腿的髋关节同时从当前角度插值到目标姿态，其余关节不动
+  * @param  fl_angle~rr_angle: 目标角度
+  * @param  duration_ms: 过渡时长，0表示直接设定（同Dog_SetAllServos）
+  * @param  profile: 插值曲线
+  * @retval 1完成，0中途被Dog_Abort中止（腿停在当前角度）
+  * @detail 插值在舵机帧中断里逐帧进行，舵机不再全速冲向目标，起步电流和冲击小
+  */
+uint8_t Dog_MoveTo(float fl_angle, float fr_angle, float rl_angle, float rr_angle,
+                   uint16_t duration_ms, TrajProfile profile)
+{
+    if(duration_ms == 0) {
+        Dog_SetAllServos(fl_angle, fr_angle, rl_angle, rr_angle);
+        return !Aborted;
+    }
+    Dog_StartPose(fl_angle, fr_angle, rl_angle, rr_angle, duration_ms, profile);
+    return Dog_WaitMove();
+}
+
+/**
+  * @brief  开始髋关节的姿态过渡，不等待（供协作式任务使用，用Dog_IsMoving查询是否走完）
+  * @param  fl_angle~rr_angle: 目标角度
+  * @param  duration_ms: 过渡时长，0表示下一帧直接设定（经过舵机限速）
+  * @param  profile: 插值曲线
+  * @retval 无
+  */
+void Dog_StartPose(float fl_angle, float fr_angle, float rl_angle, float rr_angle,
+                   uint16_t duration_ms, TrajProfile profile)
+{
+    float angles[4];
+    uint8_t i;
+
+    angles[0] = fl_angle; angles[1] = fr_angle; angles[2] = rl_angle; angles[3] = rr_angle;
+    if(duration_ms == 0) {
+        MoveMask = 0;
+        for(i = 0; i < DOG_LEG_NUM; i++) Servo_SetCommand(LegIds[i], angles[i]);
+        return;
     }
+    duration_ms = Dog_ScaleDuration(duration_ms);
+    for(i = 0; i < DOG_LEG_NUM; i++) {
+        Dog_StartMove(LegIds[i], Servo_GetAngle(LegIds[i]), angles[i], duration_ms, profile, 0, 0);
+    }
+}
+
+uint8_t Dog_IsMoving(void)
+{
+    return MoveMask != 0;
+}
+
+// 姿态切换：全部舵机插值到targets（下标为舵机编号-1），时长按转动最大的关节计算，最小加加速度曲线
+// 只开始过渡不等待，返回0表示已经在目标姿态
+static uint8_t Dog_StartJoints(const float *targets)
+{
+    float d, max_d = 0;
+    uint32_t ms;
+    uint8_t i;
+
+    for(i = 0; i < SERVO_NUM; i++) {
+        d = targets[i] - Servo_GetAngle(i + 1);
+        if(d < 0) d = -d;
+        if(d > max_d) max_d = d;
+    }
+    if(max_d < 0.5f) {
+        MoveMask = 0;
+        for(i = 0; i < SERVO_NUM; i++) Servo_SetCommand(i + 1, targets[i]); // 已经在目标姿态
+        return 0;
+    }
+    ms = (uint32_t)(max_d * DOG_POSE_MS_PER_DEG);
+    if(ms < DOG_POSE_MIN_MS) ms = DOG_POSE_MIN_MS;
+    if(ms > DOG_POSE_MAX_MS) ms = DOG_POSE_MAX_MS;
+    ms = Dog_ScaleDuration((uint16_t)ms);
+    for(i = 0; i < SERVO_NUM; i++) {
+        Dog_StartMove(i + 1, Servo_GetAngle(i + 1), targets[i], (uint16_t)ms, TRAJ_MIN_JERK, 0, 0);
+    }
+    return 1;
+}
+
+static void Dog_MoveJoints(const float *targets)
+{
+    if(Dog_StartJoints(targets)) Dog_WaitMove();
+}
+
+// 全部关节切换到配置里的站姿或坐姿
+static uint8_t Dog_StartConfigPose(uint8_t sit)
+{
+    float targets[SERVO_NUM];
+    uint8_t i;
+
+    for(i = 0; i < SERVO_NUM; i++) {
+        targets[i] = sit ? ServoConfig[i + 1].sit : ServoConfig[i + 1].stand;
+    }
+    return Dog_StartJoints(targets);
+}
+
+static void Dog_MoveConfigPose(uint8_t sit)
+{
+    if(Dog_StartConfigPose(sit)) Dog_WaitMove();
+}
+
+// 开始过渡到站姿，不等待（供协作式任务使用）
+void Dog_StartStand(void)
+{
+    Posture_Enable(1);
+    Dog_StartConfigPose(0);
+}
+
+// 开始过渡到坐姿，不等待
+void Dog_StartSit(void)
+{
+    Posture_Enable(0);
+    Dog_StartConfigPose(1);
 }
 
 void Dog_SetWalkSpeed(uint8_t speed)
@@ -67,82 +300,217 @@ static void Dog_NotifyActionComplete(void)
     }
 }
 
+// 动作开始：发布开始事件，步数为0表示不是按步计的动作
+static void Dog_BeginAction(DogMode mode, uint8_t steps)
+{
+    ActionMode = mode;
+    ActionSteps = steps;
+    ActionDone = 0;
+    EventBus_Publish(EVENT_ACTION_START, mode, steps);
+}
+
+// 动作结束：被中止时发布取消事件，否则发布完成事件并调用完成回调
+static void Dog_EndAction(void)
+{
+    if(Aborted) {
+        EventBus_Publish(EVENT_ACTION_CANCEL, ActionMode, ActionDone);
+        return;
+    }
+    EventBus_Publish(EVENT_ACTION_COMPLETE, ActionMode, ActionDone);
+    Dog_NotifyActionComplete();
+}
+
+void Dog_SetStepCallback(DogStepCallback callback)
+{
+    StepCallback = callback;
+}
+
+int16_t Dog_GetHeading(void)
+{
+    return Heading;
+}
+
+void Dog_ResetHeading(void)
+{
+    Heading = 0;
+}
+
+void Dog_Abort(void)
+{
+    Aborted = 1;
+}
+
+void Dog_ClearAbort(void)
+{
+    Aborted = 0;
+}
+
+uint8_t Dog_IsAborted(void)
+{
+    return Aborted;
+}
+
+static void Dog_KeyframeAngles(const DogKeyframe *frame, float angles[4])
+{
+    angles[0] = frame->fl; angles[1] = frame->fr; angles[2] = frame->rl; angles[3] = frame->rr;
+}
+
+/**
+  * @brief  按表播放关键帧
+  * @param  frames: 关键帧数组
+  * @param  count: 帧数
+  * @retval 1播放完成，0中途被Dog_Abort中止
+  * @detail 有过渡时间的帧用三次Hermite插值过去；途经点的斜率取前后两帧连线
+  *         (Catmull-Rom)，按两段时长分配，两段在途经点处速度相同
+  */
+uint8_t Dog_PlayKeyframes(const DogKeyframe *frames, uint8_t count)
+{
+    float from[4], to[4], next[4];
+    float rate[4] = {0, 0, 0, 0};  // 途经点处的速度(度/ms)，作为下一段的起点斜率
+    uint16_t move, next_move;
+    int16_t v0, v1;
+    uint8_t i, leg, via;
+
+    Dog_BeginAction(MODE_KEYFRAMES, count);
+    for(i = 0; i < count && !Aborted; i++) {
+        move = frames[i].move_ms;
+        Dog_KeyframeAngles(&frames[i], to);
+        if(move == 0) {
+            Dog_SetAllServos(to[0], to[1], to[2], to[3]);
+            for(leg = 0; leg < 4; leg++) rate[leg] = 0;
+        } else {
+            next_move = (i + 1 < count) ? frames[i + 1].move_ms : 0;
+            via = (frames[i].hold_ms == 0 && next_move != 0);
+            if(via) Dog_KeyframeAngles(&frames[i + 1], next);
+            for(leg = 0; leg < 4; leg++) {
+                from[leg] = Servo_GetAngle(LegIds[leg]);
+                v0 = (int16_t)(rate[leg] * move * 100);
+                rate[leg] = via ? (next[leg] - from[leg]) / (move + next_move) : 0;
+                v1 = (int16_t)(rate[leg] * move * 100);
+                Dog_StartMove(LegIds[leg], from[leg], to[leg], Dog_ScaleDuration(move), TRAJ_CUBIC, v0, v1);
+            }
+            Dog_WaitMove();
+        }
+        Delay_ms(frames[i].hold_ms);
+        ActionDone++;
+        EventBus_Publish(EVENT_ACTION_PROGRESS, MODE_KEYFRAMES, (uint16_t)ActionDone * 100 / count);
+    }
+    Dog_EndAction();
+    return !Aborted;
+}
+
+uint8_t Dog_GetEffectiveSpeed(void)
+{
+    return Dog_EffectiveSpeed();
+}
+
+/**
+  * @brief  记一步：累计航向，通知上层（避障地图在这里采样）
+  * @param  mode: 刚完成的步态
+  * @retval 无
+  * @detail 阻塞步态在每步结束时调用；连续步态(Locomotion)在主循环里补报
+  */
+void Dog_ReportStep(DogMode mode)
+{
+    if(mode == MODE_TURN_LEFT) {
+        Heading += DOG_TURN_STEP_DEG;
+        if(Heading >= 360) Heading -= 360;
+    } else if(mode == MODE_TURN_RIGHT) {
+        Heading -= DOG_TURN_STEP_DEG;
+        if(Heading < 0) Heading += 360;
+    }
+    if(StepCallback != NULL) {
+        StepCallback(mode);
+    }
+}
+
+// 阻塞步态每走完一步：记一步并发布进度
+static void Dog_StepDone(DogMode mode)
+{
+    Dog_ReportStep(mode);
+    ActionDone++;
+    if(ActionSteps) {
+        EventBus_Publish(EVENT_ACTION_PROGRESS, mode, (uint16_t)ActionDone * 100 / ActionSteps);
+    }
+}
+
 void Dog_Stand(void)
 {
-    Servo_SetAngle(SERVO_FRONT_LEFT, ServoConfig[SERVO_FRONT_LEFT].stand);
-    Servo_SetAngle(SERVO_FRONT_RIGHT, ServoConfig[SERVO_FRONT_RIGHT].stand);
-    Servo_SetAngle(SERVO_REAR_LEFT, ServoConfig[SERVO_REAR_LEFT].stand);
-    Servo_SetAngle(SERVO_REAR_RIGHT, ServoConfig[SERVO_REAR_RIGHT].stand); 
+    Posture_Enable(1); // 站立和步态都保持机身水平
+    Dog_MoveConfigPose(0);
 }
 
 void Dog_Sit(void)
 {
-    Dog_SetAllServos(
-        ServoConfig[SERVO_FRONT_LEFT].sit,
-        ServoConfig[SERVO_FRONT_RIGHT].sit,
-        ServoConfig[SERVO_REAR_LEFT].sit,
-        ServoConfig[SERVO_REAR_RIGHT].sit
-    );
+    Posture_Enable(0); // 坐姿本来就是倾斜的，不能让姿态闭环去"扶正"
+    Dog_MoveConfigPose(1);
     Delay_ms(500);
 }
 
 void Dog_WalkForward(uint8_t steps)
 {
-    uint16_t step_delay = 200 - (WalkSpeed * 15);
+    Posture_Enable(1);
+    Dog_BeginAction(MODE_WALK_FORWARD, steps);
+    uint16_t step_delay = 200 - (Dog_EffectiveSpeed() * 15);
+    uint16_t stagger = PowerGovernor_GetLimits()->stagger_ms; // 电量越低间隔越长
     
-    for(uint8_t step = 0; step < steps; step++) {
+    for(uint8_t step = 0; step < steps && !Aborted; step++) {
         
         // 💥 修正：分时启动，平滑电流尖峰
         
         // 相位1：抬左前腿和右后腿，推右前腿和左后腿
         Servo_SetAngle(SERVO_FRONT_LEFT, ServoConfig[SERVO_FRONT_LEFT].lift_high);   // 前左抬 (ID 2)
-        Delay_ms(20); // <-- 增加 20ms 延时
+        Delay_ms(stagger); // <-- 分时启动间隔
         Servo_SetAngle(SERVO_FRONT_RIGHT, ServoConfig[SERVO_FRONT_RIGHT].push_low);  // 前右推 (ID 1)
-        Delay_ms(20); // <-- 增加 20ms 延时
+        Delay_ms(stagger); // <-- 分时启动间隔
         Servo_SetAngle(SERVO_REAR_LEFT, ServoConfig[SERVO_REAR_LEFT].push_low);      // 后左推 (ID 3)
-        Delay_ms(20); // <-- 增加 20ms 延时
+        Delay_ms(stagger); // <-- 分时启动间隔
         Servo_SetAngle(SERVO_REAR_RIGHT, ServoConfig[SERVO_REAR_RIGHT].lift_high);   // 后右抬 (ID 4)
         Delay_ms(step_delay / 2); // 保持原来的主延时
         
         // 相位2：向前摆动
         Servo_SetAngle(SERVO_FRONT_LEFT, ServoConfig[SERVO_FRONT_LEFT].lift_low);    // 前左摆 (ID 2)
-        Delay_ms(20);
+        Delay_ms(stagger);
         Servo_SetAngle(SERVO_FRONT_RIGHT, ServoConfig[SERVO_FRONT_RIGHT].push_high); // 前右摆 (ID 1)
-        Delay_ms(20);
+        Delay_ms(stagger);
         Servo_SetAngle(SERVO_REAR_LEFT, ServoConfig[SERVO_REAR_LEFT].push_high);     // 后左摆 (ID 3)
-        Delay_ms(20);
+        Delay_ms(stagger);
         Servo_SetAngle(SERVO_REAR_RIGHT, ServoConfig[SERVO_REAR_RIGHT].lift_low);    // 后右摆 (ID 4)
         Delay_ms(step_delay / 2);
         
         // 相位3：抬右前腿和左后腿，推左前腿和右后腿
         Servo_SetAngle(SERVO_FRONT_LEFT, ServoConfig[SERVO_FRONT_LEFT].push_low);    // 前左推 (ID 2)
-        Delay_ms(20);
+        Delay_ms(stagger);
         Servo_SetAngle(SERVO_FRONT_RIGHT, ServoConfig[SERVO_FRONT_RIGHT].lift_high); // 前右抬 (ID 1)
-        Delay_ms(20);
+        Delay_ms(stagger);
         Servo_SetAngle(SERVO_REAR_LEFT, ServoConfig[SERVO_REAR_LEFT].lift_high);     // 后左抬 (ID 3)
-        Delay_ms(20);
+        Delay_ms(stagger);
         Servo_SetAngle(SERVO_REAR_RIGHT, ServoConfig[SERVO_REAR_RIGHT].push_low);    // 后右推 (ID 4)
         Delay_ms(step_delay / 2);
         
         // 相位4：向前摆动
         Servo_SetAngle(SERVO_FRONT_LEFT, ServoConfig[SERVO_FRONT_LEFT].push_high);   // 前左摆 (ID 2)
-        Delay_ms(20);
+        Delay_ms(stagger);
         Servo_SetAngle(SERVO_FRONT_RIGHT, ServoConfig[SERVO_FRONT_RIGHT].lift_low);  // 前右摆 (ID 1)
-        Delay_ms(20);
+        Delay_ms(stagger);
         Servo_SetAngle(SERVO_REAR_LEFT, ServoConfig[SERVO_REAR_LEFT].lift_low);      // 后左摆 (ID 3)
-        Delay_ms(20);
+        Delay_ms(stagger);
         Servo_SetAngle(SERVO_REAR_RIGHT, ServoConfig[SERVO_REAR_RIGHT].push_high);   // 后右摆 (ID 4)
         Delay_ms(step_delay / 2);
+        Dog_StepDone(MODE_WALK_FORWARD);
     }
     
     Dog_Stand();
+    Dog_EndAction();
 }
 
 void Dog_WalkBackward(uint8_t steps)
 {
-    uint16_t step_delay = 200 - (WalkSpeed * 15);
+    Posture_Enable(1);
+    Dog_BeginAction(MODE_WALK_BACKWARD, steps);
+    uint16_t step_delay = 200 - (Dog_EffectiveSpeed() * 15);
     
-    for(uint8_t step = 0; step < steps; step++) {
+    for(uint8_t step = 0; step < steps && !Aborted; step++) {
         Dog_SetAllServos(
             ServoConfig[SERVO_FRONT_LEFT].lift_high,
             ServoConfig[SERVO_FRONT_RIGHT].push_low,
@@ -174,18 +542,21 @@ void Dog_WalkBackward(uint8_t steps)
             ServoConfig[SERVO_REAR_RIGHT].push_high
         );
         Delay_ms(step_delay / 2);
+        Dog_StepDone(MODE_WALK_BACKWARD);
     }
     
     Dog_Stand();
-    // Dog_NotifyActionComplete();
+    Dog_EndAction();
 }
 
 
 void Dog_TurnLeft(uint8_t steps)
 {
-    uint16_t step_delay = 300 - (WalkSpeed * 20);
+    Posture_Enable(1);
+    Dog_BeginAction(MODE_TURN_LEFT, steps);
+    uint16_t step_delay = 300 - (Dog_EffectiveSpeed() * 20);
     
-    for(uint8_t step = 0; step < steps; step++) {
+    for(uint8_t step = 0; step < steps && !Aborted; step++) {
         // 左转：右腿向前，左腿向后
         Servo_SetAngle(SERVO_FRONT_LEFT, 70);   // 前左向后
         Servo_SetAngle(SERVO_FRONT_RIGHT, 110); // 前右向前
@@ -198,16 +569,20 @@ void Dog_TurnLeft(uint8_t steps)
         Servo_SetAngle(SERVO_REAR_LEFT, 110);   // 后左向前
         Servo_SetAngle(SERVO_REAR_RIGHT, 70);   // 后右向后
         Delay_ms(step_delay);
+        Dog_StepDone(MODE_TURN_LEFT);
     }
     
     Dog_Stand();
+    Dog_EndAction();
 }
 
 void Dog_TurnRight(uint8_t steps)
 {
-    uint16_t step_delay = 300 - (WalkSpeed * 20);
+    Posture_Enable(1);
+    Dog_BeginAction(MODE_TURN_RIGHT, steps);
+    uint16_t step_delay = 300 - (Dog_EffectiveSpeed() * 20);
     
-    for(uint8_t step = 0; step < steps; step++) {
+    for(uint8_t step = 0; step < steps && !Aborted; step++) {
         // 💥 修正：右转：左腿向前，右腿向后
         Servo_SetAngle(SERVO_FRONT_LEFT, 110);  // 前左向前
         Servo_SetAngle(SERVO_FRONT_RIGHT, 70);   // 前右向后
@@ -221,10 +596,11 @@ void Dog_TurnRight(uint8_t steps)
         Servo_SetAngle(SERVO_REAR_LEFT, 70);    // 后左向后
         Servo_SetAngle(SERVO_REAR_RIGHT, 110);  // 后右向前
         Delay_ms(step_delay);
+        Dog_StepDone(MODE_TURN_RIGHT);
     }
     
     Dog_Stand();
-    //Dog_NotifyActionComplete();
+    Dog_EndAction();
 }
 
 void Dog_ResetPose(void)
@@ -278,7 +654,7 @@ void Dog_AdjustServoConfig(uint8_t servo_id, float stand, float sit,
                           float lift_high, float lift_low, 
                           float push_high, float push_low)
 {
-    if(servo_id >= 1 && servo_id <= 4) {
+    if(servo_id >= 1 && servo_id <= SERVO_NUM) {
         ServoConfig[servo_id].stand = stand;
         ServoConfig[servo_id].sit = sit;
         ServoConfig[servo_id].lift_high = lift_high;
@@ -290,17 +666,73 @@ void Dog_AdjustServoConfig(uint8_t servo_id, float stand, float sit,
 
 ServoAngles Dog_GetServoConfig(uint8_t servo_id)
 {
-    if(servo_id >= 1 && servo_id <= 4) {
+    if(servo_id >= 1 && servo_id <= SERVO_NUM) {
         return ServoConfig[servo_id];
     }
     return ServoConfig[0];
 }
 
+void Dog_ResetServoConfig(void)
+{
+    uint8_t i;
+    for(i = 0; i <= SERVO_NUM; i++) {
+        ServoConfig[i] = ServoConfigDefault[i];
+    }
+}
+
+// 角度按0.01度存成int16，舵机1~SERVO_NUM依次排列，每个舵机6个值，顺序同ServoAngles
+static int16_t Dog_ToCentiDeg(float angle)
+{
+    return (int16_t)(angle * 100.0f + (angle >= 0 ? 0.5f : -0.5f));
+}
+
+/**
+  * @brief  把当前舵机配置保存到Flash
+  * @retval 1成功，0写Flash失败
+  * @detail 擦页时CPU停顿约20ms，期间舵机帧中断会晚到，不要在走路时保存
+  */
+uint8_t Dog_SaveServoConfig(void)
+{
+    int16_t record[SERVO_NUM * 6];
+    int16_t *p = record;
+    uint8_t i;
+
+    for(i = 1; i <= SERVO_NUM; i++) {
+        *p++ = Dog_ToCentiDeg(ServoConfig[i].stand);
+        *p++ = Dog_ToCentiDeg(ServoConfig[i].sit);
+        *p++ = Dog_ToCentiDeg(ServoConfig[i].lift_high);
+        *p++ = Dog_ToCentiDeg(ServoConfig[i].lift_low);
+        *p++ = Dog_ToCentiDeg(ServoConfig[i].push_high);
+        *p++ = Dog_ToCentiDeg(ServoConfig[i].push_low);
+    }
+    return FlashStore_Save(FLASH_STORE_CALIBRATION, DOG_CONFIG_VERSION, record, sizeof(record));
+}
+
+/**
+  * @brief  从Flash读回舵机配置
+  * @retval 1成功，0没有保存过（或版本、舵机数不同），配置不变
+  */
+uint8_t Dog_LoadServoConfig(void)
+{
+    int16_t record[SERVO_NUM * 6];
+    const int16_t *p = record;
+    uint8_t i;
+
+    if(!FlashStore_Load(FLASH_STORE_CALIBRATION, DOG_CONFIG_VERSION, record, sizeof(record))) return 0;
+    for(i = 1; i <= SERVO_NUM; i++) {
+        Dog_AdjustServoConfig(i, p[0] / 100.0f, p[1] / 100.0f, p[2] / 100.0f,
+                              p[3] / 100.0f, p[4] / 100.0f, p[5] / 100.0f);
+        p += 6;
+    }
+    return 1;
+}
+
 void Dog_WalkForward_Smooth(uint8_t steps)
 {
-    uint16_t step_delay = 250 - (WalkSpeed * 20);
+    uint16_t step_delay = 250 - (Dog_EffectiveSpeed() * 20);
+    Dog_BeginAction(MODE_WALK_FORWARD, 0);
     
-    for(uint8_t step = 0; step < steps; step++) {
+    for(uint8_t step = 0; step < steps && !Aborted; step++) {
         // 更平滑的四相位步态
         // 相位1：准备
         Dog_SetAllServos(95, 85, 95, 85);
@@ -320,40 +752,27 @@ void Dog_WalkForward_Smooth(uint8_t steps)
     }
     
     Dog_Stand();
+    Dog_EndAction();
 }
 
+// 下面几个动作的内容是Behavior.c里的字节码
 void Dog_Action_Hello(void)
 {
-    // 抬起右前腿挥手
-    for(int i=0; i<2; i++) {
-        Servo_SetAngle(SERVO_FRONT_RIGHT, 45);  // 抬起
-        Delay_ms(300);
-        Servo_SetAngle(SERVO_FRONT_RIGHT, 90);  // 放下
-        Delay_ms(300);
-    }
-    Dog_Stand();
+    Dog_BeginAction(MODE_HELLO, 0);
+    Behavior_Run(BEHAVIOR_HELLO); // 右前腿挥手两次后站好
+    Dog_EndAction();
 }
 
 void Dog_Action_SitDown(void)
 {
-    // 蹲下动作
-    Dog_SetAllServos(
-        60,   // 前左
-        120,  // 前右  
-        120,  // 后左
-        60    // 后右
-    );
-    Delay_ms(1000);
+    Dog_BeginAction(MODE_SIT_DOWN, 0);
+    Behavior_Run(BEHAVIOR_SIT_DOWN); // 关姿态闭环后蹲下
+    Dog_EndAction();
 }
 
 void Dog_Action_ShakeBody(void)
 {
-    // 抖动身体
-    for(int i=0; i<3; i++) {
-        Dog_SetAllServos(95, 85, 95, 85);
-        Delay_ms(150);
-        Dog_SetAllServos(85, 95, 85, 95);
-        Delay_ms(150);
-    }
-    Dog_Stand();
-}
\ No newline at end of file
+    Dog_BeginAction(MODE_SHAKE_BODY, 0);
+    Behavior_Run(BEHAVIOR_SHAKE_BODY); // 左右抖三次后站好
+    Dog_EndAction();
+}
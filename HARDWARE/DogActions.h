@@ -2,6 +2,8 @@
 #define __DOG_ACTIONS_H
 
 #include "stm32f10x.h"
+#include "Servo.h"
+#include "Trajectory.h"
 
 // 动作模式定义
 typedef enum {
@@ -11,7 +13,11 @@ typedef enum {
     MODE_WALK_BACKWARD,
     MODE_TURN_LEFT,    
     MODE_TURN_RIGHT,   
-    MODE_INIT          
+    MODE_INIT,
+    MODE_HELLO,        // 以下为单次动作，只用作动作事件的来源
+    MODE_SIT_DOWN,
+    MODE_SHAKE_BODY,
+    MODE_KEYFRAMES
 } DogMode;
 
 // 舵机ID定义 
@@ -22,6 +28,48 @@ typedef enum {
     SERVO_REAR_RIGHT = 4    // 舵机4 -> 后右腿
 } ServoID;
 
+// 腿和关节：关节数由舵机通道数决定，4路只有髋关节，8路加膝关节，12路再加侧摆关节
+// 关节j的舵机编号 = 该腿髋关节(ServoID) + 4*j
+#define DOG_LEG_NUM     4
+#define DOG_JOINT_NUM   (SERVO_NUM / DOG_LEG_NUM)
+
+typedef enum {
+    LEG_FRONT_LEFT = 0,     // 与GaitGen的腿顺序一致
+    LEG_FRONT_RIGHT,
+    LEG_REAR_LEFT,
+    LEG_REAR_RIGHT
+} DogLeg;
+
+typedef enum {
+    JOINT_HIP = 0,          // 前后摆，步态的主关节
+    JOINT_KNEE,             // 8路及以上：摆动相弯曲抬腿
+    JOINT_ABAD              // 12路：侧摆，保持站姿
+} DogJoint;
+
+// 航向推算参数（按步数累计，没有陀螺仪，需按实际地面标定）
+#define DOG_TURN_STEP_DEG   15   // 每个转向步大约转过的角度
+#define DOG_WALK_STEP_MM    30   // 每个前进/后退步大约移动的距离
+
+// 姿态切换（站立、坐下等）按最小加加速度曲线过渡，时长按转动最大的腿计算
+#define DOG_POSE_MS_PER_DEG 8    // 每度8ms，20度约160ms
+#define DOG_POSE_MIN_MS     100
+#define DOG_POSE_MAX_MS     800
+
+// 每走完一步调用一次，mode为MODE_WALK_FORWARD/MODE_WALK_BACKWARD/MODE_TURN_LEFT/MODE_TURN_RIGHT
+typedef void (*DogStepCallback)(DogMode mode);
+
+// 关键帧：四条腿的目标角度和保持时间，用于按表播放的动作（例如摔倒后起身）
+// move_ms为0时直接跳到该帧；否则用三次Hermite在move_ms内过渡过去，
+// hold_ms为0且下一帧也有过渡时，该帧是途经点，腿不停顿、速度连续地穿过
+typedef struct {
+    float fl, fr, rl, rr;
+    uint16_t hold_ms;
+    uint16_t move_ms;
+} DogKeyframe;
+
+// 舵机配置在Flash里的记录版本，ServoAngles或存储格式改变时加1，旧记录不再读入
+#define DOG_CONFIG_VERSION  1
+
 // 舵机角度配置结构体
 typedef struct {
     float stand;      // 站立
@@ -46,16 +94,36 @@ void Dog_TestServos(void);
 
 // 高级控制函数
 void Dog_SetWalkSpeed(uint8_t speed);
-void Dog_SetActionCompleteCallback(void (*callback)(void));
+void Dog_SetActionCompleteCallback(void (*callback)(void)); // 动作正常结束时调用；需要开始/进度/中止请订阅EventBus的动作事件
+void Dog_SetStepCallback(DogStepCallback callback);
+int16_t Dog_GetHeading(void);   // 推算航向0~359度，左转为正
+void Dog_ResetHeading(void);
+void Dog_Abort(void);           // 中止当前动作（可在中断中调用），步态循环在当前步结束前退出
+void Dog_ClearAbort(void);
+uint8_t Dog_IsAborted(void);
+uint8_t Dog_PlayKeyframes(const DogKeyframe *frames, uint8_t count); // 返回0表示被中止
 uint8_t Dog_GetWalkSpeed(void);
+uint8_t Dog_GetEffectiveSpeed(void);   // 设定速度与电量上限中较小的一个
+void Dog_ReportStep(DogMode mode);     // 记一步：累计航向并调用步态回调
 void Dog_AdjustServoConfig(uint8_t servo_id, float stand, float sit, 
                           float lift_high, float lift_low, 
                           float push_high, float push_low);
 ServoAngles Dog_GetServoConfig(uint8_t servo_id);
+void Dog_ResetServoConfig(void);       // 恢复出厂配置（不写Flash）
+uint8_t Dog_SaveServoConfig(void);     // 保存到Flash，断电不丢
+uint8_t Dog_LoadServoConfig(void);     // 从Flash读回，返回0表示没有保存过
+uint8_t Dog_GetJointServo(DogLeg leg, DogJoint joint); // 返回舵机编号，0表示没有该关节
 
 // 工具函数
 void Dog_SetAllServos(float fl_angle, float fr_angle, float rl_angle, float rr_angle);
 void Dog_SmoothMove(uint8_t servo_id, float start_angle, float end_angle, uint16_t duration_ms);
+uint8_t Dog_MoveTo(float fl_angle, float fr_angle, float rl_angle, float rr_angle,
+                   uint16_t duration_ms, TrajProfile profile); // 逐帧插值到目标姿态，返回0表示被中止
+void Dog_StartPose(float fl_angle, float fr_angle, float rl_angle, float rr_angle,
+                   uint16_t duration_ms, TrajProfile profile); // 同Dog_MoveTo但不等待
+void Dog_StartStand(void);             // 同Dog_Stand但不等待
+void Dog_StartSit(void);               // 同Dog_Sit但不等待（也没有坐下后的500ms停顿）
+uint8_t Dog_IsMoving(void);            // 还有舵机在插值
 
 void Dog_Action_Hello(void);
 void Dog_Action_SitDown(void);
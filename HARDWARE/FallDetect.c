@@ -0,0 +1,205 @@
+#include "FallDetect.h"
+#include "Servo.h"
+#include "DogActions.h"
+#include "Posture.h"
+#include "MPU6050.h"
+#include "IMU.h"
+#include "Delay.h"
+#include "Bluetooth.h"
+#include "Buzzer.h"
+#include "Format.h"
+
+// 起身关键帧：先收腿成坐姿，再用着地一侧的腿撑起，最后站立
+// 侧躺时着地一侧的腿向外推把身体翻正（角度需按实际机身标定）
+// 收腿和站起用插值过渡，撑地的一帧保持直接设定，让舵机全力推
+static const DogKeyframe getup_right_down[] = {   // 右侧着地
+    { 90,  90,  90,  90, 300,   0},
+    {135,  45, 135,  45, 200, 200},   // 收腿
+    {135, 130, 135, 130, 500,   0},   // 右侧两条腿向外撑
+    { 90,  90,  90,  90, 300, 300}
+};
+static const DogKeyframe getup_left_down[] = {    // 左侧着地
+    { 90,  90,  90,  90, 300,   0},
+    {135,  45, 135,  45, 200, 200},
+    { 50,  45,  50,  45, 500,   0},   // 左侧两条腿向外撑
+    { 90,  90,  90,  90, 300, 300}
+};
+static const DogKeyframe getup_pitch[] = {        // 前扑或后仰
+    {135,  45, 135,  45, 400,   0},
+    {110,  70, 110,  70,   0, 300},   // 途经点，不停顿
+    { 90,  90,  90,  90, 300, 500}
+};
+
+static volatile FallState state = FALL_NONE;
+static uint8_t hooked = 0;
+static uint8_t over_frames = 0;       // 连续超过阈值的帧数
+static uint8_t impact_frames = 0;     // 撞击标记剩余帧数
+static uint32_t onset_us = 0;         // 第一次越过阈值的时刻
+static volatile uint32_t detect_us = 0;
+static volatile uint32_t last_latency = 0;
+static uint32_t max_latency = 0;
+static volatile int32_t fall_pitch = 0, fall_roll = 0;
+static volatile uint32_t fall_peak_mg = 0;
+
+static int32_t Abs32(int32_t v)
+{
+    return (v < 0) ? -v : v;
+}
+
+// 舵机帧回调（TIM3中断）：确认摔倒的同一帧里卸力并中止动作
+static void FallDetect_Frame(void)
+{
+    IMU_Attitude att;
+    uint32_t peak;
+    int32_t tilt;
+    uint8_t over;
+
+    if(state != FALL_NONE) return;
+    IMU_GetAttitude(&att);
+    if(!att.calibrated) return;
+
+    peak = IMU_TakePeakAccel();
+    if(peak > FALL_IMPACT_MG) {
+        impact_frames = FALL_IMPACT_HOLD_FRAMES;
+        if(peak > fall_peak_mg) fall_peak_mg = peak;
+    } else if(impact_frames) {
+        impact_frames--;
+    }
+    if(!impact_frames && !over_frames) fall_peak_mg = 0;
+
+    tilt = Abs32(att.pitch) > Abs32(att.roll) ? Abs32(att.pitch) : Abs32(att.roll);
+    over = tilt > FALL_TILT_MDEG || (impact_frames && tilt > FALL_IMPACT_TILT_MDEG);
+    if(!over) {
+        over_frames = 0;
+        return;
+    }
+    if(over_frames == 0) {
+        onset_us = MPU6050_GetFrameTime(); // 越过阈值的那一帧IMU数据的时刻
+    }
+    if(++over_frames < FALL_CONFIRM_FRAMES) return;
+
+    Servo_SetOutputEnable(0);
+    Dog_Abort();
+    Posture_Enable(0);
+    detect_us = Delay_GetUs();
+    last_latency = detect_us - onset_us;
+    fall_pitch = att.pitch;
+    fall_roll = att.roll;
+    over_frames = 0;
+    state = FALL_DETECTED;
+}
+
+/**
+  * @brief  检测到IMU时启用摔倒检测
+  * @param  无
+  * @retval 无
+  */
+void FallDetect_Init(void)
+{
+    if(!MPU6050_IsPresent()) return;
+    Servo_AddFrameHook(FallDetect_Frame);
+    hooked = 1;
+}
+
+// 通过蓝牙上报 "<label>P<pitch> R<roll> ..."
+static void FallDetect_Report(const char *label)
+{
+    char msg[64];
+    char *p = msg;
+    p += Format_Str(p, label);
+    p += Format_Str(p, " P");
+    p += Format_Int(p, fall_pitch / 1000, 0, ' ');
+    p += Format_Str(p, " R");
+    p += Format_Int(p, fall_roll / 1000, 0, ' ');
+    p += Format_Str(p, " peak ");
+    p += Format_UInt(p, fall_peak_mg, 0, ' ');
+    p += Format_Str(p, "mg lat ");
+    p += Format_UInt(p, last_latency, 0, ' ');
+    p += Format_Str(p, "us max ");
+    p += Format_UInt(p, max_latency, 0, ' ');
+    Format_Str(p, "us\r\n");
+    Bluetooth_SendString(msg);
+}
+
+// 按摔倒方向选择起身关键帧并播放
+static uint8_t FallDetect_GetUp(void)
+{
+    IMU_Attitude att;
+
+    IMU_GetAttitude(&att);
+    Dog_ClearAbort();
+    Servo_SetOutputEnable(1);
+    if(Abs32(att.roll) >= Abs32(att.pitch)) {
+        if(att.roll > 0) Dog_PlayKeyframes(getup_right_down, sizeof(getup_right_down) / sizeof(getup_right_down[0]));
+        else Dog_PlayKeyframes(getup_left_down, sizeof(getup_left_down) / sizeof(getup_left_down[0]));
+    } else {
+        Dog_PlayKeyframes(getup_pitch, sizeof(getup_pitch) / sizeof(getup_pitch[0]));
+    }
+    Delay_ms(300);
+
+    IMU_GetAttitude(&att);
+    return Abs32(att.pitch) < FALL_IMPACT_TILT_MDEG && Abs32(att.roll) < FALL_IMPACT_TILT_MDEG;
+}
+
+/**
+  * @brief  处理摔倒事件：上报、等待停稳、起身，失败则重试
+  * @param  无
+  * @retval 1表示刚处理了一次摔倒（调用者应回到空闲模式）
+  * @detail 起身过程阻塞约2秒/次
+  */
+uint8_t FallDetect_Task(void)
+{
+    uint8_t tries;
+
+    if(!hooked || state != FALL_DETECTED) return 0;
+
+    if(last_latency > max_latency) max_latency = last_latency;
+    FallDetect_Report("FALL:");
+    Buzzer_BeepPattern(BEEP_DOUBLE_BEEP);
+    state = FALL_RECOVERING;
+
+    for(tries = 0; tries < FALL_GETUP_RETRIES; tries++) {
+        Delay_ms(FALL_SETTLE_MS);
+        if(FallDetect_GetUp()) {
+            Dog_Stand(); // 重新启用姿态闭环
+            Bluetooth_SendString("FALL: recovered\r\n");
+            IMU_TakePeakAccel();
+            state = FALL_NONE;
+            return 1;
+        }
+        Servo_SetOutputEnable(0);
+    }
+
+    Bluetooth_SendString("FALL: get-up failed, servos off (K4 to reset)\r\n");
+    state = FALL_GAVE_UP;
+    return 1;
+}
+
+FallState FallDetect_GetState(void)
+{
+    return state;
+}
+
+/**
+  * @brief  放弃起身后，人工扶起再恢复舵机输出
+  * @param  无
+  * @retval 无
+  */
+void FallDetect_Reset(void)
+{
+    if(state != FALL_GAVE_UP) return;
+    Dog_ClearAbort();
+    Servo_SetOutputEnable(1);
+    IMU_TakePeakAccel();
+    state = FALL_NONE;
+}
+
+uint32_t FallDetect_GetLastLatencyUs(void)
+{
+    return last_latency;
+}
+
+uint32_t FallDetect_GetMaxLatencyUs(void)
+{
+    return max_latency;
+}
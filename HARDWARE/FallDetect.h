@@ -0,0 +1,32 @@
+#ifndef __FALL_DETECT_H
+#define __FALL_DETECT_H
+
+#include "stm32f10x.h"
+
+// 摔倒检测：在舵机帧中断(50Hz)里检查姿态，确认摔倒后当帧关闭舵机输出并中止当前动作，
+// 主循环里再上报并按关键帧表起身
+
+#define FALL_TILT_MDEG          60000   // 俯仰或横滚超过60度：摔倒
+#define FALL_IMPACT_TILT_MDEG   35000   // 有撞击时倾斜超过35度即判定
+#define FALL_IMPACT_MG          2500    // 合加速度峰值超过2.5g视为撞击
+#define FALL_IMPACT_HOLD_FRAMES 25      // 撞击标记保持0.5s
+#define FALL_CONFIRM_FRAMES     2       // 连续超过阈值的帧数，检测延迟上限约(FALL_CONFIRM_FRAMES+1)*20ms
+#define FALL_SETTLE_MS          800     // 卸力后等身体停稳再起身
+#define FALL_GETUP_RETRIES      3       // 起身失败后重试次数，全部失败则保持卸力
+
+typedef enum {
+    FALL_NONE = 0,
+    FALL_DETECTED,   // 已卸力，等待主循环处理
+    FALL_RECOVERING, // 正在起身
+    FALL_GAVE_UP     // 起身多次失败，保持卸力，需要人扶起后按K4
+} FallState;
+
+// 函数声明
+void FallDetect_Init(void);            // 有IMU时挂到舵机帧中断上
+uint8_t FallDetect_Task(void);         // 主循环中调用，处理摔倒事件；返回1表示本次调用处理了一次摔倒
+FallState FallDetect_GetState(void);
+void FallDetect_Reset(void);           // 人工扶起后恢复输出（FALL_GAVE_UP时按K4调用）
+uint32_t FallDetect_GetLastLatencyUs(void); // 最近一次：首次越过阈值到卸力的时间
+uint32_t FallDetect_GetMaxLatencyUs(void);
+
+#endif
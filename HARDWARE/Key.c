@@ -1,9 +1,128 @@
 #include "stm32f10x.h"                  // Device header
 #include "Delay.h"
+#include "Key.h"
+
+//按键编号1~4对应的引脚
+static const uint16_t Key_Pins[KEY_NUM] = {GPIO_Pin_7, GPIO_Pin_6, GPIO_Pin_1, GPIO_Pin_0};
+
+typedef struct
+{
+	uint8_t Pressed;		//消抖后的状态
+	uint8_t Debounce;		//原始电平与Pressed不同的持续时间(ms)
+	uint16_t HoldTime;		//按下持续时间(ms)
+	uint16_t LastClick;		//距上次单击松开的时间(ms)，0xFFFF表示很久以前
+	uint8_t LongSent;		//本次按下已产生过长按
+} KeyState;
+
+static KeyState Key_States[KEY_NUM];
+static uint8_t Key_Queue[KEY_QUEUE_SIZE];		//高4位事件类型，低4位按键编号
+static volatile uint8_t Key_Head = 0;			//节拍中断写
+static volatile uint8_t Key_Tail = 0;			//主循环读
+static volatile uint32_t Key_Dropped = 0;
+static uint8_t Key_ScanTimer = 0;
+static uint8_t Key_HookAdded = 0;
+
+/**
+  * @brief  事件入队（只在节拍中断里调用）
+  */
+static void Key_Push(uint8_t Key, KeyEventType Type)
+{
+	uint8_t next = (Key_Head + 1) % KEY_QUEUE_SIZE;
+	if (next == Key_Tail)
+	{
+		Key_Dropped++;
+		return;
+	}
+	Key_Queue[Key_Head] = (Type << 4) | Key;
+	Key_Head = next;
+}
+
+/**
+  * @brief  1ms节拍回调：每KEY_SCAN_MS采样一次，消抖并产生事件
+  */
+static void Key_Tick(void)
+{
+	KeyState *k;
+	uint8_t i, raw;
+
+	if (++Key_ScanTimer < KEY_SCAN_MS)
+	{
+		return;
+	}
+	Key_ScanTimer = 0;
+
+	for (i = 0; i < KEY_NUM; i++)
+	{
+		k = &Key_States[i];
+		raw = (GPIO_ReadInputDataBit(GPIOA, Key_Pins[i]) == 0);	//上拉输入，按下为低电平
+
+		if (k->LastClick < 0xFFFF - KEY_SCAN_MS)
+		{
+			k->LastClick += KEY_SCAN_MS;
+		}
+		else
+		{
+			k->LastClick = 0xFFFF;
+		}
+
+		if (raw != k->Pressed)
+		{
+			k->Debounce += KEY_SCAN_MS;
+			if (k->Debounce >= KEY_DEBOUNCE_MS)
+			{
+				k->Debounce = 0;
+				k->Pressed = raw;
+				if (raw)
+				{
+					k->HoldTime = 0;
+					k->LongSent = 0;
+					Key_Push(i + 1, KEY_EVENT_PRESS);
+				}
+				else
+				{
+					Key_Push(i + 1, KEY_EVENT_RELEASE);
+					if (!k->LongSent)
+					{
+						if (k->LastClick < KEY_DOUBLE_MS)
+						{
+							Key_Push(i + 1, KEY_EVENT_DOUBLE);
+							k->LastClick = 0xFFFF;		//第三次单击重新开始计
+						}
+						else
+						{
+							k->LastClick = 0;
+						}
+					}
+				}
+			}
+		}
+		else
+		{
+			k->Debounce = 0;
+		}
+
+		if (k->Pressed)
+		{
+			k->HoldTime += KEY_SCAN_MS;
+			if (!k->LongSent && k->HoldTime >= KEY_LONG_MS)
+			{
+				k->LongSent = 1;
+				k->HoldTime = 0;
+				Key_Push(i + 1, KEY_EVENT_LONG);
+			}
+			else if (k->LongSent && k->HoldTime >= KEY_REPEAT_MS)
+			{
+				k->HoldTime = 0;
+				Key_Push(i + 1, KEY_EVENT_REPEAT);
+			}
+		}
+	}
+}
 
 void Key_Init(void)
 {
 	GPIO_InitTypeDef GPIO_InitStructure;
+	uint8_t i;
 
 	RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOA, ENABLE);
 	
@@ -11,39 +130,76 @@ void Key_Init(void)
 	GPIO_InitStructure.GPIO_Pin = GPIO_Pin_0 | GPIO_Pin_1 | GPIO_Pin_6 | GPIO_Pin_7;
 	GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
 	GPIO_Init(GPIOA, &GPIO_InitStructure);
-}
 
-uint8_t Key_GetNum(void)
-{
-	uint8_t KeyNum = 0;
-	if (GPIO_ReadInputDataBit(GPIOA, GPIO_Pin_7) == 0)
+	for (i = 0; i < KEY_NUM; i++)
 	{
-		Delay_ms(20);
-		while (GPIO_ReadInputDataBit(GPIOA, GPIO_Pin_7) == 0);
-		Delay_ms(20);
-		KeyNum = 1;
-	}  
-	if (GPIO_ReadInputDataBit(GPIOA, GPIO_Pin_6) == 0)
+		Key_States[i].Pressed = 0;
+		Key_States[i].Debounce = 0;
+		Key_States[i].HoldTime = 0;
+		Key_States[i].LastClick = 0xFFFF;
+		Key_States[i].LongSent = 0;
+	}
+	Key_Head = Key_Tail = 0;
+	if (!Key_HookAdded)			//重复调用Key_Init不重复注册
 	{
-		Delay_ms(20);
-		while (GPIO_ReadInputDataBit(GPIOA, GPIO_Pin_6) == 0);
-		Delay_ms(20);
-		KeyNum = 2;
+		Key_HookAdded = Delay_AddTickHook(Key_Tick);	//需先调用Delay_Init
 	}
-	if (GPIO_ReadInputDataBit(GPIOA, GPIO_Pin_1) == 0)
+}
+
+/**
+  * @brief  取出一个按键事件，不等待
+  * @param  Event 输出
+  * @retval 1取到事件，0队列为空
+  */
+uint8_t Key_GetEvent(KeyEvent *Event)
+{
+	uint8_t e;
+	if (Key_Tail == Key_Head)
 	{
-		Delay_ms(20);
-		while (GPIO_ReadInputDataBit(GPIOA, GPIO_Pin_1) == 0);
-		Delay_ms(20);
-		KeyNum = 3;
+		return 0;
 	}
-	if (GPIO_ReadInputDataBit(GPIOA, GPIO_Pin_0) == 0)
+	e = Key_Queue[Key_Tail];
+	Key_Tail = (Key_Tail + 1) % KEY_QUEUE_SIZE;
+	Event->Key = e & 0x0F;
+	Event->Type = (KeyEventType)(e >> 4);
+	return 1;
+}
+
+/**
+  * @brief  兼容旧接口：返回最近一次按下的按键编号，不等待松开
+  * @param  无
+  * @retval 1~4，没有新的按下时返回0
+  * @detail 会取走队列里的全部事件（松开、长按等一并丢弃），和Key_GetEvent二选一使用
+  */
+uint8_t Key_GetNum(void)
+{
+	KeyEvent Event;
+	uint8_t KeyNum = 0;
+	while (Key_GetEvent(&Event))
 	{
-		Delay_ms(20);
-		while (GPIO_ReadInputDataBit(GPIOA, GPIO_Pin_0) == 0);
-		Delay_ms(20);
-		KeyNum = 4;
+		if (Event.Type == KEY_EVENT_PRESS)
+		{
+			KeyNum = Event.Key;		//不提前退出，后面的按下覆盖前面的
+		}
 	}
-	
 	return KeyNum;
 }
+
+/**
+  * @brief  按键当前是否按下（消抖后）
+  * @param  Key 1~4
+  * @retval 1按下
+  */
+uint8_t Key_IsPressed(uint8_t Key)
+{
+	if (Key < 1 || Key > KEY_NUM)
+	{
+		return 0;
+	}
+	return Key_States[Key - 1].Pressed;
+}
+
+uint32_t Key_GetDropCount(void)
+{
+	return Key_Dropped;
+}
@@ -4,7 +4,34 @@
 #include "stm32f10x.h"                  // Device header
 #include "Delay.h"
 
+#define KEY_NUM				4
+#define KEY_SCAN_MS			5		//采样周期，在1ms节拍里每5ms读一次引脚
+#define KEY_DEBOUNCE_MS		20		//电平稳定这么久才算按下/松开
+#define KEY_LONG_MS			800		//按住超过这个时间产生长按事件
+#define KEY_REPEAT_MS		200		//长按之后每隔这么久产生一次连发事件
+#define KEY_DOUBLE_MS		300		//两次单击间隔小于这个时间产生双击事件
+#define KEY_QUEUE_SIZE		8		//事件队列长度，满了丢弃最新的事件
+
+typedef enum
+{
+	KEY_EVENT_NONE = 0,
+	KEY_EVENT_PRESS,		//按下（消抖后立即产生）
+	KEY_EVENT_RELEASE,		//松开
+	KEY_EVENT_LONG,			//长按
+	KEY_EVENT_REPEAT,		//长按后的连发
+	KEY_EVENT_DOUBLE		//双击（第二次松开时产生）
+} KeyEventType;
+
+typedef struct
+{
+	uint8_t Key;			//1~4，与Key_GetNum的编号一致
+	KeyEventType Type;
+} KeyEvent;
+
 void Key_Init(void);
 uint8_t Key_GetNum(void);
+uint8_t Key_GetEvent(KeyEvent *Event);
+uint8_t Key_IsPressed(uint8_t Key);
+uint32_t Key_GetDropCount(void);
 
 #endif
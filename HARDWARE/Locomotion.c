@@ -0,0 +1,308 @@
+#include "Locomotion.h"
+#include "DogActions.h"
+#include "Servo.h"
+#include "PWM.h"
+#include "Delay.h"
+#include "PowerGovernor.h"
+#include "Posture.h"
+#include "EventBus.h"
+
+static GaitGen gait;
+static GaitParams base;                           // 用户设定的摆幅、支撑相比例等，只在主循环里修改
+static volatile uint8_t base_changed = 0;
+static volatile uint8_t running = 0;
+static volatile LocoCommand pending = LOCO_STOP;  // 要执行的命令，摆幅/转向朝它逐帧过渡
+static volatile uint8_t steps_left = 0;           // 0表示不限步数
+static LocoCommand command = LOCO_STOP;           // 最近一个运动命令，走完的步记在它名下
+static uint8_t hip_ids[GAIT_LEGS];
+static float stand[GAIT_LEGS];
+static int8_t forward_sign[GAIT_LEGS];            // 舵机角度增大时腿是否向前摆
+#if DOG_JOINT_NUM >= 2
+static uint8_t knee_ids[GAIT_LEGS];
+static float knee_stand[GAIT_LEGS];
+static float knee_lift[GAIT_LEGS];                // 摆动相最高点相对站姿的弯曲角度
+#endif
+
+static volatile uint16_t steps_done[5];           // 按LocoCommand计数，帧中断里累加
+static uint16_t steps_reported[5];                // 已经补报给DogActions的步数
+static uint32_t step_total = 0;
+
+// 起步和停止在Locomotion_Run/帧中断里记下，由Locomotion_Task发布；两次轮询之间停了又起步也不会漏报
+static volatile uint8_t start_flag = 0;
+static volatile LocoCommand start_cmd = LOCO_STOP;
+static volatile uint8_t stop_flag = 0;            // 1停止（走完或收步），2被中止
+static volatile LocoCommand stop_cmd = LOCO_STOP; // 停止时实际在走的命令
+static volatile uint16_t stop_steps = 0;
+static volatile uint16_t run_steps = 0;           // 本次运行走完的步数，帧中断里累加
+
+static const DogMode command_modes[5] = {MODE_STAND, MODE_WALK_FORWARD, MODE_WALK_BACKWARD, MODE_TURN_LEFT, MODE_TURN_RIGHT};
+
+// 帧中断里停止：记下停止时的命令和步数
+static void Locomotion_Stopped(uint8_t aborted)
+{
+    running = 0;
+    stop_flag = aborted ? 2 : 1;
+    stop_cmd = command;
+    stop_steps = run_steps;
+}
+
+static int16_t Locomotion_Approach(int16_t value, int16_t target, int16_t step)
+{
+    if(value < target - step) return value + step;
+    if(value > target + step) return value - step;
+    return target;
+}
+
+// 站姿角度和各腿方向取自DogActions的舵机配置（推地高位在站姿哪一侧），标定后自动生效
+static void Locomotion_LoadConfig(void)
+{
+    ServoAngles cfg;
+    uint8_t i;
+    for(i = 0; i < GAIT_LEGS; i++) {
+        hip_ids[i] = Dog_GetJointServo((DogLeg)i, JOINT_HIP);
+        cfg = Dog_GetServoConfig(hip_ids[i]);
+        stand[i] = cfg.stand;
+        forward_sign[i] = (cfg.push_high >= cfg.stand) ? 1 : -1;
+#if DOG_JOINT_NUM >= 2
+        knee_ids[i] = Dog_GetJointServo((DogLeg)i, JOINT_KNEE);
+        cfg = Dog_GetServoConfig(knee_ids[i]);
+        knee_stand[i] = cfg.stand;
+        knee_lift[i] = cfg.lift_high - cfg.stand;
+#endif
+    }
+}
+
+// 把步态输出写到各腿的关节，lift为0时膝关节回到站姿
+static void Locomotion_Output(const int16_t *out, const int16_t *lift)
+{
+    uint8_t i;
+#if DOG_JOINT_NUM < 2
+    (void)lift; // 只有髋关节（4路PWM）时没有膝关节可抬
+#endif
+    for(i = 0; i < GAIT_LEGS; i++) {
+        Servo_SetCommand(hip_ids[i], stand[i] + forward_sign[i] * out[i] / 100.0f);
+#if DOG_JOINT_NUM >= 2
+        Servo_SetCommand(knee_ids[i], knee_stand[i] + knee_lift[i] * (lift ? lift[i] : 0) / 32768.0f);
+#endif
+    }
+}
+
+// 按命令和速度档位算步频、摆幅和转向的目标值（每帧重新读取，调速立即生效）
+static void Locomotion_Targets(LocoCommand cmd, uint16_t *freq, int16_t *amp, int16_t *turn)
+{
+    uint8_t speed = Dog_GetEffectiveSpeed();
+    uint16_t stagger = PowerGovernor_GetLimits()->stagger_ms;
+    uint32_t period;
+
+    *amp = base.amplitude;
+    *turn = 0;
+    if(cmd == LOCO_TURN_LEFT || cmd == LOCO_TURN_RIGHT) {
+        period = 2 * (300 - speed * 20);                    // 与阻塞版转向的一步时长相同
+        *turn = (cmd == LOCO_TURN_LEFT) ? 1000 : -1000;
+    } else {
+        period = 2 * (200 - speed * 15) + 12 * stagger;     // 与阻塞版行走的一步时长相同，电量低时放慢
+        if(cmd == LOCO_BACKWARD) *amp = -*amp;
+        if(cmd == LOCO_STOP) *amp = 0;
+    }
+    *freq = (uint16_t)(1000000UL / period);
+}
+
+// 舵机帧回调（中断上下文）
+static void Locomotion_Frame(void)
+{
+    int16_t out[GAIT_LEGS], lift[GAIT_LEGS];
+    int32_t scale;
+    int16_t amp, turn;
+    uint16_t freq;
+    LocoCommand cmd;
+    uint8_t i;
+
+    if(!running) return;
+    if(Dog_IsAborted()) {
+        // 摔倒等紧急中止：立即停止，不再摆站姿
+        Locomotion_Stopped(1);
+        pending = LOCO_STOP;
+        return;
+    }
+
+    if(base_changed) {
+        gait.p.duty = base.duty;
+        for(i = 0; i < GAIT_LEGS; i++) gait.p.offset[i] = base.offset[i];
+        gait.p.profile = base.profile;
+        base_changed = 0;
+    }
+
+    cmd = pending;
+    if(cmd != LOCO_STOP) command = cmd;
+    Locomotion_Targets(cmd, &freq, &amp, &turn);
+    if(cmd == LOCO_STOP) turn = 0;
+    gait.p.freq_mhz = freq;
+    gait.p.amplitude = Locomotion_Approach(gait.p.amplitude, amp, LOCO_AMP_BLEND);
+    gait.p.turn = Locomotion_Approach(gait.p.turn, turn, LOCO_TURN_BLEND);
+
+    if(cmd == LOCO_STOP && gait.p.amplitude == 0 && gait.p.turn == 0) {
+        for(i = 0; i < GAIT_LEGS; i++) out[i] = 0;
+        Locomotion_Output(out, 0);
+        Locomotion_Stopped(0); // 摆幅已收到零，腿在站姿
+        return;
+    }
+
+    if(GaitGen_Advance(&gait, 1000 / PWM_FRAME_HZ) && command != LOCO_STOP) {
+        steps_done[command]++;
+        if(run_steps != 0xFFFF) run_steps++;
+        if(steps_left && --steps_left == 0) pending = LOCO_STOP;
+    }
+
+    GaitGen_Eval(&gait, out, lift);
+    // 抬腿高度跟着摆幅一起渐变，起步和停止时膝关节也是平滑的
+    scale = (gait.p.amplitude < 0) ? -gait.p.amplitude : gait.p.amplitude;
+    if(scale > base.amplitude) scale = base.amplitude;
+    for(i = 0; i < GAIT_LEGS; i++) {
+        lift[i] = base.amplitude ? (int16_t)((int32_t)lift[i] * scale / base.amplitude) : 0;
+    }
+    Locomotion_Output(out, lift);
+}
+
+/**
+  * @brief  挂到舵机帧中断上
+  * @param  无
+  * @retval 无
+  */
+void Locomotion_Init(void)
+{
+    GaitGen_DefaultParams(&base);
+    GaitGen_Init(&gait, &base);
+    gait.p.amplitude = 0;
+    Servo_AddFrameHook(Locomotion_Frame);
+}
+
+/**
+  * @brief  开始或改变连续步态
+  * @param  cmd: 步态，LOCO_STOP等同于Locomotion_Stop
+  * @param  steps: 走这么多步后自动停止，0表示一直走
+  * @retval 无
+  * @detail 正在走时相位不中断，摆幅和转向偏置逐帧过渡到新命令，不回到站姿
+  */
+void Locomotion_Run(LocoCommand cmd, uint8_t steps)
+{
+    if(cmd != LOCO_STOP) Posture_Enable(1);
+
+    __disable_irq();
+    pending = cmd;
+    steps_left = steps;
+    if(!running && cmd != LOCO_STOP) {
+        Locomotion_LoadConfig();
+        gait.p.amplitude = 0; // 从站姿起步，摆幅从零开始增大
+        gait.p.turn = 0;
+        gait.phase = 0;
+        command = cmd;
+        run_steps = 0;
+        start_cmd = cmd;
+        start_flag = 1;
+        running = 1;
+    }
+    __enable_irq();
+}
+
+void Locomotion_Stop(void)
+{
+    __disable_irq();
+    pending = LOCO_STOP;
+    steps_left = 0;
+    __enable_irq();
+}
+
+uint8_t Locomotion_IsRunning(void)
+{
+    return running;
+}
+
+/**
+  * @brief  等待停止（站姿保持结束）
+  * @param  timeout_ms: 最长等待时间
+  * @retval 1已停止，0超时
+  */
+uint8_t Locomotion_WaitStopped(uint32_t timeout_ms)
+{
+    uint32_t start = Delay_GetTick();
+    while(running) {
+        if(Delay_GetTick() - start >= timeout_ms) return 0;
+        Delay_ms(1000 / PWM_FRAME_HZ);
+    }
+    return 1;
+}
+
+LocoCommand Locomotion_GetCommand(void)
+{
+    return running ? pending : LOCO_STOP;
+}
+
+/**
+  * @brief  主循环中调用：把帧中断里走完的步数补报给DogActions，发布动作开始/结束事件
+  * @param  无
+  * @retval 无
+  * @detail 航向累计和避障地图采样比较耗时，不放在中断里
+  */
+void Locomotion_Task(void)
+{
+    uint8_t c, started, stopped, restarted;
+    uint16_t done, steps;
+    LocoCommand start_at, stop_at;
+
+    __disable_irq();
+    started = start_flag;
+    start_at = start_cmd;
+    start_flag = 0;
+    stopped = stop_flag;
+    stop_at = stop_cmd;
+    steps = stop_steps;
+    stop_flag = 0;
+    restarted = started && stopped && running; // 都发生过且仍在走：先停止后起步
+    __enable_irq();
+
+    if(started && !restarted) {
+        EventBus_Publish(EVENT_ACTION_START, command_modes[start_at], 0);
+    }
+
+    for(c = LOCO_FORWARD; c <= LOCO_TURN_RIGHT; c++) {
+        done = steps_done[c];
+        while(steps_reported[c] != done) {
+            steps_reported[c]++;
+            step_total++;
+            Dog_ReportStep(command_modes[c]);
+        }
+    }
+
+    if(stopped) {
+        EventBus_Publish(stopped == 2 ? EVENT_ACTION_CANCEL : EVENT_ACTION_COMPLETE, command_modes[stop_at], steps);
+    }
+    if(restarted) {
+        EventBus_Publish(EVENT_ACTION_START, command_modes[start_at], 0);
+    }
+}
+
+uint32_t Locomotion_GetStepCount(void)
+{
+    return step_total;
+}
+
+/**
+  * @brief  运行时调整步态参数
+  * @param  params: 使用其中的amplitude（取绝对值）、duty、offset、profile；
+  *                 freq_mhz和turn由命令与速度档位决定
+  * @retval 无
+  * @detail 摆幅逐帧过渡，支撑相比例、相位差和曲线在下一帧生效
+  */
+void Locomotion_SetGait(const GaitParams *params)
+{
+    __disable_irq();
+    base = *params;
+    if(base.amplitude < 0) base.amplitude = -base.amplitude;
+    base_changed = 1;
+    __enable_irq();
+}
+
+void Locomotion_GetGait(GaitParams *params)
+{
+    *params = base;
+}
@@ -0,0 +1,34 @@
+#ifndef __LOCOMOTION_H
+#define __LOCOMOTION_H
+
+#include "stm32f10x.h"
+#include "GaitGen.h"
+
+// 连续步态：在舵机帧中断(50Hz)里推进参数化步态(GaitGen)，步与步之间不回到站姿。
+// 步频随速度档位立即变化（相位连续）；方向和转向通过摆幅/转向偏置逐帧过渡，
+// 停止时摆幅渐变到零，四条腿自然收回站姿
+
+#define LOCO_AMP_BLEND      200   // 摆幅每帧最多变化2度
+#define LOCO_TURN_BLEND     100   // 转向偏置每帧最多变化10%
+
+typedef enum {
+    LOCO_STOP = 0,
+    LOCO_FORWARD,
+    LOCO_BACKWARD,
+    LOCO_TURN_LEFT,
+    LOCO_TURN_RIGHT
+} LocoCommand;
+
+// 函数声明
+void Locomotion_Init(void);                         // 挂到舵机帧中断上（需先调用Servo_Init）
+void Locomotion_Run(LocoCommand cmd, uint8_t steps); // steps为0表示一直走，直到新的命令或Locomotion_Stop
+void Locomotion_Stop(void);                         // 摆幅渐变到零，回到站姿后停止
+uint8_t Locomotion_IsRunning(void);
+uint8_t Locomotion_WaitStopped(uint32_t timeout_ms); // 阻塞等待停止，返回0表示超时
+LocoCommand Locomotion_GetCommand(void);
+void Locomotion_Task(void);                         // 主循环中调用：补报走完的步数（航向、避障地图）和动作事件
+uint32_t Locomotion_GetStepCount(void);
+void Locomotion_SetGait(const GaitParams *params);   // 运行时调整摆幅、支撑相比例、相位差和摆动曲线
+void Locomotion_GetGait(GaitParams *params);        // 步频和转向由命令决定，这里的值不起作用
+
+#endif
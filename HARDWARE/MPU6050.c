@@ -0,0 +1,356 @@
+#include "MPU6050.h"
+#include "IMU.h"
+#include "Delay.h"
+#include "stm32f10x_i2c.h"
+#include "stm32f10x_dma.h"
+#include "stm32f10x_exti.h"
+
+// 寄存器
+#define REG_SMPLRT_DIV    0x19
+#define REG_CONFIG        0x1A
+#define REG_GYRO_CONFIG   0x1B
+#define REG_ACCEL_CONFIG  0x1C
+#define REG_INT_PIN_CFG   0x37
+#define REG_INT_ENABLE    0x38
+#define REG_ACCEL_XOUT_H  0x3B
+#define REG_PWR_MGMT_1    0x6B
+#define REG_WHO_AM_I      0x75
+
+#define MPU6050_FRAME_LEN   14      // 加速度6 + 温度2 + 陀螺仪6
+#define MPU6050_TIMEOUT     10000   // 阻塞读写时等待事件的循环次数
+
+// 中断驱动的读取流程：数据就绪 -> START -> 写寄存器地址 -> 重复START -> DMA收14字节 -> STOP
+typedef enum {
+    READ_IDLE = 0,
+    READ_START_W,
+    READ_ADDR_W,
+    READ_REG,
+    READ_START_R,
+    READ_ADDR_R,
+    READ_DMA
+} ReadState;
+
+static volatile ReadState read_state = READ_IDLE;
+static uint8_t dma_buffer[MPU6050_FRAME_LEN];
+static volatile MPU6050_Raw latest;
+static volatile uint8_t fresh = 0;
+static volatile uint32_t frame_count = 0;
+static volatile uint32_t error_count = 0;
+static volatile uint32_t frame_time = 0;
+static uint8_t present = 0;
+
+// 等待I2C事件，超时返回0
+static uint8_t MPU6050_WaitEvent(uint32_t event)
+{
+    uint32_t timeout = MPU6050_TIMEOUT;
+    while(!I2C_CheckEvent(MPU6050_I2C, event)) {
+        if(--timeout == 0) return 0;
+    }
+    return 1;
+}
+
+// 阻塞写一个寄存器（只在初始化时用）
+static uint8_t MPU6050_WriteReg(uint8_t reg, uint8_t value)
+{
+    uint8_t ok;
+    I2C_GenerateSTART(MPU6050_I2C, ENABLE);
+    ok = MPU6050_WaitEvent(I2C_EVENT_MASTER_MODE_SELECT);
+    if(ok) {
+        I2C_Send7bitAddress(MPU6050_I2C, MPU6050_ADDR, I2C_Direction_Transmitter);
+        ok = MPU6050_WaitEvent(I2C_EVENT_MASTER_TRANSMITTER_MODE_SELECTED);
+    }
+    if(ok) {
+        I2C_SendData(MPU6050_I2C, reg);
+        ok = MPU6050_WaitEvent(I2C_EVENT_MASTER_BYTE_TRANSMITTING);
+    }
+    if(ok) {
+        I2C_SendData(MPU6050_I2C, value);
+        ok = MPU6050_WaitEvent(I2C_EVENT_MASTER_BYTE_TRANSMITTED);
+    }
+    I2C_GenerateSTOP(MPU6050_I2C, ENABLE);
+    return ok;
+}
+
+// 阻塞读一个寄存器（只在初始化时用），失败返回0xFF
+static uint8_t MPU6050_ReadReg(uint8_t reg)
+{
+    uint8_t value = 0xFF;
+    I2C_GenerateSTART(MPU6050_I2C, ENABLE);
+    if(!MPU6050_WaitEvent(I2C_EVENT_MASTER_MODE_SELECT)) goto stop;
+    I2C_Send7bitAddress(MPU6050_I2C, MPU6050_ADDR, I2C_Direction_Transmitter);
+    if(!MPU6050_WaitEvent(I2C_EVENT_MASTER_TRANSMITTER_MODE_SELECTED)) goto stop;
+    I2C_SendData(MPU6050_I2C, reg);
+    if(!MPU6050_WaitEvent(I2C_EVENT_MASTER_BYTE_TRANSMITTED)) goto stop;
+    I2C_GenerateSTART(MPU6050_I2C, ENABLE);
+    if(!MPU6050_WaitEvent(I2C_EVENT_MASTER_MODE_SELECT)) goto stop;
+    I2C_Send7bitAddress(MPU6050_I2C, MPU6050_ADDR, I2C_Direction_Receiver);
+    if(!MPU6050_WaitEvent(I2C_EVENT_MASTER_RECEIVER_MODE_SELECTED)) goto stop;
+    I2C_AcknowledgeConfig(MPU6050_I2C, DISABLE); // 单字节读：收之前就准备NACK
+    I2C_GenerateSTOP(MPU6050_I2C, ENABLE);
+    if(MPU6050_WaitEvent(I2C_EVENT_MASTER_BYTE_RECEIVED)) {
+        value = I2C_ReceiveData(MPU6050_I2C);
+    }
+    I2C_AcknowledgeConfig(MPU6050_I2C, ENABLE);
+    return value;
+stop:
+    I2C_GenerateSTOP(MPU6050_I2C, ENABLE);
+    return value;
+}
+
+// 大端字节 -> 坐标系转换（模块x向前、y向左、z向上安装时不用改）
+static void MPU6050_Parse(void)
+{
+    uint8_t i;
+    for(i = 0; i < 3; i++) {
+        latest.accel[i] = (int16_t)((dma_buffer[i * 2] << 8) | dma_buffer[i * 2 + 1]);
+        latest.gyro[i] = (int16_t)((dma_buffer[8 + i * 2] << 8) | dma_buffer[8 + i * 2 + 1]);
+    }
+    latest.temp = (int16_t)((dma_buffer[6] << 8) | dma_buffer[7]);
+}
+
+// 放弃当前这次读取，回到空闲
+static void MPU6050_Abort(void)
+{
+    I2C_ITConfig(MPU6050_I2C, I2C_IT_EVT, DISABLE);
+    I2C_DMACmd(MPU6050_I2C, DISABLE);
+    DMA_Cmd(DMA1_Channel5, DISABLE);
+    I2C_GenerateSTOP(MPU6050_I2C, ENABLE);
+    read_state = READ_IDLE;
+    error_count++;
+}
+
+/**
+  * @brief  初始化MPU6050：I2C2、DMA1通道5、INT引脚外部中断
+  * @param  无
+  * @retval 1表示检测到MPU6050并已启动200Hz读取，0表示没有接或通信失败
+  */
+uint8_t MPU6050_Init(void)
+{
+    GPIO_InitTypeDef GPIO_InitStructure;
+    I2C_InitTypeDef I2C_InitStructure;
+    DMA_InitTypeDef DMA_InitStructure;
+    EXTI_InitTypeDef EXTI_InitStructure;
+    NVIC_InitTypeDef NVIC_InitStructure;
+    uint8_t ok;
+
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOB | RCC_APB2Periph_AFIO, ENABLE);
+    RCC_APB1PeriphClockCmd(RCC_APB1Periph_I2C2, ENABLE);
+    RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
+
+    GPIO_InitStructure.GPIO_Pin = GPIO_Pin_10 | GPIO_Pin_11;
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_AF_OD;
+    GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
+    GPIO_Init(GPIOB, &GPIO_InitStructure);
+
+    GPIO_InitStructure.GPIO_Pin = GPIO_Pin_12;
+    GPIO_InitStructure.GPIO_Mode = GPIO_Mode_IPD; // INT默认推挽高有效
+    GPIO_Init(GPIOB, &GPIO_InitStructure);
+
+    I2C_DeInit(MPU6050_I2C);
+    I2C_InitStructure.I2C_Mode = I2C_Mode_I2C;
+    I2C_InitStructure.I2C_DutyCycle = I2C_DutyCycle_2;
+    I2C_InitStructure.I2C_OwnAddress1 = 0x00;
+    I2C_InitStructure.I2C_Ack = I2C_Ack_Enable;
+    I2C_InitStructure.I2C_AcknowledgedAddress = I2C_AcknowledgedAddress_7bit;
+    I2C_InitStructure.I2C_ClockSpeed = MPU6050_I2C_SPEED;
+    I2C_Init(MPU6050_I2C, &I2C_InitStructure);
+    I2C_Cmd(MPU6050_I2C, ENABLE);
+
+    present = (MPU6050_ReadReg(REG_WHO_AM_I) == 0x68);
+    if(!present) {
+        I2C_Cmd(MPU6050_I2C, DISABLE);
+        return 0;
+    }
+
+    ok = MPU6050_WriteReg(REG_PWR_MGMT_1, 0x01);                        // 退出睡眠，时钟用陀螺仪X轴PLL
+    ok &= MPU6050_WriteReg(REG_CONFIG, 0x03);                           // 低通44Hz，陀螺仪输出1kHz
+    ok &= MPU6050_WriteReg(REG_SMPLRT_DIV, 1000 / MPU6050_SAMPLE_HZ - 1); // 1kHz/(1+4) = 200Hz
+    ok &= MPU6050_WriteReg(REG_GYRO_CONFIG, 0x08);                      // ±500dps，与IMU_GYRO_LSB_PER_DPS_X10一致
+    ok &= MPU6050_WriteReg(REG_ACCEL_CONFIG, 0x08);                     // ±4g，与IMU_ACCEL_LSB_PER_G一致
+    ok &= MPU6050_WriteReg(REG_INT_PIN_CFG, 0x10);                      // 任意读操作清除中断标志
+    ok &= MPU6050_WriteReg(REG_INT_ENABLE, 0x01);                       // 数据就绪中断
+    if(!ok) {
+        present = 0;
+        return 0;
+    }
+
+    // DMA1通道5 = I2C2_RX
+    DMA_DeInit(DMA1_Channel5);
+    DMA_InitStructure.DMA_PeripheralBaseAddr = (uint32_t)&MPU6050_I2C->DR;
+    DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t)dma_buffer;
+    DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralSRC;
+    DMA_InitStructure.DMA_BufferSize = MPU6050_FRAME_LEN;
+    DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
+    DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
+    DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_Byte;
+    DMA_InitStructure.DMA_MemoryDataSize = DMA_MemoryDataSize_Byte;
+    DMA_InitStructure.DMA_Mode = DMA_Mode_Normal;
+    DMA_InitStructure.DMA_Priority = DMA_Priority_VeryHigh;
+    DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
+    DMA_Init(DMA1_Channel5, &DMA_InitStructure);
+    DMA_ITConfig(DMA1_Channel5, DMA_IT_TC, ENABLE);
+
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 1; // 高于舵机帧，I2C事件不被帧处理拖住
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_InitStructure.NVIC_IRQChannel = DMA1_Channel5_IRQn;
+    NVIC_Init(&NVIC_InitStructure);
+    NVIC_InitStructure.NVIC_IRQChannel = I2C2_EV_IRQn;
+    NVIC_Init(&NVIC_InitStructure);
+    NVIC_InitStructure.NVIC_IRQChannel = I2C2_ER_IRQn;
+    NVIC_Init(&NVIC_InitStructure);
+    NVIC_InitStructure.NVIC_IRQChannel = MPU6050_INT_IRQn;
+    NVIC_Init(&NVIC_InitStructure);
+    I2C_ITConfig(MPU6050_I2C, I2C_IT_ERR, ENABLE);
+
+    IMU_Init(MPU6050_SAMPLE_HZ);
+
+    GPIO_EXTILineConfig(MPU6050_INT_PORT_SOURCE, MPU6050_INT_PIN_SOURCE);
+    EXTI_InitStructure.EXTI_Line = MPU6050_INT_LINE;
+    EXTI_InitStructure.EXTI_Mode = EXTI_Mode_Interrupt;
+    EXTI_InitStructure.EXTI_Trigger = EXTI_Trigger_Rising;
+    EXTI_InitStructure.EXTI_LineCmd = ENABLE;
+    EXTI_Init(&EXTI_InitStructure);
+
+    MPU6050_ReadReg(REG_ACCEL_XOUT_H); // 清掉初始化期间可能已置位的中断，保证下一次有上升沿
+    return 1;
+}
+
+uint8_t MPU6050_IsPresent(void)
+{
+    return present;
+}
+
+/**
+  * @brief  读取最新一帧原始数据
+  * @param  raw: 输出
+  * @retval 1表示自上次读取以来有新数据
+  */
+uint8_t MPU6050_GetRaw(MPU6050_Raw *raw)
+{
+    uint8_t i, was_fresh;
+    __disable_irq();
+    for(i = 0; i < 3; i++) {
+        raw->accel[i] = latest.accel[i];
+        raw->gyro[i] = latest.gyro[i];
+    }
+    raw->temp = latest.temp;
+    was_fresh = fresh;
+    fresh = 0;
+    __enable_irq();
+    return was_fresh;
+}
+
+uint32_t MPU6050_GetFrameCount(void)
+{
+    return frame_count;
+}
+
+uint32_t MPU6050_GetErrorCount(void)
+{
+    return error_count;
+}
+
+uint32_t MPU6050_GetFrameTime(void)
+{
+    return frame_time;
+}
+
+/**
+  * @brief  数据就绪中断（PB12），启动一次异步读取
+  */
+void EXTI15_10_IRQHandler(void)
+{
+    if(EXTI_GetITStatus(MPU6050_INT_LINE) != RESET) {
+        EXTI_ClearITPendingBit(MPU6050_INT_LINE);
+        if(read_state != READ_IDLE) {
+            error_count++; // 上一帧还没读完，丢掉这一帧
+            return;
+        }
+        read_state = READ_START_W;
+        I2C_ITConfig(MPU6050_I2C, I2C_IT_EVT, ENABLE);
+        I2C_GenerateSTART(MPU6050_I2C, ENABLE);
+    }
+}
+
+/**
+  * @brief  I2C2事件中断：推进地址/寄存器阶段，数据阶段交给DMA
+  */
+void I2C2_EV_IRQHandler(void)
+{
+    switch(read_state) {
+        case READ_START_W:
+            if(I2C_CheckEvent(MPU6050_I2C, I2C_EVENT_MASTER_MODE_SELECT)) {
+                I2C_Send7bitAddress(MPU6050_I2C, MPU6050_ADDR, I2C_Direction_Transmitter);
+                read_state = READ_ADDR_W;
+            }
+            break;
+
+        case READ_ADDR_W:
+            if(I2C_CheckEvent(MPU6050_I2C, I2C_EVENT_MASTER_TRANSMITTER_MODE_SELECTED)) {
+                I2C_SendData(MPU6050_I2C, REG_ACCEL_XOUT_H);
+                read_state = READ_REG;
+            }
+            break;
+
+        case READ_REG:
+            if(I2C_CheckEvent(MPU6050_I2C, I2C_EVENT_MASTER_BYTE_TRANSMITTED)) {
+                I2C_GenerateSTART(MPU6050_I2C, ENABLE);
+                read_state = READ_START_R;
+            }
+            break;
+
+        case READ_START_R:
+            if(I2C_CheckEvent(MPU6050_I2C, I2C_EVENT_MASTER_MODE_SELECT)) {
+                // 清ADDR之前准备好DMA，最后一个字节自动NACK
+                DMA_Cmd(DMA1_Channel5, DISABLE);
+                DMA_SetCurrDataCounter(DMA1_Channel5, MPU6050_FRAME_LEN);
+                DMA_Cmd(DMA1_Channel5, ENABLE);
+                I2C_DMALastTransferCmd(MPU6050_I2C, ENABLE);
+                I2C_DMACmd(MPU6050_I2C, ENABLE);
+                I2C_Send7bitAddress(MPU6050_I2C, MPU6050_ADDR, I2C_Direction_Receiver);
+                read_state = READ_ADDR_R;
+            }
+            break;
+
+        case READ_ADDR_R:
+            if(I2C_CheckEvent(MPU6050_I2C, I2C_EVENT_MASTER_RECEIVER_MODE_SELECTED)) {
+                I2C_ITConfig(MPU6050_I2C, I2C_IT_EVT, DISABLE);
+                read_state = READ_DMA;
+            }
+            break;
+
+        default:
+            I2C_ITConfig(MPU6050_I2C, I2C_IT_EVT, DISABLE);
+            break;
+    }
+}
+
+/**
+  * @brief  I2C2错误中断：无应答、总线错误等，放弃这一帧
+  */
+void I2C2_ER_IRQHandler(void)
+{
+    I2C_ClearITPendingBit(MPU6050_I2C, I2C_IT_AF | I2C_IT_BERR | I2C_IT_ARLO | I2C_IT_OVR);
+    MPU6050_Abort();
+}
+
+/**
+  * @brief  DMA接收完成：结束传输，解析并更新姿态
+  */
+void DMA1_Channel5_IRQHandler(void)
+{
+    if(DMA_GetITStatus(DMA1_IT_TC5) != RESET) {
+        DMA_ClearITPendingBit(DMA1_IT_TC5);
+        I2C_GenerateSTOP(MPU6050_I2C, ENABLE);
+        I2C_DMACmd(MPU6050_I2C, DISABLE);
+        DMA_Cmd(DMA1_Channel5, DISABLE);
+        read_state = READ_IDLE;
+
+        MPU6050_Parse();
+        fresh = 1;
+        frame_count++;
+        frame_time = Delay_GetUs();
+        IMU_Update((const int16_t *)latest.accel, (const int16_t *)latest.gyro);
+    }
+}
@@ -0,0 +1,32 @@
+#ifndef __MPU6050_H
+#define __MPU6050_H
+
+#include "stm32f10x.h"
+
+// 硬件I2C2：PB10=SCL，PB11=SDA；数据就绪中断INT接PB12
+#define MPU6050_I2C               I2C2
+#define MPU6050_I2C_SPEED         400000
+#define MPU6050_ADDR              0xD0      // AD0接地，7位地址0x68左移一位
+#define MPU6050_SAMPLE_HZ         200
+
+#define MPU6050_INT_PORT_SOURCE   GPIO_PortSourceGPIOB
+#define MPU6050_INT_PIN_SOURCE    GPIO_PinSource12
+#define MPU6050_INT_LINE          EXTI_Line12
+#define MPU6050_INT_IRQn          EXTI15_10_IRQn
+
+// 一帧原始数据（已转换为x向前、y向左、z向上，模块安装方向不同时改MPU6050_Parse）
+typedef struct {
+    int16_t accel[3];
+    int16_t temp;
+    int16_t gyro[3];
+} MPU6050_Raw;
+
+// 函数声明
+uint8_t MPU6050_Init(void);                 // 配置传感器并启动中断+DMA读取，返回1表示检测到MPU6050
+uint8_t MPU6050_IsPresent(void);
+uint8_t MPU6050_GetRaw(MPU6050_Raw *raw);   // 读取最新一帧，返回1表示自上次读取后有新数据
+uint32_t MPU6050_GetFrameCount(void);       // 已读取的帧数
+uint32_t MPU6050_GetErrorCount(void);       // I2C错误和丢帧次数
+uint32_t MPU6050_GetFrameTime(void);        // 最近一帧读完的时刻，Delay_GetUs()的微秒数
+
+#endif
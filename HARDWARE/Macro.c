@@ -0,0 +1,131 @@
+#include "Macro.h"
+#include "ControlSystem.h"
+#include "Delay.h"
+#include "FlashStore.h"
+#include <stddef.h>
+
+#define MACRO_VERSION   1   // MacroStep或记录格式改变时加1
+
+// Flash记录：步数 + 全部步骤，长度固定
+typedef struct {
+    uint8_t count;
+    uint8_t reserved[3];
+    MacroStep steps[MACRO_MAX_STEPS];
+} MacroRecord;
+
+static MacroRecord macro;
+static MacroState state = MACRO_IDLE;
+static uint32_t last_tick = 0;  // 录制：上一条命令的时间
+static uint32_t due_tick = 0;   // 回放：下一条命令的时间
+static uint8_t play_index = 0;
+
+void Macro_StartRecord(void)
+{
+    macro.count = 0;
+    last_tick = Delay_GetTick();
+    state = MACRO_RECORDING;
+}
+
+void Macro_Stop(void)
+{
+    state = MACRO_IDLE;
+}
+
+uint8_t Macro_Play(void)
+{
+    if(state == MACRO_RECORDING || macro.count == 0) return 0;
+    play_index = 0;
+    due_tick = Delay_GetTick() + macro.steps[0].delay_ms;
+    state = MACRO_PLAYING;
+    return 1;
+}
+
+/**
+  * @brief  记录一条命令（命令分发处调用）
+  * @param  cmd: 蓝牙命令
+  * @param  arg: 参数
+  * @retval 无
+  * @detail 只在录制时记录；录满后丢弃后面的命令，录制状态不变
+  */
+void Macro_Record(uint8_t cmd, uint8_t arg)
+{
+    uint32_t now, delay;
+    MacroStep *step;
+
+    if(state != MACRO_RECORDING || macro.count >= MACRO_MAX_STEPS) return;
+    now = Delay_GetTick();
+    delay = now - last_tick;
+    last_tick = now;
+    step = &macro.steps[macro.count++];
+    step->delay_ms = (delay > 0xFFFF) ? 0xFFFF : (uint16_t)delay;
+    step->cmd = cmd;
+    step->arg = arg;
+}
+
+/**
+  * @brief  回放：到时间的步骤投递给ControlSystem，与真实蓝牙命令走同一条路径
+  * @param  无
+  * @retval 无
+  * @detail 每条的时间是上一条的计划时间加间隔，不是实际投递时间，晚到的一条不会推迟后面的；
+  *         事件队列满时下一次再投递
+  */
+void Macro_Task(void)
+{
+    MacroStep *step;
+
+    while(state == MACRO_PLAYING && (int32_t)(Delay_GetTick() - due_tick) >= 0) {
+        step = &macro.steps[play_index];
+        if(!ControlSystem_Post(CS_EVT_BT_CMD, step->cmd, step->arg)) return;
+        play_index++;
+        if(play_index >= macro.count) {
+            state = MACRO_IDLE;
+            return;
+        }
+        due_tick += macro.steps[play_index].delay_ms;
+    }
+}
+
+MacroState Macro_GetState(void)
+{
+    return state;
+}
+
+uint8_t Macro_GetCount(void)
+{
+    return macro.count;
+}
+
+uint8_t Macro_GetStep(uint8_t index, MacroStep *step)
+{
+    if(index >= macro.count || step == NULL) return 0;
+    *step = macro.steps[index];
+    return 1;
+}
+
+uint8_t Macro_AddStep(const MacroStep *step)
+{
+    if(state != MACRO_IDLE || macro.count >= MACRO_MAX_STEPS) return 0;
+    macro.steps[macro.count++] = *step;
+    return 1;
+}
+
+void Macro_Clear(void)
+{
+    state = MACRO_IDLE;
+    macro.count = 0;
+}
+
+uint8_t Macro_Save(void)
+{
+    if(state != MACRO_IDLE) return 0;
+    return FlashStore_Save(FLASH_STORE_MACRO, MACRO_VERSION, &macro, sizeof(macro));
+}
+
+// 直接读到macro里（失败时不改动），不在栈上再放一份
+uint8_t Macro_Load(void)
+{
+    if(state != MACRO_IDLE) return 0;
+    if(!FlashStore_Load(FLASH_STORE_MACRO, MACRO_VERSION, &macro, sizeof(macro))) return 0;
+    if(macro.count > MACRO_MAX_STEPS) macro.count = 0;
+    return macro.count != 0;
+}
@@ -0,0 +1,38 @@
+#ifndef __MACRO_H
+#define __MACRO_H
+
+#include "stm32f10x.h"
+
+// 蓝牙命令宏：录制手动遥控的命令序列（距上一条的时间、命令、参数），按原来的时间间隔回放。
+// 回放的命令和真实蓝牙命令一样投递给ControlSystem，走同一条处理路径；
+// 时间按录制开始点累计，不会因为某条命令处理慢而整体漂移。
+// 宏保存在Flash（FlashStore的宏区域），也可以通过蓝牙逐条上传/下载，见Bluetooth.c的$MACRO命令
+
+#define MACRO_MAX_STEPS     48
+
+typedef enum {
+    MACRO_IDLE = 0,
+    MACRO_RECORDING,
+    MACRO_PLAYING
+} MacroState;
+
+typedef struct {
+    uint16_t delay_ms;  // 距上一条（第一条为距录制开始）的时间，超过65535ms按65535记
+    uint8_t cmd;        // 蓝牙命令，BluetoothCommand
+    uint8_t arg;        // 参数，单字符命令为0
+} MacroStep;
+
+void Macro_StartRecord(void);                  // 清空并开始录制
+void Macro_Stop(void);                         // 结束录制或回放
+uint8_t Macro_Play(void);                      // 开始回放，返回0表示宏为空或正在录制
+void Macro_Record(uint8_t cmd, uint8_t arg);   // 命令分发处调用，只在录制时记录
+void Macro_Task(void);                         // 主循环中调用：到时间的步骤投递给ControlSystem
+MacroState Macro_GetState(void);
+uint8_t Macro_GetCount(void);
+uint8_t Macro_GetStep(uint8_t index, MacroStep *step);
+uint8_t Macro_AddStep(const MacroStep *step);  // 上传：追加一条，返回0表示已满或正在录制/回放
+void Macro_Clear(void);
+uint8_t Macro_Save(void);                      // 保存到Flash，返回0表示失败
+uint8_t Macro_Load(void);                      // 从Flash读回，返回0表示没有保存过
+
+#endif
@@ -1,20 +1,35 @@
 #include "stm32f10x.h"
+#include "OLED.h"
 #include "OLED_Font.h"
+#include "Format.h"
+#include "PWM.h"
+#include "Profile.h"
 
-/*引脚配置*/
-#define OLED_W_SCL(x)		GPIO_WriteBit(GPIOB, GPIO_Pin_6, (BitAction)(x))
+/*引脚配置：12路舵机版本PB6被TIM4_CH1占用，SCL改接PC13*/
+#if PWM_CHANNEL_NUM >= 12
+#define OLED_SCL_PORT		GPIOC
+#define OLED_SCL_PIN		GPIO_Pin_13
+#define OLED_SCL_RCC		RCC_APB2Periph_GPIOC
+#else
+#define OLED_SCL_PORT		GPIOB
+#define OLED_SCL_PIN		GPIO_Pin_6
+#define OLED_SCL_RCC		RCC_APB2Periph_GPIOB
+#endif
+#define OLED_W_SCL(x)		GPIO_WriteBit(OLED_SCL_PORT, OLED_SCL_PIN, (BitAction)(x))
 #define OLED_W_SDA(x)		GPIO_WriteBit(GPIOB, GPIO_Pin_7, (BitAction)(x))
 
+static uint8_t OLED_Ready = 0;		//OLED_Setup完成前的显示请求直接丢弃（快速启动时OLED晚于主循环就绪）
+
 /*引脚初始化*/
 void OLED_I2C_Init(void)
 {
 	GPIO_InitTypeDef GPIO_InitStructure;
-    RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOB, ENABLE);
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOB | OLED_SCL_RCC, ENABLE);
 	
  	GPIO_InitStructure.GPIO_Mode = GPIO_Mode_Out_OD;
 	GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
-	GPIO_InitStructure.GPIO_Pin = GPIO_Pin_6;
- 	GPIO_Init(GPIOB, &GPIO_InitStructure);
+	GPIO_InitStructure.GPIO_Pin = OLED_SCL_PIN;
+ 	GPIO_Init(OLED_SCL_PORT, &GPIO_InitStructure);
 	GPIO_InitStructure.GPIO_Pin = GPIO_Pin_7;
  	GPIO_Init(GPIOB, &GPIO_InitStructure);
 	
@@ -80,15 +95,25 @@ void OLED_WriteCommand(uint8_t Command)
 }
 
 /**
-  * @brief  OLED写数据
-  * @param  Data 要写入的数据
+  * @brief  OLED开始连续写数据，之后可用OLED_I2C_SendByte连续发送，最后OLED_I2C_Stop结束
+  * @param  无
   * @retval 无
   */
-void OLED_WriteData(uint8_t Data)
+void OLED_BeginData(void)
 {
 	OLED_I2C_Start();
 	OLED_I2C_SendByte(0x78);		//从机地址
 	OLED_I2C_SendByte(0x40);		//写数据
+}
+
+/**
+  * @brief  OLED写数据
+  * @param  Data 要写入的数据
+  * @retval 无
+  */
+void OLED_WriteData(uint8_t Data)
+{
+	OLED_BeginData();
 	OLED_I2C_SendByte(Data);
 	OLED_I2C_Stop();
 }
@@ -114,14 +139,32 @@ void OLED_SetCursor(uint8_t Y, uint8_t X)
 void OLED_Clear(void)
 {  
 	uint8_t i, j;
+	if (!OLED_Ready)
+	{
+		return;
+	}
 	for (j = 0; j < 8; j++)
 	{
 		OLED_SetCursor(j, 0);
+		OLED_BeginData();					//整页128字节一次写完
 		for(i = 0; i < 128; i++)
 		{
-			OLED_WriteData(0x00);
+			OLED_I2C_SendByte(0x00);
 		}
+		OLED_I2C_Stop();
+	}
+}
+
+/**
+  * @brief  字符转字模下标，超出ASCII可见字符范围的显示为'?'
+  */
+static uint8_t OLED_FontIndex(char Char)
+{
+	if (Char < ' ' || Char > '~')
+	{
+		Char = '?';
 	}
+	return Char - ' ';
 }
 
 /**
@@ -133,21 +176,30 @@ void OLED_Clear(void)
   */
 void OLED_ShowChar(uint8_t Line, uint8_t Column, char Char)
 {      	
-	uint8_t i;
+	uint8_t i, Index;
+	if (!OLED_Ready || Line < 1 || Line > 4 || Column < 1 || Column > 16)
+	{
+		return;
+	}
+	Index = OLED_FontIndex(Char);
 	OLED_SetCursor((Line - 1) * 2, (Column - 1) * 8);		//设置光标位置在上半部分
+	OLED_BeginData();
 	for (i = 0; i < 8; i++)
 	{
-		OLED_WriteData(OLED_F8x16[Char - ' '][i]);			//显示上半部分内容
+		OLED_I2C_SendByte(OLED_F8x16[Index][i]);			//显示上半部分内容
 	}
+	OLED_I2C_Stop();
 	OLED_SetCursor((Line - 1) * 2 + 1, (Column - 1) * 8);	//设置光标位置在下半部分
+	OLED_BeginData();
 	for (i = 0; i < 8; i++)
 	{
-		OLED_WriteData(OLED_F8x16[Char - ' '][i + 8]);		//显示下半部分内容
+		OLED_I2C_SendByte(OLED_F8x16[Index][i + 8]);		//显示下半部分内容
 	}
+	OLED_I2C_Stop();
 }
 
 /**
-  * @brief  OLED显示字符串
+  * @brief  OLED显示字符串，上下两半各用一次连续写完成，超出第16列的部分被截掉
   * @param  Line 起始行位置，范围：1~4
   * @param  Column 起始列位置，范围：1~16
   * @param  String 要显示的字符串，范围：ASCII可见字符
@@ -155,25 +207,134 @@ void OLED_ShowChar(uint8_t Line, uint8_t Column, char Char)
   */
 void OLED_ShowString(uint8_t Line, uint8_t Column, char *String)
 {
-	uint8_t i;
-	for (i = 0; String[i] != '\0'; i++)
+	uint8_t i, j, Half;
+	if (!OLED_Ready || Line < 1 || Line > 4 || Column < 1 || Column > 16)
+	{
+		return;
+	}
+	PROFILE_BEGIN(PROFILE_OLED_SHOW);
+	for (Half = 0; Half < 2; Half++)
+	{
+		OLED_SetCursor((Line - 1) * 2 + Half, (Column - 1) * 8);
+		OLED_BeginData();
+		for (i = 0; String[i] != '\0' && Column + i <= 16; i++)
+		{
+			for (j = 0; j < 8; j++)
+			{
+				OLED_I2C_SendByte(OLED_F8x16[OLED_FontIndex(String[i])][j + Half * 8]);
+			}
+		}
+		OLED_I2C_Stop();
+	}
+	PROFILE_END(PROFILE_OLED_SHOW);
+}
+
+/**
+  * @brief  OLED显示一个6x8小字符
+  * @param  Line 行位置，范围：1~8
+  * @param  Column 列位置，范围：1~21
+  * @param  Char 要显示的一个字符，范围：ASCII可见字符
+  * @retval 无
+  */
+void OLED_ShowChar6x8(uint8_t Line, uint8_t Column, char Char)
+{
+	uint8_t i, Index;
+	if (!OLED_Ready || Line < 1 || Line > 8 || Column < 1 || Column > 21)
+	{
+		return;
+	}
+	Index = OLED_FontIndex(Char);
+	OLED_SetCursor(Line - 1, (Column - 1) * 6);
+	OLED_BeginData();
+	for (i = 0; i < 6; i++)
+	{
+		OLED_I2C_SendByte(OLED_F6x8[Index][i]);
+	}
+	OLED_I2C_Stop();
+}
+
+/**
+  * @brief  OLED显示6x8小字符串，整行一次连续写完成，超出第21列的部分被截掉
+  * @param  Line 行位置，范围：1~8
+  * @param  Column 起始列位置，范围：1~21
+  * @param  String 要显示的字符串，范围：ASCII可见字符
+  * @retval 无
+  */
+void OLED_ShowString6x8(uint8_t Line, uint8_t Column, char *String)
+{
+	uint8_t i, j, Index;
+	if (!OLED_Ready || Line < 1 || Line > 8 || Column < 1 || Column > 21)
+	{
+		return;
+	}
+	OLED_SetCursor(Line - 1, (Column - 1) * 6);
+	OLED_BeginData();
+	for (i = 0; String[i] != '\0' && Column + i <= 21; i++)
 	{
-		OLED_ShowChar(Line, Column + i, String[i]);
+		Index = OLED_FontIndex(String[i]);
+		for (j = 0; j < 6; j++)
+		{
+			OLED_I2C_SendByte(OLED_F6x8[Index][j]);
+		}
 	}
+	OLED_I2C_Stop();
 }
 
 /**
-  * @brief  OLED次方函数
-  * @retval 返回值等于X的Y次方
+  * @brief  OLED显示游程压缩(RLE)的字模/图片
+  * @param  Page 起始页，范围：0~7
+  * @param  X 起始列，范围：0~127
+  * @param  Width 宽度（像素列数）
+  * @param  Pages 高度（页数，每页8像素）
+  * @param  Rle 压缩数据，按页从上到下、每页从左到右排列的列字节流，编码为：
+  *         控制字节c最高位为1：下一个字节重复(c & 0x7F) + 1次
+  *         控制字节c最高位为0：后面紧跟c + 1个原样字节
+  *         游程可以跨页，每页用一次连续写完成，解码不需要RAM缓冲区
+  * @retval 无
   */
-uint32_t OLED_Pow(uint32_t X, uint32_t Y)
+void OLED_DrawRLE(uint8_t Page, uint8_t X, uint8_t Width, uint8_t Pages, const uint8_t *Rle)
 {
-	uint32_t Result = 1;
-	while (Y--)
+	uint8_t p, i, Ctrl;
+	uint8_t Run = 0, Literal = 0, Value = 0;
+	if (!OLED_Ready)
+	{
+		return;
+	}
+	for (p = 0; p < Pages && Page + p < 8; p++)
 	{
-		Result *= X;
+		OLED_SetCursor(Page + p, X);
+		OLED_BeginData();
+		for (i = 0; i < Width; i++)
+		{
+			if (Run == 0 && Literal == 0)
+			{
+				Ctrl = *Rle++;
+				if (Ctrl & 0x80)
+				{
+					Run = (Ctrl & 0x7F) + 1;
+					Value = *Rle++;
+				}
+				else
+				{
+					Literal = Ctrl + 1;
+				}
+			}
+			if (Run)
+			{
+				Run--;
+			}
+			else
+			{
+				Literal--;
+				Value = *Rle++;
+			}
+			if (X + i < 128)
+			{
+				OLED_I2C_SendByte(Value);
+			}
+		}
+		OLED_I2C_Stop();
 	}
-	return Result;
 }
 
 /**
@@ -186,11 +347,9 @@ uint32_t OLED_Pow(uint32_t X, uint32_t Y)
   */
 void OLED_ShowNum(uint8_t Line, uint8_t Column, uint32_t Number, uint8_t Length)
 {
-	uint8_t i;
-	for (i = 0; i < Length; i++)							
-	{
-		OLED_ShowChar(Line, Column + i, Number / OLED_Pow(10, Length - i - 1) % 10 + '0');
-	}
+	char Buf[FORMAT_UINT_MAX_LEN + 1];
+	Format_UInt(Buf, Number, Length, '0');
+	OLED_ShowString(Line, Column, Buf);
 }
 
 /**
@@ -203,22 +362,36 @@ void OLED_ShowNum(uint8_t Line, uint8_t Column, uint32_t Number, uint8_t Length)
   */
 void OLED_ShowSignedNum(uint8_t Line, uint8_t Column, int32_t Number, uint8_t Length)
 {
-	uint8_t i;
+	char Buf[FORMAT_UINT_MAX_LEN + 2];
 	uint32_t Number1;
 	if (Number >= 0)
 	{
-		OLED_ShowChar(Line, Column, '+');
+		Buf[0] = '+';
 		Number1 = Number;
 	}
 	else
 	{
-		OLED_ShowChar(Line, Column, '-');
-		Number1 = -Number;
-	}
-	for (i = 0; i < Length; i++)							
-	{
-		OLED_ShowChar(Line, Column + i + 1, Number1 / OLED_Pow(10, Length - i - 1) % 10 + '0');
+		Buf[0] = '-';
+		Number1 = (uint32_t)(-(Number + 1)) + 1;
 	}
+	Format_UInt(Buf + 1, Number1, Length, '0');
+	OLED_ShowString(Line, Column, Buf);
+}
+
+/**
+  * @brief  OLED显示定点小数
+  * @param  Line 起始行位置，范围：1~4
+  * @param  Column 起始列位置，范围：1~16
+  * @param  Number 放大了10^Decimals倍的整数，例如1234配合Decimals=1显示123.4
+  * @param  Decimals 小数位数，范围：0~9
+  * @param  Length 总宽度（含符号和小数点），不足左侧补空格
+  * @retval 无
+  */
+void OLED_ShowFixedNum(uint8_t Line, uint8_t Column, int32_t Number, uint8_t Decimals, uint8_t Length)
+{
+	char Buf[FORMAT_INT_MAX_LEN + 2 + 16];
+	Format_Fixed(Buf, Number, Decimals, Length);
+	OLED_ShowString(Line, Column, Buf);
 }
 
 /**
@@ -231,19 +404,9 @@ void OLED_ShowSignedNum(uint8_t Line, uint8_t Column, int32_t Number, uint8_t Le
   */
 void OLED_ShowHexNum(uint8_t Line, uint8_t Column, uint32_t Number, uint8_t Length)
 {
-	uint8_t i, SingleNumber;
-	for (i = 0; i < Length; i++)							
-	{
-		SingleNumber = Number / OLED_Pow(16, Length - i - 1) % 16;
-		if (SingleNumber < 10)
-		{
-			OLED_ShowChar(Line, Column + i, SingleNumber + '0');
-		}
-		else
-		{
-			OLED_ShowChar(Line, Column + i, SingleNumber - 10 + 'A');
-		}
-	}
+	char Buf[9];
+	Format_Hex(Buf, Number, Length);
+	OLED_ShowString(Line, Column, Buf);
 }
 
 /**
@@ -256,11 +419,9 @@ void OLED_ShowHexNum(uint8_t Line, uint8_t Column, uint32_t Number, uint8_t Leng
   */
 void OLED_ShowBinNum(uint8_t Line, uint8_t Column, uint32_t Number, uint8_t Length)
 {
-	uint8_t i;
-	for (i = 0; i < Length; i++)							
-	{
-		OLED_ShowChar(Line, Column + i, Number / OLED_Pow(2, Length - i - 1) % 2 + '0');
-	}
+	char Buf[33];
+	Format_Bin(Buf, Number, Length);
+	OLED_ShowString(Line, Column, Buf);
 }
 
 /**
@@ -277,6 +438,16 @@ void OLED_Init(void)
 		for (j = 0; j < 1000; j++);
 	}
 	
+	OLED_Setup();
+}
+
+/**
+  * @brief  OLED配置（不含上电延时），调用者需保证OLED上电已超过OLED_POWERUP_MS
+  * @param  无
+  * @retval 无
+  */
+void OLED_Setup(void)
+{
 	OLED_I2C_Init();			//端口初始化
 	
 	OLED_WriteCommand(0xAE);	//关闭显示
@@ -316,6 +487,7 @@ void OLED_Init(void)
 	OLED_WriteCommand(0x14);
 
 	OLED_WriteCommand(0xAF);	//开启显示
-		
+	
+	OLED_Ready = 1;
 	OLED_Clear();				//OLED清屏
 }
@@ -1,13 +1,24 @@
 #ifndef __OLED_H
 #define __OLED_H
 
+#define OLED_POWERUP_MS		100		//OLED上电到可以接收配置命令的最短时间
+
 void OLED_Init(void);
+void OLED_Setup(void);
 void OLED_Clear(void);
 void OLED_ShowChar(uint8_t Line, uint8_t Column, char Char);
 void OLED_ShowString(uint8_t Line, uint8_t Column, char *String);
 void OLED_ShowNum(uint8_t Line, uint8_t Column, uint32_t Number, uint8_t Length);
 void OLED_ShowSignedNum(uint8_t Line, uint8_t Column, int32_t Number, uint8_t Length);
+void OLED_ShowFixedNum(uint8_t Line, uint8_t Column, int32_t Number, uint8_t Decimals, uint8_t Length);
 void OLED_ShowHexNum(uint8_t Line, uint8_t Column, uint32_t Number, uint8_t Length);
 void OLED_ShowBinNum(uint8_t Line, uint8_t Column, uint32_t Number, uint8_t Length);
 
+// 6x8小字体：8行 x 21列
+void OLED_ShowChar6x8(uint8_t Line, uint8_t Column, char Char);
+void OLED_ShowString6x8(uint8_t Line, uint8_t Column, char *String);
+
+// 游程压缩字模/图片，格式见OLED.c
+void OLED_DrawRLE(uint8_t Page, uint8_t X, uint8_t Width, uint8_t Pages, const uint8_t *Rle);
+
 #endif
@@ -0,0 +1,147 @@
+#include "ObstacleMap.h"
+#include "Ultrasonic.h"
+#include "Delay.h"
+
+typedef struct {
+    uint16_t distance_mm;
+    uint32_t timestamp;   // 记录时刻，0表示未知
+} ObstacleSector;
+
+// cos(k*30度)，Q8定点，用于行走时把位移投影到各扇区方向
+static const int16_t sector_cos_q8[OBSTACLE_MAP_SECTORS] = {
+    256, 222, 128, 0, -128, -222, -256, -222, -128, 0, 128, 222
+};
+
+static ObstacleSector sectors[OBSTACLE_MAP_SECTORS];
+static uint32_t last_sample_time = 0; // 已写入地图的最近一次测距时刻，避免同一个样本重复计入
+static uint8_t tie_toggle = 0;        // 两侧一样空旷时交替选择
+
+// 航向(度)所在的扇区
+static uint8_t ObstacleMap_SectorOf(int16_t heading)
+{
+    return ((heading + OBSTACLE_MAP_SECTOR_DEG / 2) / OBSTACLE_MAP_SECTOR_DEG) % OBSTACLE_MAP_SECTORS;
+}
+
+static uint8_t ObstacleMap_IsKnown(uint8_t sector)
+{
+    return sectors[sector].timestamp != 0 &&
+           Delay_GetTick() - sectors[sector].timestamp <= OBSTACLE_MAP_MAX_AGE_MS;
+}
+
+// 扇区的空旷程度(cm)，远处封顶，未知扇区给中间分
+static uint16_t ObstacleMap_Score(uint8_t sector)
+{
+    uint16_t cm;
+    if(!ObstacleMap_IsKnown(sector)) return OBSTACLE_MAP_UNKNOWN_CM;
+    cm = sectors[sector].distance_mm / 10;
+    return (cm > OBSTACLE_MAP_FAR_CM) ? OBSTACLE_MAP_FAR_CM : cm;
+}
+
+/**
+  * @brief  清空地图，航向归零（进入避障模式时调用）
+  * @param  无
+  * @retval 无
+  */
+void ObstacleMap_Reset(void)
+{
+    uint8_t i;
+    for(i = 0; i < OBSTACLE_MAP_SECTORS; i++) {
+        sectors[i].distance_mm = 0;
+        sectors[i].timestamp = 0;
+    }
+    last_sample_time = 0;
+    Dog_ResetHeading();
+}
+
+/**
+  * @brief  把最新的测距写入当前航向所在扇区
+  * @param  无
+  * @retval 无
+  * @detail 只使用有效且可信的新样本；同一个样本只计入一次
+  */
+void ObstacleMap_Update(void)
+{
+    UltrasonicSample sample = Ultrasonic_GetSample();
+    uint8_t s;
+
+    if(!sample.valid || sample.confidence < ULTRASONIC_MIN_CONFIDENCE) return;
+    if(sample.timestamp == last_sample_time) return;
+    last_sample_time = sample.timestamp;
+
+    s = ObstacleMap_SectorOf(Dog_GetHeading());
+    sectors[s].distance_mm = (uint16_t)(sample.distance * 10);
+    sectors[s].timestamp = sample.timestamp ? sample.timestamp : 1;
+}
+
+/**
+  * @brief  每走完一步调用：前进/后退时按位移修正各扇区距离，然后采样
+  * @param  mode: 刚完成的步态
+  * @retval 无
+  */
+void ObstacleMap_OnStep(DogMode mode)
+{
+    uint8_t h, i, rel;
+    int32_t d, shift;
+
+    if(mode == MODE_WALK_FORWARD || mode == MODE_WALK_BACKWARD) {
+        h = ObstacleMap_SectorOf(Dog_GetHeading());
+        for(i = 0; i < OBSTACLE_MAP_SECTORS; i++) {
+            if(sectors[i].timestamp == 0) continue;
+            rel = (i + OBSTACLE_MAP_SECTORS - h) % OBSTACLE_MAP_SECTORS;
+            // 只修正径向分量：朝障碍物走一步，距离减少 步长*cos(夹角)
+            shift = (DOG_WALK_STEP_MM * sector_cos_q8[rel]) >> 8;
+            d = (mode == MODE_WALK_FORWARD) ? sectors[i].distance_mm - shift : sectors[i].distance_mm + shift;
+            sectors[i].distance_mm = (d < 0) ? 0 : (d > 0xFFFF ? 0xFFFF : (uint16_t)d);
+        }
+    }
+    ObstacleMap_Update();
+}
+
+/**
+  * @brief  选择转向：比较左右两侧(30~150度)最空旷的扇区
+  * @param  steps: 输出，转到该扇区需要的转向步数（1~OBSTACLE_MAP_MAX_TURN_STEPS）
+  * @retval 转向方向
+  */
+ObstacleTurn ObstacleMap_ChooseTurn(uint8_t *steps)
+{
+    uint8_t h = ObstacleMap_SectorOf(Dog_GetHeading());
+    uint8_t offset, best_left = 1, best_right = 1;
+    uint16_t score, left = 0, right = 0;
+    ObstacleTurn turn;
+    uint8_t n;
+
+    for(offset = 1; offset <= OBSTACLE_MAP_SECTORS / 2 - 1; offset++) {
+        // 同样空旷时保留偏角小的扇区，少转几步
+        score = ObstacleMap_Score((h + offset) % OBSTACLE_MAP_SECTORS);
+        if(score > left) { left = score; best_left = offset; }
+        score = ObstacleMap_Score((h + OBSTACLE_MAP_SECTORS - offset) % OBSTACLE_MAP_SECTORS);
+        if(score > right) { right = score; best_right = offset; }
+    }
+
+    if(left > right) {
+        turn = OBSTACLE_TURN_LEFT;
+    } else if(right > left) {
+        turn = OBSTACLE_TURN_RIGHT;
+    } else {
+        tie_toggle ^= 1;
+        turn = tie_toggle ? OBSTACLE_TURN_LEFT : OBSTACLE_TURN_RIGHT;
+    }
+
+    offset = (turn == OBSTACLE_TURN_LEFT) ? best_left : best_right;
+    n = (offset * OBSTACLE_MAP_SECTOR_DEG + DOG_TURN_STEP_DEG / 2) / DOG_TURN_STEP_DEG;
+    if(n < 1) n = 1;
+    if(n > OBSTACLE_MAP_MAX_TURN_STEPS) n = OBSTACLE_MAP_MAX_TURN_STEPS;
+    *steps = n;
+    return turn;
+}
+
+/**
+  * @brief  读取扇区距离
+  * @param  sector: 0~OBSTACLE_MAP_SECTORS-1，0为进入避障模式时的正前方，逆时针递增
+  * @retval 距离(cm)，-1表示未知或已过期
+  */
+int16_t ObstacleMap_GetSector(uint8_t sector)
+{
+    if(sector >= OBSTACLE_MAP_SECTORS || !ObstacleMap_IsKnown(sector)) return -1;
+    return sectors[sector].distance_mm / 10;
+}
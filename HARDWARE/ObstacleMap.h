@@ -0,0 +1,29 @@
+#ifndef __OBSTACLE_MAP_H
+#define __OBSTACLE_MAP_H
+
+#include "stm32f10x.h"
+#include "DogActions.h"
+
+// 极坐标障碍物直方图：按推算航向把超声波测距记到12个扇区里，
+// 转向和行走时持续填充，避障时直接查表选最空旷的一侧，不用停下来重新测
+
+#define OBSTACLE_MAP_SECTORS        12
+#define OBSTACLE_MAP_SECTOR_DEG     (360 / OBSTACLE_MAP_SECTORS)
+#define OBSTACLE_MAP_MAX_AGE_MS     8000  // 超过这个时间的记录视为未知（推算航向会漂移）
+#define OBSTACLE_MAP_FAR_CM         100   // 超过这个距离都算空旷，不再区分
+#define OBSTACLE_MAP_UNKNOWN_CM     50    // 未知扇区按这个距离打分，比已知的近障碍物好、比已知的空旷差
+#define OBSTACLE_MAP_MAX_TURN_STEPS 6     // 一次最多转这么多步(90度)
+
+typedef enum {
+    OBSTACLE_TURN_LEFT = 0,
+    OBSTACLE_TURN_RIGHT
+} ObstacleTurn;
+
+// 函数声明
+void ObstacleMap_Reset(void);
+void ObstacleMap_Update(void);             // 把最新的测距写入当前航向所在扇区
+void ObstacleMap_OnStep(DogMode mode);     // 作为Dog_SetStepCallback的回调：平移已有记录并采样
+ObstacleTurn ObstacleMap_ChooseTurn(uint8_t *steps); // 选择更空旷的一侧，steps返回转到该扇区需要的步数
+int16_t ObstacleMap_GetSector(uint8_t sector);       // 扇区距离(cm)，-1表示未知
+
+#endif
@@ -2,101 +2,178 @@
 #include "stm32f10x.h"                 
 #include "stm32f10x_tim.h" 
 #include "PWM.h"
+#include "stddef.h"
+
+static void (*FrameCallback)(void) = NULL;
+static volatile uint32_t FrameCount = 0;
+
+// 通道表：下标i对应舵机i+1。前4路是每条腿的髋关节，接线与原来相同
+static const PWM_Channel Channels[PWM_CHANNEL_NUM] = {
+    {TIM3, TIM_Channel_4, GPIOB, GPIO_Pin_1,  0}, // 舵机1  PB1  TIM3_CH4
+    {TIM3, TIM_Channel_1, GPIOB, GPIO_Pin_4,  0}, // 舵机2  PB4  TIM3_CH1（部分重映射）
+    {TIM4, TIM_Channel_3, GPIOB, GPIO_Pin_8,  0}, // 舵机3  PB8  TIM4_CH3
+    {TIM4, TIM_Channel_4, GPIOB, GPIO_Pin_9,  0}, // 舵机4  PB9  TIM4_CH4
+#if PWM_CHANNEL_NUM >= 8
+    {TIM3, TIM_Channel_2, GPIOB, GPIO_Pin_5,  0}, // 舵机5  PB5  TIM3_CH2（部分重映射）
+    {TIM1, TIM_Channel_1, GPIOB, GPIO_Pin_13, 1}, // 舵机6  PB13 TIM1_CH1N
+    {TIM1, TIM_Channel_2, GPIOB, GPIO_Pin_14, 1}, // 舵机7  PB14 TIM1_CH2N
+    {TIM1, TIM_Channel_3, GPIOB, GPIO_Pin_15, 1}, // 舵机8  PB15 TIM1_CH3N
+#endif
+#if PWM_CHANNEL_NUM >= 12
+    {TIM1, TIM_Channel_4, GPIOA, GPIO_Pin_11, 0}, // 舵机9  PA11 TIM1_CH4（原LED1）
+    {TIM2, TIM_Channel_1, GPIOA, GPIO_Pin_15, 0}, // 舵机10 PA15 TIM2_CH1（部分重映射1，原LED3）
+    {TIM2, TIM_Channel_2, GPIOB, GPIO_Pin_3,  0}, // 舵机11 PB3  TIM2_CH2（部分重映射1，原LED4）
+    {TIM4, TIM_Channel_1, GPIOB, GPIO_Pin_6,  0}, // 舵机12 PB6  TIM4_CH1（原OLED SCL）
+#endif
+};
+
+// 用到的定时器，TIM3放在最前面，它的更新中断就是帧中断
+static TIM_TypeDef *const Timers[] = {
+    TIM3, TIM4,
+#if PWM_CHANNEL_NUM >= 8
+    TIM1,
+#endif
+#if PWM_CHANNEL_NUM >= 12
+    TIM2,
+#endif
+};
+
+// 按通道号调用对应的输出比较初始化和预装载配置
+static void PWM_InitChannel(const PWM_Channel *ch, TIM_OCInitTypeDef *oc)
+{
+    oc->TIM_OutputState = ch->complementary ? TIM_OutputState_Disable : TIM_OutputState_Enable;
+    oc->TIM_OutputNState = ch->complementary ? TIM_OutputNState_Enable : TIM_OutputNState_Disable;
+    switch(ch->channel) {
+        case TIM_Channel_1: TIM_OC1Init(ch->tim, oc); TIM_OC1PreloadConfig(ch->tim, TIM_OCPreload_Enable); break;
+        case TIM_Channel_2: TIM_OC2Init(ch->tim, oc); TIM_OC2PreloadConfig(ch->tim, TIM_OCPreload_Enable); break;
+        case TIM_Channel_3: TIM_OC3Init(ch->tim, oc); TIM_OC3PreloadConfig(ch->tim, TIM_OCPreload_Enable); break;
+        default:            TIM_OC4Init(ch->tim, oc); TIM_OC4PreloadConfig(ch->tim, TIM_OCPreload_Enable); break;
+    }
+}
 
 void PWM_Init(void)
 {
     GPIO_InitTypeDef GPIO_InitStructure;
     TIM_TimeBaseInitTypeDef TIM_TimeBaseInitStructure;
     TIM_OCInitTypeDef TIM_OCInitStructure;
+    NVIC_InitTypeDef NVIC_InitStructure;
+    uint8_t i;
 
-    /* 0. 关键步骤：开启AFIO时钟，并禁用JTAG，释放PB4 */
+    /* 0. 关键步骤：开启AFIO时钟，禁用JTAG释放PB3、PB4、PA15，TIM3部分重映射把CH1/CH2接到PB4/PB5 */
     RCC_APB2PeriphClockCmd(RCC_APB2Periph_AFIO, ENABLE); // 必须先开启AFIO时钟
-    GPIO_PinRemapConfig(GPIO_Remap_SWJ_JTAGDisable, ENABLE); // 这会禁用JTAG，但保留SWD调试功能，从而释放PB3, PB4, PA15
+    GPIO_PinRemapConfig(GPIO_Remap_SWJ_JTAGDisable, ENABLE); // 这会禁用JTAG，但保留SWD调试功能
+    GPIO_PinRemapConfig(GPIO_PartialRemap_TIM3, ENABLE);     // 不重映射时TIM3_CH1在PA6（按键），PB4没有PWM输出
+#if PWM_CHANNEL_NUM >= 12
+    GPIO_PinRemapConfig(GPIO_PartialRemap1_TIM2, ENABLE);    // TIM2_CH1/CH2 -> PA15/PB3
+#endif
 
     /* 1. 开启时钟 */
     RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM3 | RCC_APB1Periph_TIM4, ENABLE);
-    RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOB, ENABLE);
-    
+#if PWM_CHANNEL_NUM >= 8
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_TIM1, ENABLE);
+#endif
+#if PWM_CHANNEL_NUM >= 12
+    RCC_APB1PeriphClockCmd(RCC_APB1Periph_TIM2, ENABLE);
+#endif
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_GPIOA | RCC_APB2Periph_GPIOB, ENABLE);
+
     /* 2. 配置GPIO引脚 */
     GPIO_InitStructure.GPIO_Mode = GPIO_Mode_AF_PP;
     GPIO_InitStructure.GPIO_Speed = GPIO_Speed_50MHz;
-    
-    // PB1 - TIM3通道4
-    GPIO_InitStructure.GPIO_Pin = GPIO_Pin_1;
-    GPIO_Init(GPIOB, &GPIO_InitStructure);
-    
-    // PB4 - TIM3通道1 (现在它被释放了，可以正常配置)
-    GPIO_InitStructure.GPIO_Pin = GPIO_Pin_4;
-    GPIO_Init(GPIOB, &GPIO_InitStructure);
-    
-    // PB8 - TIM4通道3
-    GPIO_InitStructure.GPIO_Pin = GPIO_Pin_8;
-    GPIO_Init(GPIOB, &GPIO_InitStructure);
-    
-    // PB9 - TIM4通道4
-    GPIO_InitStructure.GPIO_Pin = GPIO_Pin_9;
-    GPIO_Init(GPIOB, &GPIO_InitStructure);
-    
-    /* 3. 配置定时器时基单元 (TIM3 和 TIM4) */
+    for(i = 0; i < PWM_CHANNEL_NUM; i++) {
+        GPIO_InitStructure.GPIO_Pin = Channels[i].pin;
+        GPIO_Init(Channels[i].port, &GPIO_InitStructure);
+    }
+
+    /* 3. 配置定时器时基单元，所有定时器都是1MHz计数、20ms周期（TIM1在APB2上，同样是72MHz） */
     TIM_TimeBaseStructInit(&TIM_TimeBaseInitStructure); // 使用默认值初始化
     TIM_TimeBaseInitStructure.TIM_ClockDivision = TIM_CKD_DIV1;
     TIM_TimeBaseInitStructure.TIM_CounterMode = TIM_CounterMode_Up;
     TIM_TimeBaseInitStructure.TIM_Period = 20000 - 1; // 20ms 周期
     TIM_TimeBaseInitStructure.TIM_Prescaler = 72 - 1; // 1MHz 计数频率
-    
-    TIM_TimeBaseInit(TIM3, &TIM_TimeBaseInitStructure);
-    TIM_TimeBaseInit(TIM4, &TIM_TimeBaseInitStructure);
-    
-    /* 4. 配置定时器输出比较单元 */
+    for(i = 0; i < sizeof(Timers) / sizeof(Timers[0]); i++) {
+        TIM_TimeBaseInit(Timers[i], &TIM_TimeBaseInitStructure);
+        TIM_ARRPreloadConfig(Timers[i], ENABLE); // 启用自动重装载预装载
+    }
+
+    /* 4. 配置输出比较单元并启用预装载 */
     TIM_OCStructInit(&TIM_OCInitStructure); // 使用默认值初始化
     TIM_OCInitStructure.TIM_OCMode = TIM_OCMode_PWM1;
     TIM_OCInitStructure.TIM_OCPolarity = TIM_OCPolarity_High;
-    TIM_OCInitStructure.TIM_OutputState = TIM_OutputState_Enable;
+    TIM_OCInitStructure.TIM_OCNPolarity = TIM_OCNPolarity_High; // 只开CHxN时输出OCxREF本身，不取反
     TIM_OCInitStructure.TIM_Pulse = 1500;  // 初始1.5ms
-    
-    // 初始化 TIM3 的两个通道
-    TIM_OC1Init(TIM3, &TIM_OCInitStructure); // PB4 -> TIM3_CH1
-    TIM_OC4Init(TIM3, &TIM_OCInitStructure); // PB1 -> TIM3_CH4
-    
-    // 初始化 TIM4 的两个通道
-    TIM_OC3Init(TIM4, &TIM_OCInitStructure); // PB8 -> TIM4_CH3
-    TIM_OC4Init(TIM4, &TIM_OCInitStructure); // PB9 -> TIM4_CH4
-    
-    /* 5. 启用所有通道的预装载 */
-    TIM_OC1PreloadConfig(TIM3, TIM_OCPreload_Enable);
-    TIM_OC4PreloadConfig(TIM3, TIM_OCPreload_Enable);
-    TIM_OC3PreloadConfig(TIM4, TIM_OCPreload_Enable);
-    TIM_OC4PreloadConfig(TIM4, TIM_OCPreload_Enable);
-
-    /* 6. 启用自动重装载预装载 */
-    TIM_ARRPreloadConfig(TIM3, ENABLE);
-    TIM_ARRPreloadConfig(TIM4, ENABLE);
-    
-    /* 7. 启动定时器 */
-    TIM_Cmd(TIM3, ENABLE);
-    TIM_Cmd(TIM4, ENABLE);
+    for(i = 0; i < PWM_CHANNEL_NUM; i++) {
+        PWM_InitChannel(&Channels[i], &TIM_OCInitStructure);
+    }
+#if PWM_CHANNEL_NUM >= 8
+    TIM_CtrlPWMOutputs(TIM1, ENABLE); // 高级定时器还要打开主输出(MOE)
+#endif
+
+    /* 5. 帧中断：TIM3每个周期更新一次，新的比较值在这时装入 */
+    NVIC_InitStructure.NVIC_IRQChannel = TIM3_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 2; // 低于回波EXTI和I2C/串口，帧处理期间它们照常响应
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+    TIM_ClearITPendingBit(TIM3, TIM_IT_Update);
+    TIM_ITConfig(TIM3, TIM_IT_Update, ENABLE);
+
+    /* 6. 启动定时器 */
+    for(i = 0; i < sizeof(Timers) / sizeof(Timers[0]); i++) {
+        TIM_Cmd(Timers[i], ENABLE);
+    }
+}
+
+void PWM_SetFrameCallback(void (*callback)(void))
+{
+    FrameCallback = callback;
 }
 
-// 舵机1 -> PB1 (TIM3_CH4)
-void PWM_SetCompare1(uint16_t Compare)
+uint32_t PWM_GetFrameCount(void)
 {
-    TIM_SetCompare4(TIM3, Compare);
+    return FrameCount;
 }
 
-// 舵机2 -> PB4 (TIM3_CH1)
-void PWM_SetCompare2(uint16_t Compare)
+// 关闭通道输出后引脚保持低电平，舵机收不到脉冲即卸力；定时器本身继续运行，帧中断不受影响
+void PWM_OutputEnable(uint8_t Enable)
 {
-    TIM_SetCompare1(TIM3, Compare);
+    uint8_t i;
+    for(i = 0; i < PWM_CHANNEL_NUM; i++) {
+        if(Channels[i].complementary) {
+            TIM_CCxNCmd(Channels[i].tim, Channels[i].channel, Enable ? TIM_CCxN_Enable : TIM_CCxN_Disable);
+        } else {
+            TIM_CCxCmd(Channels[i].tim, Channels[i].channel, Enable ? TIM_CCx_Enable : TIM_CCx_Disable);
+        }
+    }
 }
 
-// 舵机3 -> PB8 (TIM4_CH3)
-void PWM_SetCompare3(uint16_t Compare)
+// TIM3更新中断：一个PWM周期开始，此时写入的比较值在下一个周期生效
+void TIM3_IRQHandler(void)
 {
-    TIM_SetCompare3(TIM4, Compare);
+    if(TIM_GetITStatus(TIM3, TIM_IT_Update) != RESET) {
+        TIM_ClearITPendingBit(TIM3, TIM_IT_Update);
+        FrameCount++;
+        if(FrameCallback != NULL) {
+            FrameCallback();
+        }
+    }
 }
 
-// 舵机4 -> PB9 (TIM4_CH4)
-void PWM_SetCompare4(uint16_t Compare)
+/**
+  * @brief  设置一路舵机的脉宽
+  * @param  Index: 通道表下标（舵机编号-1）
+  * @param  Compare: 脉宽(us)
+  * @retval 无
+  */
+void PWM_SetCompare(uint8_t Index, uint16_t Compare)
 {
-    TIM_SetCompare4(TIM4, Compare);
+    const PWM_Channel *ch;
+    if(Index >= PWM_CHANNEL_NUM) return;
+    ch = &Channels[Index];
+    switch(ch->channel) {
+        case TIM_Channel_1: TIM_SetCompare1(ch->tim, Compare); break;
+        case TIM_Channel_2: TIM_SetCompare2(ch->tim, Compare); break;
+        case TIM_Channel_3: TIM_SetCompare3(ch->tim, Compare); break;
+        default:            TIM_SetCompare4(ch->tim, Compare); break;
+    }
 }
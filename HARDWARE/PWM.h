@@ -1,10 +1,34 @@
 #ifndef __PWM_H
 #define __PWM_H
 
+#include "stm32f10x.h"
+
+#define PWM_FRAME_HZ    50   // 舵机PWM周期20ms，每个周期开始时产生一次帧中断
+
+// 舵机通道数：4（每条腿1个关节）、8（2个）、12（3个），编译时选择
+// 8路额外占用PB5和TIM1的互补输出PB13~PB15；12路再占用PA11/PA15/PB3（LED1/LED3/LED4不再亮）
+// 和PB6（OLED的SCL改接PC13），通道表见PWM.c
+#ifndef PWM_CHANNEL_NUM
+#define PWM_CHANNEL_NUM 4
+#endif
+
+#if PWM_CHANNEL_NUM != 4 && PWM_CHANNEL_NUM != 8 && PWM_CHANNEL_NUM != 12
+#error "PWM_CHANNEL_NUM must be 4, 8 or 12"
+#endif
+
+// 一路舵机PWM：定时器通道和引脚
+typedef struct {
+    TIM_TypeDef *tim;
+    uint16_t channel;      // TIM_Channel_x
+    GPIO_TypeDef *port;
+    uint16_t pin;
+    uint8_t complementary; // 1：用TIM1的CHxN引脚输出
+} PWM_Channel;
+
 void PWM_Init(void);
-void PWM_SetCompare1(uint16_t Compare);
-void PWM_SetCompare2(uint16_t Compare);
-void PWM_SetCompare3(uint16_t Compare);
-void PWM_SetCompare4(uint16_t Compare);
+void PWM_SetFrameCallback(void (*callback)(void)); // 每帧(TIM3更新中断)调用一次
+uint32_t PWM_GetFrameCount(void);
+void PWM_OutputEnable(uint8_t Enable);            // 打开/关闭全部舵机通道的输出
+void PWM_SetCompare(uint8_t Index, uint16_t Compare); // Index为通道表下标，0 ~ PWM_CHANNEL_NUM-1
 
 #endif
@@ -0,0 +1,161 @@
+#include "Posture.h"
+#include "Servo.h"
+#include "DogActions.h"
+#include "MPU6050.h"
+#include "IMU.h"
+#include "PWM.h"
+#include "Delay.h"
+#include "Bluetooth.h"
+#include "Format.h"
+
+// 每条腿"伸长"对应的舵机转向：左右两侧舵机镜像安装（见Dog_Action_Hello：1号45度为抬起，2号135度为抬起）
+static const int8_t leg_extend_sign[5] = {0, +1, -1, -1, +1};
+// 每条腿在前后/左右方向上的位置：前+1后-1，右+1左-1
+static const int8_t leg_front[5] = {0, +1, +1, -1, -1};
+static const int8_t leg_right[5] = {0, +1, -1, -1, +1};
+
+typedef struct {
+    float integral;
+    float output;
+} PostureAxis;
+
+static PostureAxis pitch_axis, roll_axis;
+static volatile uint8_t enabled = 0;
+static uint8_t hooked = 0;
+
+static volatile uint16_t run_count = 0;     // 本秒内闭环运行次数
+static volatile uint16_t rate_hz = 0;
+static volatile uint32_t latency_us = 0;
+static uint32_t rate_time = 0;
+static uint32_t report_time = 0;
+
+// 单轴PID：误差为角度(度)，D项用角速度(度/秒)
+static float Posture_Pid(PostureAxis *axis, int32_t angle_mdeg, int32_t rate_mdps)
+{
+    const float dt = 1.0f / PWM_FRAME_HZ;
+    float error, p, d, out;
+
+    if(angle_mdeg > -POSTURE_DEADBAND_MDEG && angle_mdeg < POSTURE_DEADBAND_MDEG) angle_mdeg = 0;
+    error = -angle_mdeg * 0.001f; // 目标为水平
+    p = POSTURE_KP * error;
+    d = -POSTURE_KD * rate_mdps * 0.001f;
+    out = p + axis->integral + d;
+
+    // 抗积分饱和：输出已到限幅且误差还在往同方向推时不再积分
+    if(!((out >= POSTURE_OUT_LIMIT_DEG && error > 0) || (out <= -POSTURE_OUT_LIMIT_DEG && error < 0))) {
+        axis->integral += POSTURE_KI * error * dt;
+        if(axis->integral > POSTURE_I_LIMIT_DEG) axis->integral = POSTURE_I_LIMIT_DEG;
+        if(axis->integral < -POSTURE_I_LIMIT_DEG) axis->integral = -POSTURE_I_LIMIT_DEG;
+    }
+
+    out = p + axis->integral + d;
+    if(out > POSTURE_OUT_LIMIT_DEG) out = POSTURE_OUT_LIMIT_DEG;
+    if(out < -POSTURE_OUT_LIMIT_DEG) out = -POSTURE_OUT_LIMIT_DEG;
+    axis->output = out;
+    return out;
+}
+
+static void Posture_Clear(void)
+{
+    uint8_t id;
+    pitch_axis.integral = 0;
+    pitch_axis.output = 0;
+    roll_axis.integral = 0;
+    roll_axis.output = 0;
+    for(id = 1; id <= 4; id++) {
+        Servo_SetOffset(id, 0);
+    }
+}
+
+// 舵机帧回调（TIM3中断，50Hz）
+static void Posture_Frame(void)
+{
+    IMU_Attitude att;
+    float pitch_out, roll_out, leg;
+    uint8_t id;
+
+    if(!enabled) return;
+    IMU_GetAttitude(&att);
+    if(!att.calibrated) return;
+
+    pitch_out = Posture_Pid(&pitch_axis, att.pitch, att.pitch_rate);
+    roll_out = Posture_Pid(&roll_axis, att.roll, att.roll_rate);
+
+    // 抬头(pitch>0)时pitch_out<0：前腿缩、后腿伸；右侧低(roll>0)时roll_out<0：右腿伸、左腿缩
+    for(id = 1; id <= 4; id++) {
+        leg = pitch_out * leg_front[id] - roll_out * leg_right[id];
+        if(leg > POSTURE_LEG_LIMIT_DEG) leg = POSTURE_LEG_LIMIT_DEG;
+        if(leg < -POSTURE_LEG_LIMIT_DEG) leg = -POSTURE_LEG_LIMIT_DEG;
+        Servo_SetOffset(id, leg * leg_extend_sign[id]);
+    }
+
+    run_count++;
+    latency_us = Delay_GetUs() - MPU6050_GetFrameTime(); // 修正量在本帧写入，这里就是采样到输出的延迟
+}
+
+/**
+  * @brief  检测到IMU时启用姿态闭环
+  * @param  无
+  * @retval 无
+  */
+void Posture_Init(void)
+{
+    if(!MPU6050_IsPresent()) return;
+    Posture_Clear();
+    Servo_AddFrameHook(Posture_Frame);
+    hooked = 1;
+    enabled = 1;
+}
+
+void Posture_Enable(uint8_t enable)
+{
+    if(!hooked || enabled == enable) return;
+    enabled = 0;
+    Posture_Clear();
+    enabled = enable;
+}
+
+uint8_t Posture_IsEnabled(void)
+{
+    return enabled;
+}
+
+/**
+  * @brief  统计闭环频率，按POSTURE_REPORT_MS上报
+  * @param  无
+  * @retval 无
+  */
+void Posture_Task(void)
+{
+    uint32_t now = Delay_GetTick();
+    char msg[40];
+    char *p = msg;
+
+    if(!hooked) return;
+    if(now - rate_time >= 1000) {
+        rate_hz = run_count;
+        run_count = 0;
+        rate_time = now;
+    }
+#if POSTURE_REPORT_MS
+    if(enabled && now - report_time >= POSTURE_REPORT_MS) {
+        report_time = now;
+        p += Format_Str(p, "Posture: ");
+        p += Format_UInt(p, rate_hz, 0, ' ');
+        p += Format_Str(p, "Hz, lat ");
+        p += Format_UInt(p, latency_us, 0, ' ');
+        Format_Str(p, "us\r\n");
+        Bluetooth_SendString(msg);
+    }
+#endif
+}
+
+uint16_t Posture_GetRateHz(void)
+{
+    return rate_hz;
+}
+
+uint32_t Posture_GetLatencyUs(void)
+{
+    return latency_us;
+}
@@ -0,0 +1,26 @@
+#ifndef __POSTURE_H
+#define __POSTURE_H
+
+#include "stm32f10x.h"
+
+// 姿态闭环：在舵机帧中断(50Hz)里根据IMU的俯仰/横滚给每条腿加一个小修正量，
+// 叠加在站立/步态给出的角度上，让机身保持水平
+
+#define POSTURE_KP              0.6f    // 度/度
+#define POSTURE_KI              0.8f    // 度/(度*秒)
+#define POSTURE_KD              0.02f   // 度/(度/秒)，D项直接用陀螺仪角速度
+#define POSTURE_I_LIMIT_DEG     8.0f    // 积分项上限（抗积分饱和）
+#define POSTURE_OUT_LIMIT_DEG   12.0f   // 单轴输出上限
+#define POSTURE_LEG_LIMIT_DEG   15.0f   // 每条腿修正量上限
+#define POSTURE_DEADBAND_MDEG   500     // 0.5度以内不修正，避免舵机抖动
+#define POSTURE_REPORT_MS       5000    // 通过蓝牙上报环路频率和延迟的间隔，0表示不上报
+
+// 函数声明
+void Posture_Init(void);           // IMU存在时挂到舵机帧中断上
+void Posture_Enable(uint8_t enable); // 坐下等故意倾斜的动作前关闭，关闭时修正量清零
+uint8_t Posture_IsEnabled(void);
+void Posture_Task(void);           // 主循环中调用，定期上报统计
+uint16_t Posture_GetRateHz(void);  // 最近一秒闭环实际运行次数
+uint32_t Posture_GetLatencyUs(void); // IMU采样到舵机输出的延迟（最近一次）
+
+#endif
@@ -0,0 +1,92 @@
+#include "PowerGovernor.h"
+#include "adc_dma.h"
+#include "Delay.h"
+
+static const PowerLimits power_limits[3] = {
+    {10, 4, 20, 100},  // 正常
+    { 5, 2, 40, 150},  // 低电量
+    { 1, 1, 60, 200}   // 严重不足
+};
+
+static PowerLevel level = POWER_NORMAL;
+static uint16_t battery_mv = 0;
+static uint32_t last_update = 0;
+static uint8_t down_count = 0;  // 连续满足降级条件的次数
+static uint8_t up_count = 0;    // 连续满足恢复条件的次数
+
+// 只看电压/电流本身应处于的等级（带回差）
+static PowerLevel PowerGovernor_Target(uint16_t mv)
+{
+    PowerLevel target = level;
+
+    if(mv < POWER_NO_BATTERY_MV) return POWER_NORMAL;
+
+    switch(level) {
+        case POWER_NORMAL:
+            if(mv < POWER_CRITICAL_MV) target = POWER_CRITICAL;
+            else if(mv < POWER_LOW_MV) target = POWER_LOW;
+            break;
+        case POWER_LOW:
+            if(mv < POWER_CRITICAL_MV) target = POWER_CRITICAL;
+            else if(mv >= POWER_LOW_RECOVER_MV) target = POWER_NORMAL;
+            break;
+        case POWER_CRITICAL:
+            if(mv >= POWER_LOW_RECOVER_MV) target = POWER_NORMAL;
+            else if(mv >= POWER_CRITICAL_RECOVER_MV) target = POWER_LOW;
+            break;
+    }
+#if ADC_USE_CURRENT
+    if(target == POWER_NORMAL && ADC_GetCurrent_mA() > POWER_CURRENT_LIMIT_MA) target = POWER_LOW;
+#endif
+    return target;
+}
+
+/**
+  * @brief  更新电量等级，每POWER_UPDATE_MS评估一次
+  * @param  无
+  * @retval 1表示等级刚刚改变
+  */
+uint8_t PowerGovernor_Task(void)
+{
+    uint32_t now = Delay_GetTick();
+    PowerLevel target;
+
+    if(now - last_update < POWER_UPDATE_MS) return 0;
+    last_update = now;
+    if(ADC_GetUpdateCount() == 0) return 0; // ADC还没有数据
+
+    battery_mv = ADC_GetBattery_mV();
+    target = PowerGovernor_Target(battery_mv);
+
+    if(target > level) {
+        up_count = 0;
+        if(++down_count < POWER_CONFIRM_COUNT) return 0;
+    } else if(target < level) {
+        down_count = 0;
+        if(++up_count < POWER_CONFIRM_COUNT) return 0;
+    } else {
+        down_count = 0;
+        up_count = 0;
+        return 0;
+    }
+
+    down_count = 0;
+    up_count = 0;
+    level = target;
+    return 1;
+}
+
+PowerLevel PowerGovernor_GetLevel(void)
+{
+    return level;
+}
+
+const PowerLimits *PowerGovernor_GetLimits(void)
+{
+    return &power_limits[level];
+}
+
+uint16_t PowerGovernor_GetBattery_mV(void)
+{
+    return battery_mv;
+}
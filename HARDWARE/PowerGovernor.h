@@ -0,0 +1,37 @@
+#ifndef __POWER_GOVERNOR_H
+#define __POWER_GOVERNOR_H
+
+#include "stm32f10x.h"
+
+// 电池电压阈值(mV)，按2S锂电池设置；降级和恢复阈值不同，避免在阈值附近来回切换
+#define POWER_LOW_MV                7000
+#define POWER_LOW_RECOVER_MV        7200
+#define POWER_CRITICAL_MV           6600
+#define POWER_CRITICAL_RECOVER_MV   6900
+#define POWER_NO_BATTERY_MV         3000  // 低于此值认为没接分压（USB供电调试），不做限制
+#define POWER_CURRENT_LIMIT_MA      2500  // 舵机总电流超过此值按低电量处理（需启用ADC_USE_CURRENT）
+
+#define POWER_UPDATE_MS             100
+#define POWER_CONFIRM_COUNT         5     // 连续这么多次越过阈值才切换，滤掉舵机启动瞬间的跌落
+
+typedef enum {
+    POWER_NORMAL = 0,
+    POWER_LOW,        // 降速、减少同时动作的舵机数
+    POWER_CRITICAL    // 坐下并报警
+} PowerLevel;
+
+// 当前电量等级下对动作的限制
+typedef struct {
+    uint8_t max_speed;        // 步态速度上限(1~10)，与Dog_SetWalkSpeed同一刻度
+    uint8_t max_concurrent;   // 同时启动的舵机数
+    uint16_t stagger_ms;      // 分批启动舵机的间隔
+    uint8_t slew_percent;     // 平滑移动的时长倍率(%)，越大舵机转得越慢
+} PowerLimits;
+
+// 函数声明
+uint8_t PowerGovernor_Task(void);              // 主循环中调用，电量等级变化时返回1
+PowerLevel PowerGovernor_GetLevel(void);
+const PowerLimits *PowerGovernor_GetLimits(void);
+uint16_t PowerGovernor_GetBattery_mV(void);    // 最近一次读到的电池电压
+
+#endif
@@ -0,0 +1,87 @@
+#include "stm32f10x.h"
+#include "Trajectory.h"
+#include "OLED.h"
+#include "Delay.h"
+#include "Bluetooth.h"
+#include "Format.h"
+#include "PWM.h"
+#include "Profile.h"
+
+#define TRAJ_BENCH_COUNT    1000   // 每种曲线求值的次数
+#define TRAJ_TRACE_MS       600    // 轨迹时长，与一次坐下的过渡相当
+
+static const char *const profile_names[3] = {"linear", "cubic", "minjerk"};
+static volatile int16_t bench_sink;  // 防止求值被优化掉
+
+// 每次求值的CPU周期数，用DWT周期计数器测量，含循环开销；主机上的对照见test/TrajectoryBench.c
+static uint32_t Trajectory_Bench(Trajectory *t)
+{
+    uint32_t start, cycles;
+    uint16_t i;
+
+    start = PROFILE_DWT_CYCCNT;
+    for(i = 0; i < TRAJ_BENCH_COUNT; i++) {
+        bench_sink = Trajectory_Eval(t, (uint32_t)i * 65);
+    }
+    cycles = PROFILE_DWT_CYCCNT - start;
+    return cycles / TRAJ_BENCH_COUNT;
+}
+
+void Trajectory_Test(void)
+{
+    Trajectory t[4];
+    char buf[64], *p;
+    uint32_t cycles;
+    uint16_t ms;
+    uint8_t i;
+
+    OLED_Init();
+    Bluetooth_Init();
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk; // 打开DWT周期计数器（与Profile_Init相同，不依赖PROFILE_ENABLE）
+    PROFILE_DWT_CTRL |= PROFILE_DWT_CYCCNTENA;
+
+    OLED_Clear();
+    OLED_ShowString(1, 1, "==Traj Bench==");
+
+    // 0度到90度，最后一条是带起止斜率的三次Hermite（途经点情形）
+    for(i = 0; i < 3; i++) {
+        Trajectory_Start(&t[i], 0, 9000, TRAJ_TRACE_MS, i);
+    }
+    Trajectory_Start(&t[3], 0, 9000, TRAJ_TRACE_MS, TRAJ_CUBIC);
+    Trajectory_SetSlopes(&t[3], 4500, 4500);
+
+    // 基准：每种曲线的求值开销，显示在OLED第2~4行并从蓝牙输出
+    for(i = 0; i < 3; i++) {
+        cycles = Trajectory_Bench(&t[i]);
+        p = buf;
+        p += Format_Str(p, "BENCH ");
+        p += Format_Str(p, profile_names[i]);
+        p += Format_Char(p, ' ');
+        p += Format_UInt(p, cycles, 0, ' ');
+        p += Format_Str(p, " cyc\r\n");
+        *p = '\0';
+        Bluetooth_SendString(buf);
+
+        p = buf;
+        p += Format_Str(p, profile_names[i]);
+        p += Format_Char(p, ' ');
+        p += Format_UInt(p, cycles, 4, ' ');
+        *p = '\0';
+        OLED_ShowString(i + 2, 1, buf);
+    }
+
+    // 轨迹：每个舵机帧一行CSV，角度单位0.01度，可直接粘到表格里画曲线
+    Bluetooth_SendString("ms,linear,cubic,minjerk,hermite\r\n");
+    for(ms = 0; ms <= TRAJ_TRACE_MS; ms += 1000 / PWM_FRAME_HZ) {
+        p = buf;
+        p += Format_UInt(p, ms, 0, ' ');
+        for(i = 0; i < 4; i++) {
+            p += Format_Char(p, ',');
+            p += Format_Int(p, Trajectory_Eval(&t[i], ((uint32_t)ms << 16) / TRAJ_TRACE_MS), 0, ' ');
+        }
+        p += Format_Str(p, "\r\n");
+        *p = '\0';
+        Bluetooth_SendString(buf);
+        Delay_ms(5); // 给蓝牙串口留出发送时间
+    }
+}
@@ -1,9 +1,39 @@
 #include "Ultrasonic.h"
 #include "Delay.h" // 我们需要用到微秒和毫秒的延时函数
+#include "OLED.h"
+#include "Format.h"
+#include "RangeFilter.h"
+#include <stddef.h>
+#include "stm32f10x_exti.h"
+#include "Profile.h"
 
 static uint32_t debug_timeout_count = 0;
 static uint32_t debug_echo_high_time = 0;
 
+// 后台测距状态（PA4/PA5不是定时器通道，触发脉冲由1ms节拍产生，回波边沿用EXTI打时间戳）
+typedef enum {
+    RANGE_STOPPED = 0,  // 未启动后台测距，Ultrasonic_GetDistance走阻塞测量
+    RANGE_IDLE,         // 等待下一个测距周期
+    RANGE_TRIGGER,      // Trig为高，下一个节拍拉低
+    RANGE_WAIT_ECHO,    // 等回波上升沿
+    RANGE_ECHO_HIGH     // 等回波下降沿
+} RangeState;
+
+typedef struct {
+    float threshold;
+    UltrasonicThresholdCallback callback;
+    uint8_t below;
+} RangeThreshold;
+
+static volatile RangeState range_state = RANGE_STOPPED;
+static volatile uint16_t range_timer = 0;      // 距上次触发的毫秒数
+static volatile uint32_t echo_start_us = 0;
+static volatile UltrasonicSample range_cache = {0, 0, 0, 0, 0};
+static RangeFilter range_filter;
+
+static RangeThreshold thresholds[ULTRASONIC_MAX_THRESHOLDS];
+static uint8_t threshold_count = 0;
+
 /**
   * @brief  超声波模块初始化
   * @param  无
@@ -33,10 +63,197 @@ void Ultrasonic_Init(void)
     GPIO_ResetBits(TRIG_GPIO_PORT, TRIG_GPIO_PIN);
 }
 
+/**
+  * @brief  一次测量结束后送入滤波器，更新缓存并检查阈值（在中断中调用）
+  * @param  raw: 原始距离(cm)，<=0表示回波丢失或超量程
+  * @retval 无
+  */
+static void Ultrasonic_Publish(float raw)
+{
+    RangeEstimate est;
+    float filtered;
+    uint8_t i;
+
+    RangeFilter_Update(&range_filter, (raw > 0) ? (int32_t)(raw * 10) : -1, Delay_GetTick());
+    RangeFilter_Get(&range_filter, &est);
+    if(est.status == RANGE_FILTER_NONE) return;
+
+    // 丢失或被门限拒绝时距离和时间戳不变，只更新方差和置信度
+    range_cache.variance = est.variance;
+    range_cache.confidence = est.confidence;
+    if(est.status != RANGE_FILTER_OK) return;
+
+    filtered = est.distance_mm / 10.0f;
+    range_cache.distance = filtered;
+    range_cache.timestamp = Delay_GetTick();
+    range_cache.valid = 1;
+
+    for(i = 0; i < threshold_count; i++) {
+        if(!thresholds[i].below && filtered < thresholds[i].threshold) {
+            thresholds[i].below = 1;
+            thresholds[i].callback(filtered, 1);
+        } else if(thresholds[i].below && filtered > thresholds[i].threshold + ULTRASONIC_HYSTERESIS_CM) {
+            thresholds[i].below = 0;
+            thresholds[i].callback(filtered, 0);
+        }
+    }
+}
+
+// 1ms节拍回调：按固定周期发出Trig脉冲，并处理回波超时
+static void Ultrasonic_TickHook(void)
+{
+    uint8_t timed_out;
+
+    range_timer++;
+    switch(range_state) {
+        case RANGE_IDLE:
+            if(range_timer >= ULTRASONIC_PERIOD_MS) {
+                range_timer = 0;
+                GPIO_SetBits(TRIG_GPIO_PORT, TRIG_GPIO_PIN); // 保持一个节拍(1ms)，远大于要求的10us
+                range_state = RANGE_TRIGGER;
+            }
+            break;
+
+        case RANGE_TRIGGER:
+            GPIO_ResetBits(TRIG_GPIO_PORT, TRIG_GPIO_PIN);
+            range_state = RANGE_WAIT_ECHO;
+            break;
+
+        case RANGE_WAIT_ECHO:
+        case RANGE_ECHO_HIGH:
+            if(range_timer > ULTRASONIC_ECHO_TIMEOUT_MS + 1) {
+                // 先结束本次测量再送滤波器：SysTick优先级最低，迟到的下降沿随时会打断这里。
+                // 检查和改成IDLE在关中断下完成，回波中断要么已经发布过（这里不再发布），
+                // 要么看到IDLE不再调用Publish，同一次测量只发布一次，滤波器不会被重入
+                __disable_irq();
+                timed_out = (range_state == RANGE_WAIT_ECHO || range_state == RANGE_ECHO_HIGH);
+                if(timed_out) range_state = RANGE_IDLE;
+                __enable_irq();
+                if(timed_out) {
+                    debug_timeout_count++;
+                    Ultrasonic_Publish(-1);
+                }
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+/**
+  * @brief  启动后台连续测距
+  * @param  无
+  * @retval 无
+  * @detail 每ULTRASONIC_PERIOD_MS测一次，结果写入缓存；需先调用Delay_Init启动系统节拍
+  */
+void Ultrasonic_StartRanging(void)
+{
+    EXTI_InitTypeDef EXTI_InitStructure;
+    NVIC_InitTypeDef NVIC_InitStructure;
+
+    if(range_state != RANGE_STOPPED) return;
+
+    RCC_APB2PeriphClockCmd(RCC_APB2Periph_AFIO, ENABLE);
+    GPIO_EXTILineConfig(ECHO_EXTI_PORT_SOURCE, ECHO_EXTI_PIN_SOURCE);
+
+    EXTI_InitStructure.EXTI_Line = ECHO_EXTI_LINE;
+    EXTI_InitStructure.EXTI_Mode = EXTI_Mode_Interrupt;
+    EXTI_InitStructure.EXTI_Trigger = EXTI_Trigger_Rising_Falling;
+    EXTI_InitStructure.EXTI_LineCmd = ENABLE;
+    EXTI_Init(&EXTI_InitStructure);
+
+    NVIC_InitStructure.NVIC_IRQChannel = ECHO_EXTI_IRQn;
+    NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 0; // 回波计时要准，可抢占舵机帧等其它中断（分组见Boot_Start）
+    NVIC_InitStructure.NVIC_IRQChannelSubPriority = 0;
+    NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+    NVIC_Init(&NVIC_InitStructure);
+
+    RangeFilter_Init(&range_filter, NULL);
+    range_timer = 0;
+    range_state = RANGE_IDLE;
+    Delay_AddTickHook(Ultrasonic_TickHook);
+}
+
+/**
+  * @brief  读取测距缓存
+  * @param  无
+  * @retval 最近一次滤波后的距离；超过ULTRASONIC_STALE_MS没有更新时valid为0
+  */
+UltrasonicSample Ultrasonic_GetSample(void)
+{
+    UltrasonicSample sample;
+
+    __disable_irq();
+    sample.distance = range_cache.distance;
+    sample.timestamp = range_cache.timestamp;
+    sample.variance = range_cache.variance;
+    sample.confidence = range_cache.confidence;
+    sample.valid = range_cache.valid;
+    __enable_irq();
+
+    if(Delay_GetTick() - sample.timestamp > ULTRASONIC_STALE_MS) {
+        sample.valid = 0;
+        sample.confidence = 0;
+    }
+    return sample;
+}
+
+/**
+  * @brief  缓存中距离值的年龄
+  * @param  无
+  * @retval 距最近一次成功测量的毫秒数
+  */
+uint32_t Ultrasonic_GetAge(void)
+{
+    return Delay_GetTick() - range_cache.timestamp;
+}
+
+/**
+  * @brief  注册距离阈值回调
+  * @param  threshold_cm: 阈值(cm)
+  * @param  callback: 穿越阈值时调用（中断上下文）
+  * @retval 1成功，0表示阈值已满
+  */
+uint8_t Ultrasonic_AddThreshold(float threshold_cm, UltrasonicThresholdCallback callback)
+{
+    if(threshold_count >= ULTRASONIC_MAX_THRESHOLDS) return 0;
+    thresholds[threshold_count].threshold = threshold_cm;
+    thresholds[threshold_count].callback = callback;
+    thresholds[threshold_count].below = 0;
+    threshold_count++;
+    return 1;
+}
+
+/**
+  * @brief  Echo引脚边沿中断：上升沿记录起始时间，下降沿计算距离
+  */
+void EXTI9_5_IRQHandler(void)
+{
+    uint32_t now;
+    PROFILE_BEGIN(PROFILE_ULTRASONIC_ECHO);
+
+    if(EXTI_GetITStatus(ECHO_EXTI_LINE) != RESET) {
+        now = Delay_GetUs();
+        if(GPIO_ReadInputDataBit(ECHO_GPIO_PORT, ECHO_GPIO_PIN)) {
+            if(range_state == RANGE_WAIT_ECHO) {
+                echo_start_us = now;
+                range_state = RANGE_ECHO_HIGH;
+            }
+        } else if(range_state == RANGE_ECHO_HIGH) {
+            debug_echo_high_time = now - echo_start_us;
+            Ultrasonic_Publish(debug_echo_high_time / 58.0f); // 声波往返，1cm约58us
+            range_state = RANGE_IDLE;
+        }
+        EXTI_ClearITPendingBit(ECHO_EXTI_LINE);
+    }
+    PROFILE_END(PROFILE_ULTRASONIC_ECHO);
+}
+
 /**
   * @brief  获取超声波测距结果
   * @param  无
-  * @retval 距离值，单位：厘米 (cm)
+  * @retval 距离值，单位：厘米 (cm)；后台测距已启动时直接返回缓存，失效时返回-1
   */
 float Ultrasonic_GetDistance(void)
 {
@@ -44,6 +261,11 @@ float Ultrasonic_GetDistance(void)
     uint32_t time_high = 0;
     float distance_cm = 0;
     
+    if(range_state != RANGE_STOPPED) {
+        UltrasonicSample sample = Ultrasonic_GetSample();
+        return sample.valid ? sample.distance : -1;
+    }
+    
     // 调试：记录超时次数
     debug_timeout_count++;
     
@@ -88,9 +310,9 @@ void Ultrasonic_Debug_Info(void)
     
     // 在OLED上显示调试信息
     OLED_ShowString(2, 1, "Debug:          ");
-    sprintf(debug_msg, "Tout:%lu", debug_timeout_count);
+    Format_UInt(debug_msg + Format_Str(debug_msg, "Tout:"), debug_timeout_count, 0, ' ');
     OLED_ShowString(3, 1, debug_msg);
     
-    sprintf(debug_msg, "Time:%lu", debug_echo_high_time);
+    Format_UInt(debug_msg + Format_Str(debug_msg, "Time:"), debug_echo_high_time, 0, ' ');
     OLED_ShowString(4, 1, debug_msg);
 }
\ No newline at end of file
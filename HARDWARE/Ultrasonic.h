@@ -8,13 +8,44 @@
 #define TRIG_GPIO_PIN     GPIO_Pin_4
 #define TRIG_RCC_CLOCK    RCC_APB2Periph_GPIOA
 
-#define ECHO_GPIO_PORT    GPIOA  
+#define ECHO_GPIO_PORT    GPIOA
 #define ECHO_GPIO_PIN     GPIO_Pin_5
 #define ECHO_RCC_CLOCK    RCC_APB2Periph_GPIOA
 
+// Echo引脚的外部中断（PA5 -> EXTI5，与EXTI6~9共用中断向量）
+#define ECHO_EXTI_PORT_SOURCE   GPIO_PortSourceGPIOA
+#define ECHO_EXTI_PIN_SOURCE    GPIO_PinSource5
+#define ECHO_EXTI_LINE          EXTI_Line5
+#define ECHO_EXTI_IRQn          EXTI9_5_IRQn
+
+// 后台连续测距参数
+#define ULTRASONIC_PERIOD_MS        60   // 测距周期，HC-SR04建议不小于60ms
+#define ULTRASONIC_ECHO_TIMEOUT_MS  40   // 超过这个时间没有回波下降沿视为丢失（无障碍时模块输出约38ms）
+#define ULTRASONIC_STALE_MS         200  // 缓存超过这个时间视为过期
+#define ULTRASONIC_MAX_THRESHOLDS   2
+#define ULTRASONIC_HYSTERESIS_CM    2.0f // 阈值回差，防止在阈值附近反复触发
+#define ULTRASONIC_MIN_CONFIDENCE   50   // 置信度低于这个值时不能当作"前方安全"
+
+// 测距缓存：最近一次滤波后的距离（滤波见RangeFilter）
+typedef struct {
+    float distance;      // 厘米，回波丢失时保持最后的估计值，从未测到过时为0
+    uint32_t timestamp;  // 最近一次被接受的采样时刻，Delay_GetTick()的毫秒数
+    uint32_t variance;   // 估计方差(mm^2)，回波丢失时增大
+    uint8_t confidence;  // 置信度0~100
+    uint8_t valid;       // 有估计值且未过期
+} UltrasonicSample;
+
+// 阈值回调：below=1表示距离刚降到阈值以下，0表示刚回到阈值+回差以上
+// 在中断中调用，必须很短（一般只置标志）
+typedef void (*UltrasonicThresholdCallback)(float distance, uint8_t below);
+
 // 函数声明
 void Ultrasonic_Init(void);        // 初始化函数
+void Ultrasonic_StartRanging(void); // 启动后台连续测距（需先调用Delay_Init）
 float Ultrasonic_GetDistance(void); // 获取距离函数，返回单位是厘米
+UltrasonicSample Ultrasonic_GetSample(void); // 读取测距缓存，不等待
+uint32_t Ultrasonic_GetAge(void);   // 缓存距今的毫秒数
+uint8_t Ultrasonic_AddThreshold(float threshold_cm, UltrasonicThresholdCallback callback);
 void Ultrasonic_Debug_Info(void);
 
 #endif
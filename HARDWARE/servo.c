@@ -1,26 +1,42 @@
 // servo.c
 #include "stm32f10x.h"
 #include "PWM.h" // 引用我们底层的PWM驱动
+#include "Delay.h"
+#include "Servo.h"
+#include "stddef.h"
+#include <math.h>
 
-/**
-  * @brief  舵机初始化
-  * @param  无
-  * @retval 无
-  */
-void Servo_Init(void)
-{
-	PWM_Init(); // 底层PWM初始化，一次即可
-}
+// 每帧的时间单位换算：度/秒 -> 度/帧，度/秒^2 -> 度/帧^2
+#define SERVO_PER_FRAME(x)    ((x) / (float)PWM_FRAME_HZ)
+#define SERVO_PER_FRAME2(x)   ((x) / (float)(PWM_FRAME_HZ * PWM_FRAME_HZ))
+
+static volatile float Servo_Command[SERVO_NUM + 1];  // 上层设定的角度，索引0不用，Servo_Init置为90度
+static volatile float Servo_Offset[SERVO_NUM + 1];   // 姿态等闭环修正量
+static volatile float Servo_Output[SERVO_NUM + 1];   // 限速之后实际输出的角度
+static float Servo_Velocity[SERVO_NUM + 1];          // 输出角度的速度(度/帧)
+static float Servo_MaxSpeed[SERVO_NUM + 1];          // 速度上限(度/帧)，0表示不限速
+static float Servo_MaxAccel[SERVO_NUM + 1];          // 加速度上限(度/帧^2)
+static volatile uint32_t Servo_LimitCount[SERVO_NUM + 1]; // 限速起作用（输出明显落后于目标）的帧数
+static uint16_t Servo_HoldTimeout[SERVO_NUM + 1];    // 保持超时(帧)，0表示一直保持力矩
+static uint16_t Servo_HoldFrames[SERVO_NUM + 1];     // 输出没有变化的帧数
+static float Servo_HoldRef[SERVO_NUM + 1];           // 上一次有动作时的输出角度
+static volatile uint16_t Servo_HeldMask = 0;         // 已超时停发脉冲的舵机，bit(id-1)
+static volatile uint32_t Servo_HeldFrames = 0;       // 累计停发的舵机·帧数
+static uint16_t Servo_Pulse[SERVO_NUM + 1];          // 已写入比较寄存器的脉宽，相同就不再写
+static volatile uint32_t Servo_CacheHits = 0;        // 与上次相同被跳过的写入
+static volatile uint32_t Servo_CacheMisses = 0;      // 实际执行的写入
+static void (*Servo_FrameHooks[SERVO_FRAME_HOOK_MAX])(void);
+static uint8_t Servo_FrameHookCount = 0;
+static volatile uint8_t Servo_OutputEnabled = 1;
 
 /**
-  * @brief  设定指定舵机的角度
-  * @param  id: 你想控制的舵机编号，范围 [1, 4]
-  * @param  Angle: 你期望的角度，范围 [0, 180]
-  * @retval 无
+  * @brief  目标角度：设定角度加修正量，再按机械范围限幅
+  * @param  id: 舵机编号 [1, SERVO_NUM]
+  * @retval 角度
   */
-void Servo_SetAngle(uint8_t id, float Angle)
+static float Servo_Target(uint8_t id)
 {
-    uint16_t pulse;
+    float Angle = Servo_Command[id] + Servo_Offset[id];
     
     // 放宽角度限制，特别是舵机4
     if(Angle < 30) Angle = 30;
@@ -31,19 +47,289 @@ void Servo_SetAngle(uint8_t id, float Angle)
         if(Angle < 40) Angle = 40;
         if(Angle > 140) Angle = 140;
     }
-    
-    pulse = (uint16_t)(Angle / 180.0f * 2000.0f + 500.0f);
+    return Angle;
+}
+
+/**
+  * @brief  把输出角度写入PWM比较寄存器
+  * @param  id: 舵机编号 [1, SERVO_NUM]
+  * @retval 无
+  */
+static void Servo_Write(uint8_t id)
+{
+    uint16_t pulse = (uint16_t)(Servo_Output[id] / 180.0f * 2000.0f + 500.0f);
     
     if(pulse < 500) pulse = 500;
     if(pulse > 2500) pulse = 2500;
+    // 保持超时：比较值写0，引脚整个周期保持低电平。比较值有预装载，正在输出的脉冲不会被截断
+    if(Servo_HeldMask & (1 << (id - 1))) pulse = 0;
     
-    switch(id) {
-        case 1: PWM_SetCompare1(pulse); break;
-        case 2: PWM_SetCompare2(pulse); break;
-        case 3: PWM_SetCompare3(pulse); break;
-        case 4: PWM_SetCompare4(pulse); break;
+    if(pulse == Servo_Pulse[id]) {
+        Servo_CacheHits++;
+        return;
     }
-    
-    // 添加小延时，减少电流冲击
-    Delay_ms(2);
+    Servo_Pulse[id] = pulse;
+    Servo_CacheMisses++;
+    PWM_SetCompare(id - 1, pulse);
+}
+
+/**
+  * @brief  限速：输出角度按速度和加速度上限逐帧追赶目标角度（帧中断中调用）
+  * @param  id: 舵机编号 [1, SERVO_NUM]
+  * @retval 无
+  * @detail 朝目标的速度v满足v + (v-a) + (v-2a) + ... <= 剩余距离，即逐帧减速刚好停在目标上；
+  *         每帧速度变化不超过加速度上限a。跟随插值轨迹这类缓慢移动的目标时只差零点几度，
+  *         不计入限速次数，只有落后超过一帧加速度的量才计数
+  */
+static void Servo_Slew(uint8_t id)
+{
+    float err = Servo_Target(id) - Servo_Output[id];
+    float dist = (err >= 0) ? err : -err;
+    float sign = (err >= 0) ? 1.0f : -1.0f;
+    float v, vmax;
+
+    if(Servo_MaxSpeed[id] <= 0) {
+        Servo_Output[id] += err;
+        Servo_Velocity[id] = 0;
+        return;
+    }
+    if(err == 0 && Servo_Velocity[id] == 0) return; // 静止在目标上，省掉开方
+    v = Servo_Velocity[id] * sign; // 朝向目标为正
+    vmax = Servo_MaxAccel[id] * (sqrtf(0.25f + 2.0f * dist / Servo_MaxAccel[id]) - 0.5f);
+    if(vmax > Servo_MaxSpeed[id]) vmax = Servo_MaxSpeed[id];
+    if(vmax > v + Servo_MaxAccel[id]) vmax = v + Servo_MaxAccel[id];
+    else if(vmax < v - Servo_MaxAccel[id]) vmax = v - Servo_MaxAccel[id];
+    if(vmax >= dist) {
+        vmax = dist; // 本帧到达目标
+    } else if(dist - vmax > Servo_MaxAccel[id]) {
+        Servo_LimitCount[id]++;
+    }
+    Servo_Output[id] += vmax * sign;
+    Servo_Velocity[id] = vmax * sign;
+}
+
+/**
+  * @brief  保持超时：输出角度连续一段时间没有变化就停发脉冲，舵机卸力省电（帧中断中调用）
+  * @param  id: 舵机编号 [1, SERVO_NUM]
+  * @retval 无
+  * @detail 输出偏离上次动作时的角度超过SERVO_HOLD_DEADBAND才算有动作，姿态闭环的小修正不会一直唤醒；
+  *         有动作的这一帧就恢复脉冲，比较值在下一个周期生效
+  */
+static void Servo_Hold(uint8_t id)
+{
+    uint16_t bit = 1 << (id - 1);
+    float d = Servo_Output[id] - Servo_HoldRef[id];
+
+    if(d > SERVO_HOLD_DEADBAND || d < -SERVO_HOLD_DEADBAND || Servo_HoldTimeout[id] == 0) {
+        Servo_HoldRef[id] = Servo_Output[id];
+        Servo_HoldFrames[id] = 0;
+        Servo_HeldMask &= ~bit;
+        return;
+    }
+    if(Servo_HoldFrames[id] < Servo_HoldTimeout[id]) {
+        Servo_HoldFrames[id]++;
+        return;
+    }
+    Servo_HeldMask |= bit;
+    if(Servo_OutputEnabled) Servo_HeldFrames++;
+}
+
+// 每个PWM周期开始时调用：先让闭环算修正量，再按限速刷新全部舵机
+static void Servo_Frame(void)
+{
+    uint8_t id;
+    for(id = 0; id < Servo_FrameHookCount; id++) {
+        Servo_FrameHooks[id]();
+    }
+    for(id = 1; id <= SERVO_NUM; id++) {
+        Servo_Slew(id);
+        Servo_Hold(id);
+        Servo_Write(id);
+    }
+}
+
+/**
+  * @brief  舵机初始化
+  * @param  无
+  * @retval 无
+  */
+void Servo_Init(void)
+{
+	uint8_t id;
+	for(id = 1; id <= SERVO_NUM; id++) {
+		Servo_Command[id] = 90;
+		Servo_Output[id] = 90;
+		Servo_Velocity[id] = 0;
+		Servo_Pulse[id] = 0xFFFF; // 第一帧一定写入
+		Servo_SetSlewLimit(id, SERVO_SLEW_SPEED_DEFAULT, SERVO_SLEW_ACCEL_DEFAULT);
+	}
+	PWM_Init(); // 底层PWM初始化，一次即可
+	PWM_SetFrameCallback(Servo_Frame);
+}
+
+/**
+  * @brief  设定指定舵机的角度
+  * @param  id: 你想控制的舵机编号，范围 [1, SERVO_NUM]
+  * @param  Angle: 你期望的角度，范围 [0, 180]
+  * @retval 无
+  * @detail 限速时只改设定角度，由下一帧按速度/加速度上限输出，不阻塞
+  */
+void Servo_SetAngle(uint8_t id, float Angle)
+{
+    if(id < 1 || id > SERVO_NUM) return;
+    if(Servo_Command[id] == Angle) {
+        Servo_CacheHits++; // 重复的姿态命令：不写寄存器也不延时
+        return;
+    }
+    Servo_Command[id] = Angle;
+    if(Servo_MaxSpeed[id] <= 0) {
+        Servo_Output[id] = Servo_Target(id);
+        Servo_Write(id); // 不限速时立即写入，不等下一帧
+        Delay_ms(2); // 几个舵机同时全速起动时错开2ms，减少电流冲击；限速时由帧中断逐帧加速，不需要
+    }
+}
+
+/**
+  * @brief  只修改设定角度，不立即写入也不延时，下一帧生效（可在帧回调中调用）
+  * @param  id: 舵机编号 [1, SERVO_NUM]
+  * @param  Angle: 角度 [0, 180]
+  * @retval 无
+  */
+void Servo_SetCommand(uint8_t id, float Angle)
+{
+    if(id < 1 || id > SERVO_NUM) return;
+    Servo_Command[id] = Angle;
+}
+
+float Servo_GetAngle(uint8_t id)
+{
+    if(id < 1 || id > SERVO_NUM) return 0;
+    return Servo_Command[id];
+}
+
+/**
+  * @brief  当前实际输出的角度（经过限幅和限速，含修正量）
+  * @param  id: 舵机编号 [1, SERVO_NUM]
+  * @retval 角度
+  */
+float Servo_GetOutput(uint8_t id)
+{
+    if(id < 1 || id > SERVO_NUM) return 0;
+    return Servo_Output[id];
+}
+
+/**
+  * @brief  设置舵机的速度和加速度上限
+  * @param  id: 舵机编号 [1, SERVO_NUM]
+  * @param  Speed: 最大速度(度/秒)，0表示不限速，设定角度直接输出
+  * @param  Accel: 最大加速度(度/秒^2)，0表示只限速度
+  * @retval 无
+  */
+void Servo_SetSlewLimit(uint8_t id, float Speed, float Accel)
+{
+    if(id < 1 || id > SERVO_NUM) return;
+    __disable_irq();
+    Servo_MaxSpeed[id] = SERVO_PER_FRAME(Speed);
+    Servo_MaxAccel[id] = (Accel > 0) ? SERVO_PER_FRAME2(Accel) : Servo_MaxSpeed[id]; // 一帧加到最高速
+    __enable_irq();
+}
+
+/**
+  * @brief  限速起作用的帧数：目标跳变太大，输出落后超过一帧的加速度
+  * @param  id: 舵机编号 [1, SERVO_NUM]，0表示全部舵机之和
+  * @retval 帧数
+  */
+uint32_t Servo_GetLimitCount(uint8_t id)
+{
+    uint32_t sum = 0;
+    if(id > SERVO_NUM) return 0;
+    if(id) return Servo_LimitCount[id];
+    for(id = 1; id <= SERVO_NUM; id++) {
+        sum += Servo_LimitCount[id];
+    }
+    return sum;
+}
+
+void Servo_ResetLimitCount(void)
+{
+    uint8_t id;
+    for(id = 1; id <= SERVO_NUM; id++) {
+        Servo_LimitCount[id] = 0;
+    }
+}
+
+/**
+  * @brief  设置保持超时：舵机停在同一角度超过这个时间就停发脉冲，再次动作时自动恢复
+  * @param  id: 舵机编号 [1, SERVO_NUM]，0表示全部舵机
+  * @param  TimeoutMs: 超时(ms)，0表示一直保持力矩（并立即恢复已停发的舵机）
+  * @retval 无
+  * @detail 停发后舵机不再出力，站姿会在自重下慢慢下沉，恢复时舵机从下沉的位置转回目标角度
+  */
+void Servo_SetHoldTimeout(uint8_t id, uint16_t TimeoutMs)
+{
+    uint32_t frames = (uint32_t)TimeoutMs * PWM_FRAME_HZ / 1000;
+    uint8_t i;
+
+    if(frames > 0xFFFF) frames = 0xFFFF;
+    for(i = 1; i <= SERVO_NUM; i++) {
+        if(id == 0 || id == i) Servo_HoldTimeout[i] = (uint16_t)frames; // 下一帧由Servo_Hold处理
+    }
+}
+
+uint16_t Servo_GetHeldMask(void)
+{
+    return Servo_HeldMask;
+}
+
+/**
+  * @brief  累计停发脉冲的时间，用于估算省下的电量
+  * @param  无
+  * @retval 舵机·毫秒，例如4个舵机同时停发1秒记4000
+  */
+uint32_t Servo_GetHeldMs(void)
+{
+    return Servo_HeldFrames * (1000 / PWM_FRAME_HZ);
+}
+
+/**
+  * @brief  写入缓存的命中/未命中次数（重复的角度命令和每帧刷新中没有变化的通道都算命中）
+  * @param  Hits: 输出命中次数，可为NULL
+  * @param  Misses: 输出实际写入次数，可为NULL
+  * @retval 无
+  */
+void Servo_GetCacheStats(uint32_t *Hits, uint32_t *Misses)
+{
+    if(Hits != NULL) *Hits = Servo_CacheHits;
+    if(Misses != NULL) *Misses = Servo_CacheMisses;
+}
+
+void Servo_SetOffset(uint8_t id, float Offset)
+{
+    if(id < 1 || id > SERVO_NUM) return;
+    Servo_Offset[id] = Offset;
+}
+
+uint8_t Servo_AddFrameHook(void (*Hook)(void))
+{
+    if(Servo_FrameHookCount >= SERVO_FRAME_HOOK_MAX) return 0;
+    Servo_FrameHooks[Servo_FrameHookCount] = Hook;
+    Servo_FrameHookCount++;
+    return 1;
+}
+
+/**
+  * @brief  打开/关闭全部舵机PWM输出
+  * @param  Enable: 0关闭（舵机失去保持力矩），1恢复
+  * @retval 无
+  * @detail 只关闭定时器通道输出(CCxE)，比较值照常更新，恢复后立即按当前设定角度输出
+  */
+void Servo_SetOutputEnable(uint8_t Enable)
+{
+    Servo_OutputEnabled = Enable;
+    PWM_OutputEnable(Enable);
+}
+
+uint8_t Servo_IsOutputEnabled(void)
+{
+    return Servo_OutputEnabled;
 }
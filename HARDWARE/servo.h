@@ -1,7 +1,36 @@
 #ifndef __SERVO_H
 #define __SERVO_H
 
+#include "PWM.h"
+
+#define SERVO_NUM   PWM_CHANNEL_NUM   // 舵机编号1 ~ SERVO_NUM
+
+// 限速：每帧输出角度按速度和加速度上限追赶设定角度，大跳变不会瞬间加到舵机上
+// 默认值约为舵机空载速度(0.1s/60度)，插值轨迹和步态的正常速度不受影响
+#define SERVO_SLEW_SPEED_DEFAULT    600.0f    // 度/秒
+#define SERVO_SLEW_ACCEL_DEFAULT    7200.0f   // 度/秒^2，从静止到最高速约80ms
+
+// 保持超时：输出角度长时间不变的舵机停发脉冲（引脚保持低电平），舵机卸力，有新动作时下一帧恢复
+// 默认关闭，由待机模式打开；变化小于SERVO_HOLD_DEADBAND不算动作
+#define SERVO_HOLD_DEADBAND         1.0f      // 度
+
 void Servo_Init(void);
 void Servo_SetAngle(uint8_t id, float Angle);
+void Servo_SetCommand(uint8_t id, float Angle);    // 不延时，下一帧生效，供帧回调使用
+float Servo_GetAngle(uint8_t id);                  // 上层设定的角度（不含修正量）
+float Servo_GetOutput(uint8_t id);                 // 实际输出的角度（含修正量，经过限幅和限速）
+void Servo_SetSlewLimit(uint8_t id, float Speed, float Accel); // 度/秒、度/秒^2，Speed为0不限速
+uint32_t Servo_GetLimitCount(uint8_t id);          // 限速起作用的帧数，id为0时返回全部之和
+void Servo_ResetLimitCount(void);
+void Servo_SetHoldTimeout(uint8_t id, uint16_t TimeoutMs); // id为0表示全部；TimeoutMs为0表示一直保持力矩
+uint16_t Servo_GetHeldMask(void);                  // 已停发脉冲的舵机，bit(id-1)
+uint32_t Servo_GetHeldMs(void);                    // 累计停发时间(舵机·毫秒)
+void Servo_GetCacheStats(uint32_t *Hits, uint32_t *Misses); // 跳过的重复写入/实际写入次数
+void Servo_SetOffset(uint8_t id, float Offset);    // 叠加在设定角度上的修正量，下一帧生效
+#define SERVO_FRAME_HOOK_MAX   4
+
+uint8_t Servo_AddFrameHook(void (*Hook)(void));    // 每帧(50Hz)在写入舵机之前调用，在中断中执行；返回0表示已满
+void Servo_SetOutputEnable(uint8_t Enable);        // 0：停止输出PWM脉冲，舵机卸力
+uint8_t Servo_IsOutputEnabled(void);
 
 #endif
@@ -1,4 +1,68 @@
 #include "stm32f10x.h"
+#include "Delay.h"
+
+static volatile uint32_t Delay_Tick = 0;	//Delay_Init之后的毫秒计数
+static void (*Delay_TickHooks[DELAY_TICK_HOOK_MAX])(void);
+static uint8_t Delay_TickHookCount = 0;
+
+/**
+  * @brief  启动1ms系统节拍（SysTick中断），之后Delay_us改为读取SysTick->VAL计时，不再独占SysTick
+  * @param  无
+  * @retval 无
+  */
+void Delay_Init(void)
+{
+	Delay_Tick = 0;
+	SysTick_Config(SystemCoreClock / 1000);
+}
+
+/**
+  * @brief  获取系统节拍
+  * @param  无
+  * @retval Delay_Init之后经过的毫秒数，未初始化时恒为0
+  */
+uint32_t Delay_GetTick(void)
+{
+	return Delay_Tick;
+}
+
+/**
+  * @brief  获取微秒时间戳，可在中断中调用（用于测量脉宽等）
+  * @param  无
+  * @retval Delay_Init之后经过的微秒数，约71分钟回绕一次
+  */
+uint32_t Delay_GetUs(void)
+{
+	uint32_t Ms, Val, Pending;
+	do
+	{
+		Ms = Delay_Tick;
+		Val = SysTick->VAL;
+		Pending = SCB->ICSR & SCB_ICSR_PENDSTSET_Msk;
+	} while (Ms != Delay_Tick);
+	//在更高优先级中断里读取时，SysTick中断可能已挂起但计数还没加上
+	if (Pending && Val > SysTick->LOAD / 2)
+	{
+		Ms++;
+	}
+	return Ms * 1000 + (SysTick->LOAD + 1 - Val) / 72;
+}
+
+/**
+  * @brief  注册1ms节拍回调，在SysTick中断里执行，必须很短且不能调用Delay_ms
+  * @param  Hook 回调函数
+  * @retval 1成功，0表示回调已满
+  */
+uint8_t Delay_AddTickHook(void (*Hook)(void))
+{
+	if (Delay_TickHookCount >= DELAY_TICK_HOOK_MAX)
+	{
+		return 0;
+	}
+	Delay_TickHooks[Delay_TickHookCount] = Hook;
+	Delay_TickHookCount++;
+	return 1;
+}
 
 /**
   * @brief  微秒级延时
@@ -7,11 +71,31 @@
   */
 void Delay_us(uint32_t xus)
 {
-	SysTick->LOAD = 72 * xus;				//设置定时器重装值
-	SysTick->VAL = 0x00;					//清空当前计数值
-	SysTick->CTRL = 0x00000005;				//设置时钟源为HCLK，启动定时器
-	while(!(SysTick->CTRL & 0x00010000));	//等待计数到0
-	SysTick->CTRL = 0x00000004;				//关闭定时器
+	uint32_t Reload, Ticks, Old, Now, Count = 0;
+
+	if (!(SysTick->CTRL & SysTick_CTRL_TICKINT_Msk))
+	{
+		SysTick->LOAD = 72 * xus;				//设置定时器重装值
+		SysTick->VAL = 0x00;					//清空当前计数值
+		SysTick->CTRL = 0x00000005;				//设置时钟源为HCLK，启动定时器
+		while(!(SysTick->CTRL & 0x00010000));	//等待计数到0
+		SysTick->CTRL = 0x00000004;				//关闭定时器
+		return;
+	}
+
+	//节拍已运行：累计VAL的递减量，不改动SysTick配置
+	Reload = SysTick->LOAD + 1;
+	Ticks = 72 * xus;
+	Old = SysTick->VAL;
+	while (Count < Ticks)
+	{
+		Now = SysTick->VAL;
+		if (Now != Old)
+		{
+			Count += (Now < Old) ? (Old - Now) : (Reload - Now + Old);
+			Old = Now;
+		}
+	}
 }
 
 /**
@@ -26,7 +110,7 @@ void Delay_ms(uint32_t xms)
 		Delay_us(1000);
 	}
 }
- 
+
 /**
   * @brief  秒级延时
   * @param  xs 延时时长，范围：0~4294967295
@@ -38,4 +122,17 @@ void Delay_s(uint32_t xs)
 	{
 		Delay_ms(1000);
 	}
-} 
+}
+
+/**
+  * @brief  SysTick中断，1ms一次
+  */
+void SysTick_Handler(void)
+{
+	uint8_t i;
+	Delay_Tick++;
+	for (i = 0; i < Delay_TickHookCount; i++)
+	{
+		Delay_TickHooks[i]();
+	}
+}
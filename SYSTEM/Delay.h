@@ -1,6 +1,12 @@
 #ifndef __DELAY_H
 #define __DELAY_H
 
+#define DELAY_TICK_HOOK_MAX	4		//1ms节拍回调的最大个数
+
+void Delay_Init(void);
+uint32_t Delay_GetTick(void);
+uint32_t Delay_GetUs(void);
+uint8_t Delay_AddTickHook(void (*Hook)(void));
 void Delay_us(uint32_t us);
 void Delay_ms(uint32_t ms);
 void Delay_s(uint32_t s);
@@ -0,0 +1,111 @@
+#include "stm32f10x.h"                  // Device header
+#include "Delay.h"
+#include "EventBus.h"
+
+typedef struct
+{
+	uint16_t Mask;
+	EventHandler Handler;
+} EventSubscriber;
+
+static EventSubscriber EventBus_Subscribers[EVENT_BUS_MAX_SUBSCRIBERS];
+static uint8_t EventBus_SubscriberCount = 0;
+
+static BusEvent EventBus_Queue[EVENT_BUS_QUEUE_SIZE];
+static volatile uint8_t EventBus_Head = 0;
+static volatile uint8_t EventBus_Tail = 0;
+static volatile uint32_t EventBus_Dropped = 0;
+static uint8_t EventBus_Dispatching = 0;
+
+/**
+  * @brief  订阅事件
+  * @param  Mask 关心的事件类型，EVENT_MASK(type)按位或
+  * @param  Handler 回调，在主循环上下文里执行
+  * @retval 1成功，0订阅者已满
+  */
+uint8_t EventBus_Subscribe(uint16_t Mask, EventHandler Handler)
+{
+	if (EventBus_SubscriberCount >= EVENT_BUS_MAX_SUBSCRIBERS)
+	{
+		return 0;
+	}
+	EventBus_Subscribers[EventBus_SubscriberCount].Mask = Mask;
+	EventBus_Subscribers[EventBus_SubscriberCount].Handler = Handler;
+	EventBus_SubscriberCount++;
+	return 1;
+}
+
+/**
+  * @brief  发布事件，可在中断中调用
+  * @param  Type EventType
+  * @param  Source 发布者定义的来源编号
+  * @param  Arg 参数，含义见EventType
+  * @retval 1成功，0缓冲区已满（事件丢弃）
+  */
+uint8_t EventBus_Publish(uint8_t Type, uint8_t Source, uint16_t Arg)
+{
+	uint32_t primask = __get_PRIMASK();
+	uint8_t next, ok = 0;
+
+	__disable_irq();
+	next = (EventBus_Head + 1) % EVENT_BUS_QUEUE_SIZE;
+	if (next != EventBus_Tail)
+	{
+		EventBus_Queue[EventBus_Head].type = Type;
+		EventBus_Queue[EventBus_Head].source = Source;
+		EventBus_Queue[EventBus_Head].arg = Arg;
+		EventBus_Queue[EventBus_Head].timestamp = Delay_GetTick();
+		EventBus_Head = next;
+		ok = 1;
+	}
+	else
+	{
+		EventBus_Dropped++;
+	}
+	if (!primask)
+	{
+		__enable_irq();
+	}
+
+	if ((SCB->ICSR & SCB_ICSR_VECTACTIVE_Msk) == 0)	//不在中断里：立即分发
+	{
+		EventBus_Dispatch();
+	}
+	return ok;
+}
+
+/**
+  * @brief  把缓冲区里的事件按顺序分发给订阅者（只在主循环上下文调用）
+  * @param  无
+  * @retval 无
+  * @detail 回调里再发布的事件排在后面，由这一轮继续分发，不会递归
+  */
+void EventBus_Dispatch(void)
+{
+	BusEvent event;
+	uint8_t i;
+
+	if (EventBus_Dispatching)
+	{
+		return;
+	}
+	EventBus_Dispatching = 1;
+	while (EventBus_Tail != EventBus_Head)
+	{
+		event = EventBus_Queue[EventBus_Tail];
+		EventBus_Tail = (EventBus_Tail + 1) % EVENT_BUS_QUEUE_SIZE;
+		for (i = 0; i < EventBus_SubscriberCount; i++)
+		{
+			if (EventBus_Subscribers[i].Mask & EVENT_MASK(event.type))
+			{
+				EventBus_Subscribers[i].Handler(&event);
+			}
+		}
+	}
+	EventBus_Dispatching = 0;
+}
+
+uint32_t EventBus_GetDropCount(void)
+{
+	return EventBus_Dropped;
+}
@@ -0,0 +1,41 @@
+#ifndef __EVENT_BUS_H
+#define __EVENT_BUS_H
+
+#include "stm32f10x.h"
+
+// 轻量发布/订阅事件总线：事件先进静态环形缓冲区，再按订阅掩码分发给回调。
+// 在主循环里发布时立即分发（回调在发布者的上下文里执行，必须很短）；
+// 在中断里发布只入队，下一次主循环发布或调用EventBus_Dispatch时再分发
+
+#define EVENT_BUS_QUEUE_SIZE		16
+#define EVENT_BUS_MAX_SUBSCRIBERS	6
+
+typedef enum
+{
+	EVENT_ACTION_START = 0,		//动作开始，arg: 总步数（非步态动作为0）
+	EVENT_ACTION_PROGRESS,		//走完一步，arg: 完成百分比
+	EVENT_ACTION_COMPLETE,		//动作正常结束，arg: 完成的步数
+	EVENT_ACTION_CANCEL,		//动作被Dog_Abort中止，arg: 完成的步数
+	EVENT_TYPE_NUM
+} EventType;
+
+#define EVENT_MASK(type)		(1u << (type))
+#define EVENT_MASK_ACTION		(EVENT_MASK(EVENT_ACTION_START) | EVENT_MASK(EVENT_ACTION_PROGRESS) | \
+								 EVENT_MASK(EVENT_ACTION_COMPLETE) | EVENT_MASK(EVENT_ACTION_CANCEL))
+
+typedef struct
+{
+	uint8_t type;			//EventType
+	uint8_t source;			//发布者定义，动作事件为DogMode
+	uint16_t arg;
+	uint32_t timestamp;		//发布时刻，Delay_GetTick()的毫秒数
+} BusEvent;
+
+typedef void (*EventHandler)(const BusEvent *Event);
+
+uint8_t EventBus_Subscribe(uint16_t Mask, EventHandler Handler);
+uint8_t EventBus_Publish(uint8_t Type, uint8_t Source, uint16_t Arg);
+void EventBus_Dispatch(void);
+uint32_t EventBus_GetDropCount(void);
+
+#endif
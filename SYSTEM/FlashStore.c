@@ -0,0 +1,296 @@
+#include "stm32f10x.h"
+#include "stm32f10x_flash.h"
+#include "stm32f10x_crc.h"
+#include "FlashStore.h"
+
+//每个区域两页，区域k占第(FLASH_STORE_AREA_NUM-1-k)*2、+1页，标定(区域0)在Flash最后两页
+//页布局：[页序号][槽0][槽1]...，槽大小由记录长度决定
+//槽：[magic|version][length|~length][数据，补0到4字节对齐][CRC]，CRC覆盖前面所有字
+#define FLASH_STORE_PAGE_NUM		2
+#define FLASH_STORE_ERASED			0xFFFFFFFF
+#define FLASH_STORE_SLOT_BASE		4			//槽从页序号之后开始
+#define FLASH_STORE_MAX_WORDS		(FLASH_STORE_MAX_LENGTH / 4 + 3)
+
+static uint8_t FlashStore_CrcEnabled = 0;
+
+//区域的第一页（从FLASH_STORE_BASE数起）
+static uint8_t FlashStore_FirstPage(uint8_t Area)
+{
+	return (FLASH_STORE_AREA_NUM - 1 - Area) * FLASH_STORE_PAGE_NUM;
+}
+
+static uint32_t FlashStore_PageAddr(uint8_t Page)
+{
+	return FLASH_STORE_BASE + (uint32_t)Page * FLASH_STORE_PAGE_SIZE;
+}
+
+static uint32_t FlashStore_Read(uint32_t Addr)
+{
+	return *(volatile uint32_t *)Addr;
+}
+
+/**
+  * @brief  一个槽占用的字数
+  * @param  Length 记录字节数
+  * @retval 头2字 + 数据 + CRC 1字
+  */
+static uint16_t FlashStore_SlotWords(uint16_t Length)
+{
+	return 2 + (Length + 3) / 4 + 1;
+}
+
+static uint16_t FlashStore_SlotCount(uint16_t Length)
+{
+	return (FLASH_STORE_PAGE_SIZE - FLASH_STORE_SLOT_BASE) / (FlashStore_SlotWords(Length) * 4);
+}
+
+static uint32_t FlashStore_SlotAddr(uint8_t Page, uint16_t Slot, uint16_t Length)
+{
+	return FlashStore_PageAddr(Page) + FLASH_STORE_SLOT_BASE + (uint32_t)Slot * FlashStore_SlotWords(Length) * 4;
+}
+
+/**
+  * @brief  用片内CRC单元计算一串字的CRC-32
+  * @param  Words 数据
+  * @param  Count 字数
+  * @retval CRC
+  */
+static uint32_t FlashStore_Crc(const uint32_t *Words, uint16_t Count)
+{
+	if (!FlashStore_CrcEnabled)
+	{
+		RCC_AHBPeriphClockCmd(RCC_AHBPeriph_CRC, ENABLE);
+		FlashStore_CrcEnabled = 1;
+	}
+	CRC_ResetDR();
+	return CRC_CalcBlockCRC((uint32_t *)Words, Count);
+}
+
+/**
+  * @brief  打包成一个槽的内容：头、数据（小端，补0）、CRC
+  * @retval 字数
+  */
+static uint16_t FlashStore_Pack(uint32_t *Words, uint16_t Version, const uint8_t *Data, uint16_t Length)
+{
+	uint16_t i, n = FlashStore_SlotWords(Length);
+
+	Words[0] = FLASH_STORE_MAGIC | ((uint32_t)Version << 16);
+	Words[1] = Length | ((uint32_t)(uint16_t)~Length << 16);
+	for (i = 2; i < n - 1; i++)
+	{
+		Words[i] = 0;
+	}
+	for (i = 0; i < Length; i++)
+	{
+		Words[2 + i / 4] |= (uint32_t)Data[i] << ((i % 4) * 8);
+	}
+	Words[n - 1] = FlashStore_Crc(Words, n - 1);
+	return n;
+}
+
+/**
+  * @brief  检查一个槽是否是完整的记录
+  * @param  Addr 槽地址
+  * @param  Version 要求的版本号
+  * @param  Length 要求的长度
+  * @retval 1有效
+  */
+static uint8_t FlashStore_SlotValid(uint32_t Addr, uint16_t Version, uint16_t Length)
+{
+	uint32_t Words[FLASH_STORE_MAX_WORDS];
+	uint16_t i, n = FlashStore_SlotWords(Length);
+
+	for (i = 0; i < n; i++)
+	{
+		Words[i] = FlashStore_Read(Addr + i * 4);
+	}
+	if (Words[0] != (FLASH_STORE_MAGIC | ((uint32_t)Version << 16)) ||
+		Words[1] != (Length | ((uint32_t)(uint16_t)~Length << 16)))
+	{
+		return 0;
+	}
+	return FlashStore_Crc(Words, n - 1) == Words[n - 1];
+}
+
+/**
+  * @brief  当前页：页序号已写入且第一个槽的长度与本记录相同，两页都有效时取序号大的
+  * @param  Area 区域
+  * @param  Length 记录长度，长度变了（记录格式升级）旧页就不再算作当前页
+  * @retval 页号，0xFF表示没有
+  */
+static uint8_t FlashStore_CurrentPage(uint8_t Area, uint16_t Length, uint32_t *Sequence)
+{
+	uint8_t Page, Best = 0xFF;
+	uint32_t Seq, BestSeq = 0;
+
+	for (Page = FlashStore_FirstPage(Area); Page < FlashStore_FirstPage(Area) + FLASH_STORE_PAGE_NUM; Page++)
+	{
+		Seq = FlashStore_Read(FlashStore_PageAddr(Page));
+		if (Seq == FLASH_STORE_ERASED ||
+			(FlashStore_Read(FlashStore_SlotAddr(Page, 0, Length) + 4) & 0xFFFF) != Length)
+		{
+			continue;
+		}
+		if (Best == 0xFF || Seq > BestSeq)
+		{
+			Best = Page;
+			BestSeq = Seq;
+		}
+	}
+	if (Sequence)
+	{
+		*Sequence = BestSeq;
+	}
+	return Best;
+}
+
+/**
+  * @brief  二分查找第一个空槽：槽按顺序写入，已写的槽总是连续排在前面
+  * @retval 已写的槽数，0 ~ SlotCount
+  */
+static uint16_t FlashStore_UsedSlots(uint8_t Page, uint16_t Length)
+{
+	uint16_t Low = 0, High = FlashStore_SlotCount(Length), Mid;
+
+	while (Low < High)
+	{
+		Mid = (Low + High) / 2;
+		if (FlashStore_Read(FlashStore_SlotAddr(Page, Mid, Length)) == FLASH_STORE_ERASED)
+		{
+			High = Mid;
+		}
+		else
+		{
+			Low = Mid + 1;
+		}
+	}
+	return Low;
+}
+
+/**
+  * @brief  读出最后一次保存的记录
+  * @param  Area 区域，FlashStoreArea
+  * @param  Version 记录版本号，与保存时不同则视为没有记录
+  * @param  Data 输出
+  * @param  Length 字节数，不超过FLASH_STORE_MAX_LENGTH
+  * @retval 1成功，0没有有效记录（Data不变）
+  * @detail 最后一个槽CRC不对（保存时掉电）就往前找上一条
+  */
+uint8_t FlashStore_Load(uint8_t Area, uint16_t Version, void *Data, uint16_t Length)
+{
+	uint8_t Page;
+	uint16_t Slot, i;
+	uint32_t Addr;
+
+	if (Area >= FLASH_STORE_AREA_NUM || Length == 0 || Length > FLASH_STORE_MAX_LENGTH)
+	{
+		return 0;
+	}
+	Page = FlashStore_CurrentPage(Area, Length, 0);
+	if (Page == 0xFF)
+	{
+		return 0;
+	}
+	Slot = FlashStore_UsedSlots(Page, Length);
+	while (Slot > 0)
+	{
+		Slot--;
+		Addr = FlashStore_SlotAddr(Page, Slot, Length);
+		if (FlashStore_SlotValid(Addr, Version, Length))
+		{
+			for (i = 0; i < Length; i++)
+			{
+				((uint8_t *)Data)[i] = (uint8_t)(FlashStore_Read(Addr + 8 + (i & ~3)) >> ((i % 4) * 8));
+			}
+			return 1;
+		}
+	}
+	return 0;
+}
+
+static uint8_t FlashStore_Program(uint32_t Addr, const uint32_t *Words, uint16_t Count)
+{
+	uint16_t i;
+
+	for (i = 0; i < Count; i++)
+	{
+		if (FLASH_ProgramWord(Addr + i * 4, Words[i]) != FLASH_COMPLETE)
+		{
+			return 0;
+		}
+	}
+	return 1;
+}
+
+/**
+  * @brief  保存一条记录：追加到当前页的下一个空槽，页满（或还没有当前页）时擦除另一页重新开始
+  * @param  Area 区域，FlashStoreArea
+  * @param  Version 记录版本号
+  * @param  Data 数据
+  * @param  Length 字节数，不超过FLASH_STORE_MAX_LENGTH
+  * @retval 1成功，0失败（参数不对或Flash编程出错）
+  * @detail 与最后一条记录内容相同时不写。换页时先写记录再写页序号，页序号写入前掉电，旧页仍是当前页
+  */
+uint8_t FlashStore_Save(uint8_t Area, uint16_t Version, const void *Data, uint16_t Length)
+{
+	uint32_t Words[FLASH_STORE_MAX_WORDS];
+	uint32_t Seq, Addr;
+	uint16_t n, Slot = 0, i;
+	uint8_t Page, Ok;
+
+	if (Area >= FLASH_STORE_AREA_NUM || Length == 0 || Length > FLASH_STORE_MAX_LENGTH || FlashStore_SlotCount(Length) == 0)
+	{
+		return 0;
+	}
+	n = FlashStore_Pack(Words, Version, (const uint8_t *)Data, Length);
+
+	Page = FlashStore_CurrentPage(Area, Length, &Seq);
+	if (Page != 0xFF)
+	{
+		Slot = FlashStore_UsedSlots(Page, Length);
+		if (Slot > 0)
+		{
+			//内容没变就不写，省一次擦写寿命
+			Addr = FlashStore_SlotAddr(Page, Slot - 1, Length);
+			for (i = 0; i < n && FlashStore_Read(Addr + i * 4) == Words[i]; i++);
+			if (i == n)
+			{
+				return 1;
+			}
+		}
+	}
+
+	FLASH_Unlock();
+	FLASH_ClearFlag(FLASH_FLAG_EOP | FLASH_FLAG_PGERR | FLASH_FLAG_WRPRTERR);
+	if (Page != 0xFF && Slot < FlashStore_SlotCount(Length))
+	{
+		Ok = FlashStore_Program(FlashStore_SlotAddr(Page, Slot, Length), Words, n);
+	}
+	else
+	{
+		Page = (Page == 0xFF) ? FlashStore_FirstPage(Area) : (uint8_t)(Page ^ 1); //区域的两页从偶数页开始
+		Seq++;
+		Ok = FLASH_ErasePage(FlashStore_PageAddr(Page)) == FLASH_COMPLETE &&
+			FlashStore_Program(FlashStore_SlotAddr(Page, 0, Length), Words, n) &&
+			FlashStore_Program(FlashStore_PageAddr(Page), &Seq, 1);
+	}
+	FLASH_Lock();
+	return Ok;
+}
+
+/**
+  * @brief  当前页的页序号，即换页（擦除）次数，用于观察磨损
+  * @param  Area 区域
+  * @param  Length 记录长度
+  * @retval 0表示还没有记录
+  */
+uint32_t FlashStore_GetSequence(uint8_t Area, uint16_t Length)
+{
+	uint32_t Seq;
+
+	if (Area >= FLASH_STORE_AREA_NUM || FlashStore_CurrentPage(Area, Length, &Seq) == 0xFF)
+	{
+		return 0;
+	}
+	return Seq;
+}
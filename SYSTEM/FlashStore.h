@@ -0,0 +1,32 @@
+#ifndef __FLASH_STORE_H
+#define __FLASH_STORE_H
+
+#include "stm32f10x.h"
+
+// 用片内Flash最后几页模拟EEPROM，每个区域保存一条带版本号和CRC的记录（例如舵机标定）。
+// 只追加写：每次保存写到当前页的下一个空槽，页写满才擦除另一页并切换过去，
+// 两页轮流擦写，擦除次数是每次都擦的1/槽数。页首是页序号，序号大的页是当前页；
+// 新页先写完记录再写序号，写到一半掉电时旧页仍然有效。
+// 启动时在当前页里二分查找最后一个已写的槽，读取次数不超过log2(槽数)+1，与写过多少次无关。
+// 每种记录（区域）各占两页，互不影响。CRC用片内CRC单元（CRC-32，多项式0x04C11DB7）。
+// 工程的IROM1已缩小到0xE800，程序不会占用这几页。
+// 擦写期间CPU取指暂停（擦一页约20ms），不能在中断里调用
+
+#define FLASH_STORE_BASE			0x0800E800	//C8T6共64页，每页1KB，用最后六页
+#define FLASH_STORE_PAGE_SIZE		1024
+#define FLASH_STORE_MAGIC			0xCA1B
+#define FLASH_STORE_MAX_LENGTH		256			//记录最大字节数，保存和读取时缓冲区在栈上
+
+typedef enum
+{
+	FLASH_STORE_CALIBRATION = 0,	//舵机标定，Flash最后两页(0x0800F800)
+	FLASH_STORE_MACRO,				//蓝牙命令宏
+	FLASH_STORE_BEHAVIOR,			//行为字节码（用户程序）
+	FLASH_STORE_AREA_NUM
+} FlashStoreArea;
+
+uint8_t FlashStore_Load(uint8_t Area, uint16_t Version, void *Data, uint16_t Length);
+uint8_t FlashStore_Save(uint8_t Area, uint16_t Version, const void *Data, uint16_t Length);
+uint32_t FlashStore_GetSequence(uint8_t Area, uint16_t Length);	//页序号，每换一页加1
+
+#endif
@@ -0,0 +1,264 @@
+#include "Format.h"
+
+static const uint32_t Format_Pow10[10] = {
+	1, 10, 100, 1000, 10000, 100000,
+	1000000, 10000000, 100000000, 1000000000
+};
+
+/**
+  * @brief  按指定进制把数字倒序写入临时缓冲区
+  * @param  Tmp 临时缓冲区，至少32字节（二进制最坏情况）
+  * @param  Number 要转换的数字
+  * @param  Shift 0表示十进制，否则为每位的位数（1二进制，4十六进制）
+  * @retval 产生的位数
+  */
+static uint8_t Format_Digits(char *Tmp, uint32_t Number, uint8_t Shift)
+{
+	uint8_t n = 0;
+	uint8_t d;
+	do
+	{
+		if (Shift == 0)
+		{
+			d = Number % 10;
+			Number /= 10;
+		}
+		else
+		{
+			d = Number & ((1u << Shift) - 1);
+			Number >>= Shift;
+		}
+		Tmp[n++] = (d < 10) ? (d + '0') : (d - 10 + 'A');
+	} while (Number);
+	return n;
+}
+
+/**
+  * @brief  把倒序数字按宽度输出
+  * @param  Length 固定宽度，0表示按实际位数；位数超过宽度时只保留低位（与OLED_ShowNum一致）
+  * @retval 写入的字符数
+  */
+static uint8_t Format_Emit(char *Buf, const char *Tmp, uint8_t n, uint8_t Length, char Pad)
+{
+	uint8_t len = 0;
+	if (Length)
+	{
+		if (n > Length)
+		{
+			n = Length;
+		}
+		while (len < Length - n)
+		{
+			Buf[len++] = Pad;
+		}
+	}
+	while (n)
+	{
+		Buf[len++] = Tmp[--n];
+	}
+	Buf[len] = '\0';
+	return len;
+}
+
+/**
+  * @brief  复制字符串
+  * @param  Buf 目标缓冲区
+  * @param  Str 源字符串
+  * @retval 写入的字符数
+  */
+uint8_t Format_Str(char *Buf, const char *Str)
+{
+	uint8_t len = 0;
+	while (Str[len] != '\0')
+	{
+		Buf[len] = Str[len];
+		len++;
+	}
+	Buf[len] = '\0';
+	return len;
+}
+
+/**
+  * @brief  写入单个字符
+  * @retval 1
+  */
+uint8_t Format_Char(char *Buf, char Char)
+{
+	Buf[0] = Char;
+	Buf[1] = '\0';
+	return 1;
+}
+
+/**
+  * @brief  无符号十进制
+  * @param  Number 范围：0~4294967295
+  * @param  Length 宽度，0表示按实际位数
+  * @param  Pad 填充字符，一般为'0'或' '
+  * @retval 写入的字符数
+  */
+uint8_t Format_UInt(char *Buf, uint32_t Number, uint8_t Length, char Pad)
+{
+	char tmp[FORMAT_UINT_MAX_LEN];
+	return Format_Emit(Buf, tmp, Format_Digits(tmp, Number, 0), Length, Pad);
+}
+
+/**
+  * @brief  有符号十进制
+  * @param  Number 范围：-2147483648~2147483647
+  * @param  Length 总宽度（含负号），0表示按实际位数
+  * @param  Pad 填充字符：'0'时填在负号之后，' '时填在负号之前
+  * @retval 写入的字符数
+  */
+uint8_t Format_Int(char *Buf, int32_t Number, uint8_t Length, char Pad)
+{
+	char tmp[FORMAT_UINT_MAX_LEN];
+	uint32_t mag;
+	uint8_t n, len = 0;
+
+	if (Number >= 0)
+	{
+		return Format_UInt(Buf, (uint32_t)Number, Length, Pad);
+	}
+
+	mag = (uint32_t)(-(Number + 1)) + 1;
+	n = Format_Digits(tmp, mag, 0);
+	if (Pad != '0')
+	{
+		while (Length > n + 1 + len)
+		{
+			Buf[len++] = Pad;
+		}
+		Buf[len++] = '-';
+		return len + Format_Emit(Buf + len, tmp, n, 0, Pad);
+	}
+	Buf[len++] = '-';
+	return len + Format_Emit(Buf + len, tmp, n, Length ? Length - 1 : 0, '0');
+}
+
+/**
+  * @brief  定点小数，例如 Format_Fixed(buf, -1234, 2, 0) -> "-12.34"
+  * @param  Number 放大了10^Decimals倍的整数
+  * @param  Decimals 小数位数，范围：0~9
+  * @param  Length 总宽度，不足时左侧补空格，0表示按实际长度
+  * @retval 写入的字符数
+  */
+uint8_t Format_Fixed(char *Buf, int32_t Number, uint8_t Decimals, uint8_t Length)
+{
+	char tmp[FORMAT_INT_MAX_LEN + 2];	//最长"-214748364.8"：负号、10位数字、小数点和'\0'
+	uint32_t mag, scale;
+	uint8_t len = 0, total, i;
+
+	if (Decimals > 9)
+	{
+		Decimals = 9;
+	}
+	scale = Format_Pow10[Decimals];
+	mag = (Number < 0) ? (uint32_t)(-(Number + 1)) + 1 : (uint32_t)Number;
+
+	// 先在tmp里拼好，再按宽度右对齐
+	if (Number < 0)
+	{
+		tmp[len++] = '-';
+	}
+	len += Format_UInt(tmp + len, mag / scale, 0, '0');
+	if (Decimals)
+	{
+		tmp[len++] = '.';
+		len += Format_UInt(tmp + len, mag % scale, Decimals, '0');
+	}
+
+	total = 0;
+	while (Length > len + total)
+	{
+		Buf[total++] = ' ';
+	}
+	for (i = 0; i < len; i++)
+	{
+		Buf[total++] = tmp[i];
+	}
+	Buf[total] = '\0';
+	return total;
+}
+
+/**
+  * @brief  十六进制（大写）
+  * @param  Length 宽度，范围：0~8，0表示按实际位数，不足补'0'
+  * @retval 写入的字符数
+  */
+uint8_t Format_Hex(char *Buf, uint32_t Number, uint8_t Length)
+{
+	char tmp[8];
+	return Format_Emit(Buf, tmp, Format_Digits(tmp, Number, 4), Length, '0');
+}
+
+/**
+  * @brief  二进制
+  * @param  Length 宽度，范围：0~32，0表示按实际位数，不足补'0'
+  * @retval 写入的字符数
+  */
+uint8_t Format_Bin(char *Buf, uint32_t Number, uint8_t Length)
+{
+	char tmp[32];
+	return Format_Emit(Buf, tmp, Format_Digits(tmp, Number, 1), Length, '0');
+}
+
+/**
+  * @brief  解析定点小数（Format_Fixed的逆操作），如"-12.5"按Decimals=2得到-1250
+  * @param  Str 输入，跳过前导空格
+  * @param  Number 输出，放大了10^Decimals倍的整数；多余的小数位截掉
+  * @param  Decimals 小数位数，范围：0~9
+  * @retval 读过的字符数，0表示没有数字（Number不变）
+  */
+uint8_t Format_ParseFixed(const char *Str, int32_t *Number, uint8_t Decimals)
+{
+	const char *s = Str;
+	int32_t value = 0;
+	uint8_t neg = 0, digits = 0, frac = 0;
+
+	if (Decimals > 9)
+	{
+		Decimals = 9;
+	}
+	while (*s == ' ')
+	{
+		s++;
+	}
+	if (*s == '-' || *s == '+')
+	{
+		neg = (*s == '-');
+		s++;
+	}
+	while (*s >= '0' && *s <= '9')
+	{
+		if (digits < 9)
+		{
+			value = value * 10 + (*s - '0');
+		}
+		digits++;
+		s++;
+	}
+	if (*s == '.')
+	{
+		s++;
+		while (*s >= '0' && *s <= '9')
+		{
+			if (frac < Decimals)
+			{
+				value = value * 10 + (*s - '0');
+				frac++;
+			}
+			digits++;
+			s++;
+		}
+	}
+	if (digits == 0)
+	{
+		return 0;
+	}
+	for (; frac < Decimals; frac++)
+	{
+		value *= 10;
+	}
+	*Number = neg ? -value : value;
+	return (uint8_t)(s - Str);
+}
@@ -0,0 +1,26 @@
+#ifndef __FORMAT_H
+#define __FORMAT_H
+
+#include <stdint.h>
+
+// 轻量格式化：只写调用者提供的缓冲区，不分配内存，可重入
+// 只依赖stdint.h，可在PC上编译（test/FormatTest.c）
+// 所有函数返回写入的字符数（不含结尾'\0'），方便连续拼接：
+//     p += Format_Str(p, "Speed: ");
+//     p += Format_UInt(p, speed, 0, ' ');
+
+#define FORMAT_UINT_MAX_LEN   10   // 4294967295
+#define FORMAT_INT_MAX_LEN    11   // -2147483648
+
+uint8_t Format_Str(char *Buf, const char *Str);
+uint8_t Format_Char(char *Buf, char Char);
+uint8_t Format_UInt(char *Buf, uint32_t Number, uint8_t Length, char Pad);
+uint8_t Format_Int(char *Buf, int32_t Number, uint8_t Length, char Pad);
+uint8_t Format_Fixed(char *Buf, int32_t Number, uint8_t Decimals, uint8_t Length);
+uint8_t Format_Hex(char *Buf, uint32_t Number, uint8_t Length);
+uint8_t Format_Bin(char *Buf, uint32_t Number, uint8_t Length);
+
+// 解析：返回读过的字符数，0表示格式不对
+uint8_t Format_ParseFixed(const char *Str, int32_t *Number, uint8_t Decimals);
+
+#endif
@@ -0,0 +1,175 @@
+#include "GaitGen.h"
+#include "Q15Table.h"
+
+#define GAIT_PHASE_PER_MHZ_MS	4295u	//2^32 / 10^6，步频(mHz)*时间(ms)换算成相位增量
+
+//sin(x)，x=0~90度，Q15
+static const int16_t GaitGen_SinTable[Q15_TABLE_SIZE + 1] =
+{
+	0, 804, 1608, 2410, 3212, 4011, 4808, 5602,
+	6393, 7179, 7962, 8739, 9512, 10278, 11039, 11793,
+	12539, 13279, 14010, 14732, 15446, 16151, 16846, 17530,
+	18204, 18868, 19519, 20159, 20787, 21403, 22005, 22594,
+	23170, 23731, 24279, 24811, 25329, 25832, 26319, 26790,
+	27245, 27683, 28105, 28510, 28898, 29268, 29621, 29956,
+	30273, 30571, 30852, 31113, 31356, 31580, 31785, 31971,
+	32137, 32285, 32412, 32521, 32609, 32678, 32728, 32757,
+	32767
+};
+
+/**
+  * @brief  定点正弦
+  * @param  Angle 65536为一周
+  * @retval Q15
+  */
+int16_t GaitGen_Sin(uint16_t Angle)
+{
+	uint32_t q = Angle >> 14;				//象限
+	uint32_t x = (uint32_t)(Angle & 0x3FFF) << 2;	//象限内位置，0~65532
+
+	switch (q)
+	{
+		case 0: return Q15Table_Lookup(GaitGen_SinTable, x);
+		case 1: return Q15Table_Lookup(GaitGen_SinTable, 65536 - x);
+		case 2: return -Q15Table_Lookup(GaitGen_SinTable, x);
+		default: return -Q15Table_Lookup(GaitGen_SinTable, 65536 - x);
+	}
+}
+
+/**
+  * @brief  三次平滑曲线 3s^2-2s^3
+  * @param  S 0~65535表示0~1
+  * @retval Q15，0~32767
+  */
+int16_t GaitGen_Cubic(uint16_t S)
+{
+	return Q15Table_Lookup(Q15Table_Cubic, S);
+}
+
+/**
+  * @brief  默认参数：对角小跑，前左/后右一组，前右/后左一组
+  * @param  P 要填写的参数
+  * @retval 无
+  */
+void GaitGen_DefaultParams(GaitParams *P)
+{
+	P->freq_mhz = 2000;
+	P->amplitude = 2000;		//20度，与原来抬腿/摆腿的角度差相当
+	P->duty = 550;				//两组腿支撑相略有重叠，始终有腿着地
+	P->offset[0] = 0;
+	P->offset[1] = 500;
+	P->offset[2] = 500;
+	P->offset[3] = 0;
+	P->turn = 0;
+	P->profile = GAIT_PROFILE_CUBIC;
+}
+
+void GaitGen_Init(GaitGen *G, const GaitParams *P)
+{
+	if (P)
+	{
+		G->p = *P;
+	}
+	else
+	{
+		GaitGen_DefaultParams(&G->p);
+	}
+	G->phase = 0;
+	G->cycles = 0;
+}
+
+/**
+  * @brief  相位前进
+  * @param  G 步态
+  * @param  Ms 经过的时间(ms)，不超过100
+  * @retval 1表示走完了一个周期
+  * @detail 改变步频只改变相位前进的快慢，相位本身连续，腿不会跳
+  */
+uint8_t GaitGen_Advance(GaitGen *G, uint16_t Ms)
+{
+	uint32_t old = G->phase;
+	G->phase += (uint32_t)G->p.freq_mhz * Ms * GAIT_PHASE_PER_MHZ_MS;
+	if (G->phase < old)
+	{
+		G->cycles++;
+		return 1;
+	}
+	return 0;
+}
+
+// 转向偏置下一侧腿的摆幅比例(‰)：Sign为+1左侧，-1右侧
+static int32_t GaitGen_SideScale(int16_t Turn, int8_t Sign)
+{
+	int32_t s = 1000 - 2 * Sign * (int32_t)Turn;
+	if (s > 1000)
+	{
+		s = 1000;
+	}
+	if (s < -1000)
+	{
+		s = -1000;
+	}
+	return s;
+}
+
+/**
+  * @brief  计算四条腿当前的摆角
+  * @param  G 步态
+  * @param  Out 输出，各腿相对站姿的摆角(0.01度)，正为向前
+  * @param  Lift 输出，各腿抬腿量(Q15，0~32767)，不需要时传0
+  * @retval 无
+  */
+void GaitGen_Eval(const GaitGen *G, int16_t Out[GAIT_LEGS], int16_t Lift[GAIT_LEGS])
+{
+	const GaitParams *p = &G->p;
+	uint32_t duty, leg_phase, s;
+	int32_t a, x;
+	uint8_t i;
+
+	duty = (uint32_t)p->duty * 65536 / 1000;
+	if (duty < 6554)
+	{
+		duty = 6554;		//10%
+	}
+	if (duty > 58982)
+	{
+		duty = 58982;		//90%
+	}
+
+	for (i = 0; i < GAIT_LEGS; i++)
+	{
+		a = (int32_t)p->amplitude * GaitGen_SideScale(p->turn, (i == 0 || i == 2) ? 1 : -1) / 1000;
+		leg_phase = ((G->phase >> 16) + (uint32_t)p->offset[i] * 65536 / 1000) & 0xFFFF;
+
+		if (leg_phase < duty)
+		{
+			x = a - (int32_t)(((int64_t)2 * a * leg_phase) / (int32_t)duty);
+			if (Lift)
+			{
+				Lift[i] = 0;
+			}
+		}
+		else
+		{
+			s = (leg_phase - duty) * 65536 / (65536 - duty);
+			if (s > 65535)
+			{
+				s = 65535;
+			}
+			if (p->profile == GAIT_PROFILE_SINE)
+			{
+				//-cos(pi*s) = -sin(pi*s + pi/2)，角度65536为一周
+				x = -(a * GaitGen_Sin((uint16_t)((s >> 1) + 16384))) / 32768;
+			}
+			else
+			{
+				x = -a + (2 * a * GaitGen_Cubic((uint16_t)s)) / 32768;
+			}
+			if (Lift)
+			{
+				Lift[i] = GaitGen_Sin((uint16_t)(s >> 1));	//sin(pi*s)
+			}
+		}
+		Out[i] = (int16_t)x;
+	}
+}
@@ -0,0 +1,45 @@
+#ifndef __GAIT_GEN_H
+#define __GAIT_GEN_H
+
+#include <stdint.h>
+
+// 参数化步态生成：由步频、摆幅、支撑相比例、各腿相位差和转向偏置算出四条腿的摆角。
+// 每条腿只有一个髋关节舵机，输出是相对站姿的前后摆角：
+//   支撑相  从+A匀速摆到-A（腿着地向后推，身体向前）
+//   摆动相  从-A回到+A，按三次曲线或半周正弦加减速，起止速度为零
+// 有膝关节时另外输出抬腿量：摆动相为半周正弦，支撑相为零
+// 全部定点运算（相位Q16，摆角0.01度，三角/三次函数查表插值），只依赖stdint.h，主机测试见test/GaitGenTest.c（make -C test）
+
+#define GAIT_LEGS				4		//腿顺序：前左 前右 后左 后右
+
+typedef enum
+{
+	GAIT_PROFILE_CUBIC = 0,		//摆动相 3s^2-2s^3
+	GAIT_PROFILE_SINE			//摆动相 -cos(pi*s)
+} GaitProfile;
+
+typedef struct
+{
+	uint16_t freq_mhz;			//步频(mHz)，一个周期记一步
+	int16_t amplitude;			//摆幅A(0.01度)，负数表示后退
+	uint16_t duty;				//支撑相占周期的比例(‰)，100~900
+	uint16_t offset[GAIT_LEGS];	//各腿相位偏移(‰)
+	int16_t turn;				//转向偏置(‰)，正为左转：0直走，500左侧原地踏步，1000左右反向原地转
+	uint8_t profile;			//GaitProfile
+} GaitParams;
+
+typedef struct
+{
+	GaitParams p;				//可随时修改，下一次Eval生效
+	uint32_t phase;				//周期相位，2^32为一周
+	uint32_t cycles;			//走完的周期数
+} GaitGen;
+
+void GaitGen_DefaultParams(GaitParams *P);
+void GaitGen_Init(GaitGen *G, const GaitParams *P);
+uint8_t GaitGen_Advance(GaitGen *G, uint16_t Ms);
+void GaitGen_Eval(const GaitGen *G, int16_t Out[GAIT_LEGS], int16_t Lift[GAIT_LEGS]);
+int16_t GaitGen_Sin(uint16_t Angle);
+int16_t GaitGen_Cubic(uint16_t S);
+
+#endif
@@ -0,0 +1,234 @@
+#include "IMU.h"
+
+#define IMU_BIAS_SHIFT				4		//零偏按1/16 LSB保存，平均后的小数部分不丢
+
+static IMU_Attitude IMU_State;
+static uint16_t IMU_Rate = 200;
+static int32_t IMU_GyroBias[3];				//1/16 LSB
+static int32_t IMU_AngleRem[3];				//积分余数，单位见IMU_Integrate
+static int32_t IMU_BiasSum[3];
+static uint16_t IMU_BiasCount = 0;
+static volatile uint32_t IMU_PeakNorm[2];	//合加速度峰值(LSB)，用于检测撞击；两组轮换，见IMU_TakePeakAccel
+static volatile uint8_t IMU_PeakBank = 0;	//IMU_Update更新的那一组
+static volatile uint32_t IMU_Seq = 0;		//IMU_State的版本号，更新期间为奇数
+
+/**
+  * @brief  整数平方根（逐位试商）
+  * @param  X 被开方数
+  * @retval floor(sqrt(X))
+  */
+uint32_t IMU_Sqrt(uint32_t X)
+{
+	uint32_t res = 0;
+	uint32_t bit = 1UL << 30;
+
+	while (bit > X)
+	{
+		bit >>= 2;
+	}
+	while (bit)
+	{
+		if (X >= res + bit)
+		{
+			X -= res + bit;
+			res = (res >> 1) + bit;
+		}
+		else
+		{
+			res >>= 1;
+		}
+		bit >>= 2;
+	}
+	return res;
+}
+
+/**
+  * @brief  定点atan2，最大误差约0.25度
+  * @param  Y、X 任意比例的整数（|Y|、|X|需小于65536）
+  * @retval 角度，单位毫度，范围-180000~180000
+  * @detail atan(z) ≈ 45z + 15.64z(1-|z|) 度，|z|<=1；|z|>1时用90度减去atan(1/z)
+  */
+int32_t IMU_Atan2(int32_t Y, int32_t X)
+{
+	int32_t ax = (X < 0) ? -X : X;
+	int32_t ay = (Y < 0) ? -Y : Y;
+	int32_t z, angle;
+
+	if (ax == 0 && ay == 0)
+	{
+		return 0;
+	}
+	if (ax >= ay)
+	{
+		z = (ay << 15) / ax;										//Q15，0~1
+		angle = (45000 * z + ((15640 * z) >> 15) * (32768 - z)) >> 15;
+	}
+	else
+	{
+		z = (ax << 15) / ay;
+		angle = 90000 - ((45000 * z + ((15640 * z) >> 15) * (32768 - z)) >> 15);
+	}
+	if (X < 0)
+	{
+		angle = 180000 - angle;
+	}
+	return (Y < 0) ? -angle : angle;
+}
+
+/**
+  * @brief  初始化滤波器
+  * @param  RateHz 调用IMU_Update的频率
+  * @retval 无
+  */
+void IMU_Init(uint16_t RateHz)
+{
+	uint8_t i;
+
+	IMU_Rate = RateHz ? RateHz : 1;
+	IMU_State.pitch = 0;
+	IMU_State.roll = 0;
+	IMU_State.yaw = 0;
+	IMU_State.pitch_rate = 0;
+	IMU_State.roll_rate = 0;
+	IMU_State.yaw_rate = 0;
+	IMU_State.calibrated = 0;
+	for (i = 0; i < 3; i++)
+	{
+		IMU_GyroBias[i] = 0;
+		IMU_BiasSum[i] = 0;
+		IMU_AngleRem[i] = 0;
+	}
+	IMU_BiasCount = 0;
+}
+
+/**
+  * @brief  陀螺仪积分一帧，除不尽的部分留到下一帧
+  * @param  Rate 去掉零偏的角速度，放大了IMU_GYRO_LSB_PER_DPS_X10倍的毫度/秒
+  * @param  Rem 这个轴的积分余数
+  * @retval 本帧的角度增量(毫度)
+  * @detail 直接用毫度/秒除以采样率，每帧最多丢掉1毫度：200Hz时0.2度/秒以下的转动积分为0
+  */
+static int32_t IMU_Integrate(int32_t Rate, int32_t *Rem)
+{
+	int32_t Div = (int32_t)IMU_GYRO_LSB_PER_DPS_X10 * IMU_Rate;
+	int32_t Step;
+
+	*Rem += Rate;
+	Step = *Rem / Div;
+	*Rem -= Step * Div;
+	return Step;
+}
+
+// 解算一帧，由IMU_Update在版本号为奇数期间调用
+static void IMU_Step(const int16_t Accel[3], const int16_t Gyro[3])
+{
+	int32_t rate[3];
+	int32_t acc_pitch, acc_roll;
+	uint32_t norm, g = IMU_ACCEL_LSB_PER_G;
+	uint8_t i, trust;
+
+	//加速度计倾角，合加速度接近1g时才可信
+	norm = IMU_Sqrt((uint32_t)((int32_t)Accel[0] * Accel[0]) + (uint32_t)((int32_t)Accel[1] * Accel[1]) + (uint32_t)((int32_t)Accel[2] * Accel[2]));
+	trust = norm > g - g * IMU_ACCEL_TRUST_PERMILLE / 1000 && norm < g + g * IMU_ACCEL_TRUST_PERMILLE / 1000;
+	if (norm > IMU_PeakNorm[IMU_PeakBank])
+	{
+		IMU_PeakNorm[IMU_PeakBank] = norm;
+	}
+	acc_pitch = IMU_Atan2(Accel[0], IMU_Sqrt((uint32_t)((int32_t)Accel[1] * Accel[1]) + (uint32_t)((int32_t)Accel[2] * Accel[2])));
+	acc_roll = IMU_Atan2(Accel[1], Accel[2]);
+
+	if (!IMU_State.calibrated)
+	{
+		for (i = 0; i < 3; i++)
+		{
+			IMU_BiasSum[i] += Gyro[i];
+		}
+		if (++IMU_BiasCount >= IMU_CALIB_SAMPLES)
+		{
+			for (i = 0; i < 3; i++)
+			{
+				IMU_GyroBias[i] = IMU_BiasSum[i] * (1 << IMU_BIAS_SHIFT) / IMU_BiasCount;
+			}
+			IMU_State.calibrated = 1;
+		}
+		IMU_State.pitch = acc_pitch;
+		IMU_State.roll = acc_roll;
+		return;
+	}
+
+	//原始值去掉零偏，再乘10000>>IMU_BIAS_SHIFT，除以IMU_GYRO_LSB_PER_DPS_X10就是毫度/秒
+	for (i = 0; i < 3; i++)
+	{
+		rate[i] = ((int32_t)Gyro[i] * (1 << IMU_BIAS_SHIFT) - IMU_GyroBias[i]) * (10000 >> IMU_BIAS_SHIFT);
+	}
+	IMU_State.roll_rate = rate[0] / IMU_GYRO_LSB_PER_DPS_X10;		//绕x轴正转：左侧抬起、右侧向下
+	IMU_State.pitch_rate = -rate[1] / IMU_GYRO_LSB_PER_DPS_X10;	//绕y轴正转是低头，取反得到抬头为正
+	IMU_State.yaw_rate = rate[2] / IMU_GYRO_LSB_PER_DPS_X10;
+
+	//陀螺仪积分，余数按轴累计
+	IMU_State.roll += IMU_Integrate(rate[0], &IMU_AngleRem[0]);
+	IMU_State.pitch += IMU_Integrate(-rate[1], &IMU_AngleRem[1]);
+	IMU_State.yaw += IMU_Integrate(rate[2], &IMU_AngleRem[2]);
+	if (IMU_State.yaw > 180000)
+	{
+		IMU_State.yaw -= 360000;
+	}
+	else if (IMU_State.yaw < -180000)
+	{
+		IMU_State.yaw += 360000;
+	}
+
+	//加速度计修正倾角漂移
+	if (trust)
+	{
+		IMU_State.pitch += (acc_pitch - IMU_State.pitch) >> IMU_ACCEL_SHIFT;
+		IMU_State.roll += (acc_roll - IMU_State.roll) >> IMU_ACCEL_SHIFT;
+	}
+}
+
+/**
+  * @brief  输入一帧原始数据（可在中断中调用，无浮点、无除法以外的耗时运算）
+  * @param  Accel 加速度原始值x/y/z，x向前、y向左、z向上（平放时az为+1g）
+  * @param  Gyro 陀螺仪原始值x/y/z
+  * @retval 无
+  * @detail 前IMU_CALIB_SAMPLES帧用来估计陀螺仪零偏，期间只用加速度给出倾角
+  */
+void IMU_Update(const int16_t Accel[3], const int16_t Gyro[3])
+{
+	IMU_Seq++;
+	IMU_Step(Accel, Gyro);
+	IMU_Seq++;
+}
+
+/**
+  * @brief  读取姿态
+  * @param  Out 输出
+  * @retval 无
+  * @detail 复制期间被IMU_Update打断（舵机帧中断被DMA中断抢占）时重新复制，不会读到半新半旧的姿态；
+  *         不能在优先级高于IMU_Update的中断里调用
+  */
+void IMU_GetAttitude(IMU_Attitude *Out)
+{
+	uint32_t Seq;
+	do
+	{
+		Seq = IMU_Seq;
+		*Out = IMU_State;
+	} while ((Seq & 1) || Seq != IMU_Seq);
+}
+
+/**
+  * @brief  读取并清除合加速度峰值
+  * @param  无
+  * @retval 峰值，单位mg
+  * @detail 先清零另一组再让IMU_Update改用它，之后IMU_Update不再写原来那一组，读它不会丢掉
+  *         读和清零之间到来的峰值；只写一个字节，不用关中断，主机上也能编译
+  */
+uint32_t IMU_TakePeakAccel(void)
+{
+	uint8_t bank = IMU_PeakBank;
+
+	IMU_PeakNorm[bank ^ 1] = 0;
+	IMU_PeakBank = bank ^ 1;
+	return IMU_PeakNorm[bank] * 1000 / IMU_ACCEL_LSB_PER_G;
+}
@@ -0,0 +1,34 @@
+#ifndef __IMU_H
+#define __IMU_H
+
+#include <stdint.h>
+
+// 定点互补滤波姿态解算：加速度计算倾角，陀螺仪积分，按固定比例互相修正
+// 角度单位：毫度(0.001度)；角速度单位：毫度/秒
+// 只依赖stdint.h，可在PC上编译；test/IMUTest.c把test/data/imu_*.csv的原始数据逐帧喂给IMU_Update（make -C test）
+
+#define IMU_ACCEL_LSB_PER_G			8192	//量程±4g
+#define IMU_GYRO_LSB_PER_DPS_X10	655		//量程±500dps，65.5LSB/(度/秒)
+#define IMU_ACCEL_SHIFT				6		//加速度修正权重1/64，200Hz时时间常数约0.3s
+#define IMU_CALIB_SAMPLES			200		//上电静止时用来估计陀螺仪零偏的样本数
+#define IMU_ACCEL_TRUST_PERMILLE	200		//合加速度偏离1g超过20%时（碰撞/跳动）不用加速度修正
+
+typedef struct
+{
+	int32_t pitch;			//俯仰，抬头为正
+	int32_t roll;			//横滚，右侧向下为正
+	int32_t yaw;			//航向，陀螺仪积分，会漂移
+	int32_t pitch_rate;
+	int32_t roll_rate;
+	int32_t yaw_rate;
+	uint8_t calibrated;		//陀螺仪零偏已估计完
+} IMU_Attitude;
+
+void IMU_Init(uint16_t RateHz);
+void IMU_Update(const int16_t Accel[3], const int16_t Gyro[3]);
+void IMU_GetAttitude(IMU_Attitude *Out);
+uint32_t IMU_TakePeakAccel(void);	//上次调用以来合加速度的峰值(mg)，读后清零
+int32_t IMU_Atan2(int32_t Y, int32_t X);
+uint32_t IMU_Sqrt(uint32_t X);
+
+#endif
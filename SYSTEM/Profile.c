@@ -0,0 +1,121 @@
+#include "stm32f10x.h"
+#include "Profile.h"
+
+#if PROFILE_ENABLE
+
+static ProfileStats Profile_Stats[PROFILE_ZONE_NUM];
+static volatile uint32_t Profile_Mask = PROFILE_MASK_DEFAULT;
+static uint32_t Profile_Overhead = 0;	//连续读两次CYCCNT的周期数，每次测量都要减掉
+
+static const char *const Profile_Names[PROFILE_ZONE_NUM] =
+{
+	"DOG", "OLED", "BTTX", "BTLN", "SONAR", "BHV"
+};
+
+/**
+  * @brief  打开DWT周期计数器并测出测量本身的开销
+  * @param  无
+  * @retval 无
+  * @detail 接着调试器时TRCENA可能已经打开，这里再打开一次没有影响
+  */
+void Profile_Init(void)
+{
+	uint32_t Start;
+
+	CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+	PROFILE_DWT_CYCCNT = 0;
+	PROFILE_DWT_CTRL |= PROFILE_DWT_CYCCNTENA;
+	Start = PROFILE_DWT_CYCCNT;
+	Profile_Overhead = PROFILE_DWT_CYCCNT - Start;
+	Profile_Reset();
+}
+
+/**
+  * @brief  记录一次测量，由PROFILE_END调用，可在中断中调用
+  * @param  Zone 区域，ProfileZone
+  * @param  Cycles 周期数（含测量开销）
+  * @retval 无
+  */
+void Profile_Record(uint8_t Zone, uint32_t Cycles)
+{
+	ProfileStats *Stats;
+	uint32_t Primask;
+
+	if (Zone >= PROFILE_ZONE_NUM || !(Profile_Mask & (1u << Zone)))
+	{
+		return;
+	}
+	Cycles = (Cycles > Profile_Overhead) ? Cycles - Profile_Overhead : 0;
+	Stats = &Profile_Stats[Zone];
+	Primask = __get_PRIMASK();
+	__disable_irq();	//同一区域可能在中断里也有测量
+	if (Stats->Count == 0 || Cycles < Stats->Min)
+	{
+		Stats->Min = Cycles;
+	}
+	if (Cycles > Stats->Max)
+	{
+		Stats->Max = Cycles;
+	}
+	Stats->Total += Cycles;
+	Stats->Count++;
+	if (!Primask)
+	{
+		__enable_irq();
+	}
+}
+
+void Profile_Reset(void)
+{
+	uint8_t i;
+
+	__disable_irq();
+	for (i = 0; i < PROFILE_ZONE_NUM; i++)
+	{
+		Profile_Stats[i].Count = 0;
+		Profile_Stats[i].Min = 0;
+		Profile_Stats[i].Max = 0;
+		Profile_Stats[i].Total = 0;
+	}
+	__enable_irq();
+}
+
+/**
+  * @brief  设置统计哪些区域
+  * @param  Mask bit(ProfileZone)，关掉的区域仍然读CYCCNT，但不记录
+  * @retval 无
+  */
+void Profile_SetMask(uint32_t Mask)
+{
+	Profile_Mask = Mask;
+}
+
+uint32_t Profile_GetMask(void)
+{
+	return Profile_Mask;
+}
+
+/**
+  * @brief  读取一个区域的统计（一次性拷贝，不会读到中断更新了一半的数据）
+  * @param  Zone 区域
+  * @param  Stats 输出
+  * @retval 1成功，0区域编号不对
+  */
+uint8_t Profile_GetStats(uint8_t Zone, ProfileStats *Stats)
+{
+	if (Zone >= PROFILE_ZONE_NUM)
+	{
+		return 0;
+	}
+	__disable_irq();
+	*Stats = Profile_Stats[Zone];
+	__enable_irq();
+	return 1;
+}
+
+const char *Profile_GetName(uint8_t Zone)
+{
+	return (Zone < PROFILE_ZONE_NUM) ? Profile_Names[Zone] : "?";
+}
+
+#endif
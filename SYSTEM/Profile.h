@@ -0,0 +1,62 @@
+#ifndef __PROFILE_H
+#define __PROFILE_H
+
+#include "stm32f10x.h"
+
+// 用DWT周期计数器(CYCCNT，72MHz下每周期约14ns)测量代码段耗时，按区域统计次数、最小、最大、平均周期数。
+// 在要测的代码前后写PROFILE_BEGIN(区域)/PROFILE_END(区域)，两者要在同一个代码块里，中间不能return。
+// 主循环里的区域包含期间被中断占用的时间，最大值反映的是最坏情况下的实际耗时。
+// PROFILE_ENABLE为0时宏展开为空，Profile.c也不参与编译，不占任何空间和时间
+
+#define PROFILE_ENABLE		1
+
+typedef enum
+{
+	PROFILE_DOG_FRAME = 0,		//Dog_MoveFrame：舵机帧中断里推进插值轨迹
+	PROFILE_OLED_SHOW,			//OLED_ShowString：软件I2C写一行字
+	PROFILE_BT_SEND,			//Bluetooth_SendString：阻塞发送
+	PROFILE_BT_LINE,			//Bluetooth_ProcessLine：处理一行'$'命令（含回复的发送时间）
+	PROFILE_ULTRASONIC_ECHO,	//EXTI9_5_IRQHandler：回波边沿中断
+	PROFILE_BEHAVIOR_STEP,		//Behavior_Task：后台行为执行一次
+	PROFILE_ZONE_NUM
+} ProfileZone;
+
+//默认统计的区域；其余区域用Profile_SetMask打开
+#define PROFILE_MASK_DEFAULT	((1u << PROFILE_DOG_FRAME) | (1u << PROFILE_OLED_SHOW) | (1u << PROFILE_BT_SEND) | \
+								 (1u << PROFILE_BT_LINE) | (1u << PROFILE_ULTRASONIC_ECHO))
+
+typedef struct
+{
+	uint32_t Count;
+	uint32_t Min;				//周期数，已减去测量本身的开销
+	uint32_t Max;
+	uint64_t Total;				//用于求平均，72MHz下累计约8000年才会溢出
+} ProfileStats;
+
+//DWT寄存器（CMSIS的core_cm3.h没有定义），PROFILE_ENABLE为0时也可以直接用来计时
+#define PROFILE_DWT_CTRL		(*(volatile uint32_t *)0xE0001000)
+#define PROFILE_DWT_CYCCNT		(*(volatile uint32_t *)0xE0001004)
+#define PROFILE_DWT_CYCCNTENA	0x00000001
+
+#if PROFILE_ENABLE
+
+#define PROFILE_BEGIN(Zone)		uint32_t Profile_Start_##Zone = PROFILE_DWT_CYCCNT
+#define PROFILE_END(Zone)		Profile_Record(Zone, PROFILE_DWT_CYCCNT - Profile_Start_##Zone)
+
+void Profile_Init(void);
+void Profile_Record(uint8_t Zone, uint32_t Cycles);
+void Profile_Reset(void);
+void Profile_SetMask(uint32_t Mask);
+uint32_t Profile_GetMask(void);
+uint8_t Profile_GetStats(uint8_t Zone, ProfileStats *Stats);	//返回0表示区域编号不对
+const char *Profile_GetName(uint8_t Zone);
+
+#else
+
+#define PROFILE_BEGIN(Zone)
+#define PROFILE_END(Zone)
+#define Profile_Init()
+
+#endif
+
+#endif
@@ -0,0 +1,36 @@
+#include "Q15Table.h"
+
+//3s^2-2s^3，s=0~1，Q15（GaitGen摆动相、Trajectory的Hermite基函数h01）
+const int16_t Q15Table_Cubic[Q15_TABLE_SIZE + 1] =
+{
+	0, 24, 94, 209, 368, 569, 810, 1090,
+	1408, 1762, 2150, 2571, 3024, 3507, 4018, 4556,
+	5120, 5708, 6318, 6949, 7600, 8268, 8954, 9654,
+	10368, 11093, 11830, 12575, 13328, 14086, 14850, 15616,
+	16384, 17151, 17917, 18681, 19439, 20192, 20937, 21674,
+	22399, 23113, 23813, 24499, 25167, 25818, 26449, 27059,
+	27647, 28211, 28749, 29260, 29743, 30196, 30617, 31005,
+	31359, 31677, 31957, 32198, 32399, 32558, 32673, 32743,
+	32767
+};
+
+/**
+  * @brief  查表线性插值
+  * @param  Table 65项的表
+  * @param  X 0~65536对应表的0~64，超出时取最后一项
+  * @retval 插值结果，与表同单位
+  */
+int16_t Q15Table_Lookup(const int16_t *Table, uint32_t X)
+{
+	uint32_t i = X >> (16 - Q15_TABLE_BITS);
+	int32_t frac = X & ((1 << (16 - Q15_TABLE_BITS)) - 1);
+	int32_t a, b;
+
+	if (i >= Q15_TABLE_SIZE)
+	{
+		return Table[Q15_TABLE_SIZE];
+	}
+	a = Table[i];
+	b = Table[i + 1];
+	return (int16_t)(a + (((b - a) * frac) >> (16 - Q15_TABLE_BITS)));
+}
@@ -0,0 +1,16 @@
+#ifndef __Q15_TABLE_H
+#define __Q15_TABLE_H
+
+#include <stdint.h>
+
+// GaitGen和Trajectory共用的Q15查表：65项的表覆盖0~1（64段），段内线性插值。
+// 只依赖stdint.h，可在PC上编译
+
+#define Q15_TABLE_BITS			6		//查表64段
+#define Q15_TABLE_SIZE			(1 << Q15_TABLE_BITS)
+
+extern const int16_t Q15Table_Cubic[Q15_TABLE_SIZE + 1];	//3s^2-2s^3
+
+int16_t Q15Table_Lookup(const int16_t *Table, uint32_t X);
+
+#endif
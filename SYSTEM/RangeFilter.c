@@ -0,0 +1,240 @@
+#include "RangeFilter.h"
+
+#define RANGE_FILTER_MISS_FACTOR	4		//每丢失一次，方差增加4R
+#define RANGE_FILTER_MAX_DT_MS		10000	//门限计算时间间隔上限，防止溢出
+
+/**
+  * @brief  方差饱和相加
+  */
+static uint32_t RangeFilter_AddVar(uint32_t A, uint32_t B)
+{
+	return (A > 0xFFFFFFFF - B) ? 0xFFFFFFFF : A + B;
+}
+
+/**
+  * @brief  窗口中值（插入排序，N<=7时比快排更快更小）
+  */
+static uint16_t RangeFilter_Median(const RangeFilter *Filter)
+{
+	uint16_t tmp[RANGE_FILTER_WINDOW_MAX];
+	uint16_t v;
+	uint8_t i, j;
+
+	for (i = 0; i < Filter->count; i++)
+	{
+		v = Filter->samples[i];
+		for (j = i; j > 0 && tmp[j - 1] > v; j--)
+		{
+			tmp[j] = tmp[j - 1];
+		}
+		tmp[j] = v;
+	}
+	return tmp[Filter->count / 2];
+}
+
+/**
+  * @brief  窗口内样本的方差，不用卡尔曼时作为输出方差
+  */
+static uint32_t RangeFilter_WindowVar(const RangeFilter *Filter)
+{
+	uint32_t sum = 0, var = 0;
+	int32_t mean, d;
+	uint8_t i;
+
+	if (Filter->count < 2)
+	{
+		return Filter->cfg.measure_noise;
+	}
+	for (i = 0; i < Filter->count; i++)
+	{
+		sum += Filter->samples[i];
+	}
+	mean = sum / Filter->count;
+	for (i = 0; i < Filter->count; i++)
+	{
+		d = (int32_t)Filter->samples[i] - mean;
+		var += (uint32_t)(d * d);
+	}
+	return var / Filter->count;
+}
+
+/**
+  * @brief  默认参数，适用于HC-SR04每60ms测一次
+  * @param  Cfg 要填写的参数
+  * @retval 无
+  */
+void RangeFilter_DefaultConfig(RangeFilterConfig *Cfg)
+{
+	Cfg->window = 3;				//窗口越长越抗干扰，但障碍物出现时反应越慢
+	Cfg->min_mm = 20;
+	Cfg->max_mm = 4000;
+	Cfg->max_rate = 1500;
+	Cfg->gate_floor_mm = 30;
+	Cfg->max_rejects = 2;
+	Cfg->use_kalman = 1;
+	Cfg->process_noise = 100;		//10mm
+	Cfg->measure_noise = 400;		//20mm
+	Cfg->half_conf_var = 2500;		//50mm
+}
+
+/**
+  * @brief  初始化滤波器
+  * @param  Filter 滤波器
+  * @param  Cfg 参数，会被复制一份；为NULL时使用默认参数
+  * @retval 无
+  */
+void RangeFilter_Init(RangeFilter *Filter, const RangeFilterConfig *Cfg)
+{
+	if (Cfg)
+	{
+		Filter->cfg = *Cfg;
+	}
+	else
+	{
+		RangeFilter_DefaultConfig(&Filter->cfg);
+	}
+	if (Filter->cfg.window == 0)
+	{
+		Filter->cfg.window = 1;
+	}
+	if (Filter->cfg.window > RANGE_FILTER_WINDOW_MAX)
+	{
+		Filter->cfg.window = RANGE_FILTER_WINDOW_MAX;
+	}
+	if (Filter->cfg.half_conf_var == 0)
+	{
+		Filter->cfg.half_conf_var = 1;
+	}
+	RangeFilter_Reset(Filter);
+}
+
+/**
+  * @brief  清空历史，保留参数
+  */
+void RangeFilter_Reset(RangeFilter *Filter)
+{
+	Filter->count = 0;
+	Filter->index = 0;
+	Filter->x = 0;
+	Filter->p = 0;
+	Filter->last_ms = 0;
+	Filter->rejects = 0;
+	Filter->misses = 0;
+	Filter->status = RANGE_FILTER_NONE;
+}
+
+/**
+  * @brief  输入一次原始测量
+  * @param  Filter 滤波器
+  * @param  RawMm 原始距离(mm)，小于0（回波丢失）或超出量程都按丢失处理
+  * @param  NowMs 测量时刻(ms)，用于变化率门限
+  * @retval 本次测量的处理结果
+  * @detail 丢失不会改变估计距离，只增大方差、降低置信度，
+  *         所以近距离丢回波时输出仍是最后的近距离，而不是“前方安全”
+  */
+RangeFilterStatus RangeFilter_Update(RangeFilter *Filter, int32_t RawMm, uint32_t NowMs)
+{
+	const RangeFilterConfig *cfg = &Filter->cfg;
+	uint32_t dt, allowed, diff;
+	uint32_t k;
+	int32_t z;
+
+	if (RawMm < cfg->min_mm || RawMm > cfg->max_mm)
+	{
+		if (Filter->misses < 255)
+		{
+			Filter->misses++;
+		}
+		if (Filter->status != RANGE_FILTER_NONE)
+		{
+			Filter->p = RangeFilter_AddVar(Filter->p, RANGE_FILTER_MISS_FACTOR * cfg->measure_noise);
+			Filter->status = RANGE_FILTER_LOST;
+		}
+		return Filter->status;
+	}
+
+	Filter->samples[Filter->index] = (uint16_t)RawMm;
+	Filter->index = (Filter->index + 1) % cfg->window;
+	if (Filter->count < cfg->window)
+	{
+		Filter->count++;
+	}
+	z = RangeFilter_Median(Filter);
+
+	if (Filter->status == RANGE_FILTER_NONE)
+	{
+		Filter->x = z;
+		Filter->p = cfg->measure_noise;
+		Filter->last_ms = NowMs;
+		Filter->misses = 0;
+		Filter->status = RANGE_FILTER_OK;
+		return Filter->status;
+	}
+
+	//变化率门限：距上次接受的时间越长，允许的变化越大
+	if (cfg->max_rate)
+	{
+		dt = NowMs - Filter->last_ms;
+		if (dt > RANGE_FILTER_MAX_DT_MS)
+		{
+			dt = RANGE_FILTER_MAX_DT_MS;
+		}
+		allowed = cfg->gate_floor_mm + (uint32_t)cfg->max_rate * dt / 1000;
+		diff = (z > Filter->x) ? (uint32_t)(z - Filter->x) : (uint32_t)(Filter->x - z);
+		if (diff > allowed)
+		{
+			if (Filter->rejects < cfg->max_rejects)
+			{
+				Filter->rejects++;
+				Filter->p = RangeFilter_AddVar(Filter->p, cfg->process_noise);
+				Filter->status = RANGE_FILTER_GATED;
+				return Filter->status;
+			}
+			//连续多次都是这个值，是真的跳变（例如障碍物突然出现），直接采用
+			Filter->x = z;
+			Filter->p = cfg->measure_noise;
+		}
+	}
+
+	if (cfg->use_kalman)
+	{
+		Filter->p = RangeFilter_AddVar(Filter->p, cfg->process_noise);
+		k = (uint32_t)(((uint64_t)Filter->p << 16) / ((uint64_t)Filter->p + cfg->measure_noise));
+		Filter->x += (int32_t)(((int64_t)k * (z - Filter->x) + 32768) >> 16);
+		Filter->p = (uint32_t)(((uint64_t)(65536 - k) * Filter->p) >> 16);
+	}
+	else
+	{
+		Filter->x = z;
+		Filter->p = RangeFilter_WindowVar(Filter);
+	}
+
+	Filter->last_ms = NowMs;
+	Filter->rejects = 0;
+	Filter->misses = 0;
+	Filter->status = RANGE_FILTER_OK;
+	return Filter->status;
+}
+
+/**
+  * @brief  读取当前估计
+  * @param  Filter 滤波器
+  * @param  Out 输出：距离、方差、置信度和状态
+  * @retval 无
+  */
+void RangeFilter_Get(const RangeFilter *Filter, RangeEstimate *Out)
+{
+	uint32_t h = Filter->cfg.half_conf_var;
+
+	Out->status = Filter->status;
+	if (Filter->status == RANGE_FILTER_NONE)
+	{
+		Out->distance_mm = 0;
+		Out->variance = 0xFFFFFFFF;
+		Out->confidence = 0;
+		return;
+	}
+	Out->distance_mm = (Filter->x < 0) ? 0 : (uint16_t)Filter->x;
+	Out->variance = Filter->p;
+	Out->confidence = (uint8_t)((uint64_t)100 * h / ((uint64_t)h + Filter->p));
+}
@@ -0,0 +1,63 @@
+#ifndef __RANGE_FILTER_H
+#define __RANGE_FILTER_H
+
+#include <stdint.h>
+
+// 测距滤波：中值窗口 -> 变化率门限 -> 一维卡尔曼（可关）
+// 全部用整数运算（距离单位mm，方差单位mm^2，增益Q16），不依赖任何外设，
+// 可以直接在PC上编译；test/RangeFilterTest.c回放test/data/range_*.csv的测距序列（make -C test）
+
+#define RANGE_FILTER_WINDOW_MAX   7     // 中值窗口最大长度
+
+// 输出状态
+typedef enum
+{
+	RANGE_FILTER_NONE = 0,	// 还没有任何有效测量
+	RANGE_FILTER_OK,		// 最近一次测量被接受
+	RANGE_FILTER_GATED,		// 最近一次测量变化太快被拒绝，沿用估计值
+	RANGE_FILTER_LOST		// 最近一次没有回波，沿用估计值
+} RangeFilterStatus;
+
+typedef struct
+{
+	uint8_t window;				// 中值窗口长度，1~RANGE_FILTER_WINDOW_MAX，1表示不做中值
+	uint16_t min_mm;			// 有效量程
+	uint16_t max_mm;
+	uint16_t max_rate;			// 允许的最大变化速度(mm/s)，0表示不做门限
+	uint16_t gate_floor_mm;		// 门限的固定余量，吸收单次测量的噪声
+	uint8_t max_rejects;		// 连续被拒绝这么多次后认为是真实跳变，直接采用新值
+	uint8_t use_kalman;			// 0时估计值直接取中值输出
+	uint32_t process_noise;		// Q：每次更新方差增加量(mm^2)
+	uint32_t measure_noise;		// R：单次测量方差(mm^2)
+	uint32_t half_conf_var;		// 方差为该值时置信度为50%
+} RangeFilterConfig;
+
+typedef struct
+{
+	RangeFilterConfig cfg;
+	uint16_t samples[RANGE_FILTER_WINDOW_MAX];
+	uint8_t count;
+	uint8_t index;
+	int32_t x;					// 估计距离(mm)
+	uint32_t p;					// 估计方差(mm^2)
+	uint32_t last_ms;			// 上次接受测量的时刻
+	uint8_t rejects;			// 连续被门限拒绝的次数
+	uint8_t misses;				// 连续丢失的次数
+	RangeFilterStatus status;
+} RangeFilter;
+
+typedef struct
+{
+	uint16_t distance_mm;
+	uint32_t variance;			// mm^2
+	uint8_t confidence;			// 0~100
+	RangeFilterStatus status;
+} RangeEstimate;
+
+void RangeFilter_DefaultConfig(RangeFilterConfig *Cfg);
+void RangeFilter_Init(RangeFilter *Filter, const RangeFilterConfig *Cfg);
+void RangeFilter_Reset(RangeFilter *Filter);
+RangeFilterStatus RangeFilter_Update(RangeFilter *Filter, int32_t RawMm, uint32_t NowMs);
+void RangeFilter_Get(const RangeFilter *Filter, RangeEstimate *Out);
+
+#endif
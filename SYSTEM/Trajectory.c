@@ -0,0 +1,133 @@
+#include "Trajectory.h"
+#include "Q15Table.h"
+
+#define TRAJ_ONE			65536	//S的1.0
+
+//10s^3-15s^4+6s^5，s=0~1，Q15
+static const int16_t Trajectory_MinJerkTable[Q15_TABLE_SIZE + 1] =
+{
+	0, 1, 10, 31, 73, 139, 233, 361,
+	526, 730, 975, 1264, 1598, 1977, 2403, 2875,
+	3392, 3954, 4560, 5209, 5898, 6626, 7390, 8189,
+	9018, 9875, 10757, 11661, 12583, 13520, 14469, 15424,
+	16384, 17343, 18298, 19247, 20184, 21106, 22010, 22892,
+	23749, 24578, 25377, 26141, 26869, 27558, 28207, 28813,
+	29375, 29892, 30364, 30790, 31169, 31503, 31792, 32037,
+	32241, 32406, 32534, 32628, 32694, 32736, 32757, 32766,
+	32767
+};
+
+//s^3-2s^2+s，s=0~1，Q15（Hermite基函数h10，起点斜率的权重）
+//终点斜率的权重h11(s)=-h10(1-s)，共用这张表
+static const int16_t Trajectory_TangentTable[Q15_TABLE_SIZE + 1] =
+{
+	0, 496, 961, 1395, 1800, 2176, 2523, 2843,
+	3136, 3403, 3645, 3862, 4056, 4226, 4375, 4502,
+	4608, 4694, 4761, 4809, 4840, 4853, 4851, 4833,
+	4800, 4753, 4693, 4620, 4536, 4440, 4335, 4220,
+	4096, 3964, 3825, 3679, 3528, 3372, 3211, 3047,
+	2880, 2711, 2541, 2370, 2200, 2031, 1863, 1698,
+	1536, 1378, 1225, 1077, 936, 802, 675, 557,
+	448, 349, 261, 184, 120, 69, 31, 8,
+	0
+};
+
+/**
+  * @brief  归一化位置曲线
+  * @param  Profile TrajProfile
+  * @param  S 0~65536表示0~1
+  * @retval Q15，0~32767
+  */
+int16_t Trajectory_Shape(uint8_t Profile, uint32_t S)
+{
+	if (S > TRAJ_ONE)
+	{
+		S = TRAJ_ONE;
+	}
+	switch (Profile)
+	{
+		case TRAJ_CUBIC: return Q15Table_Lookup(Q15Table_Cubic, S);
+		case TRAJ_MIN_JERK: return Q15Table_Lookup(Trajectory_MinJerkTable, S);
+		default: return (int16_t)((S * 32767) >> 16);
+	}
+}
+
+/**
+  * @brief  开始一段轨迹
+  * @param  T 轨迹
+  * @param  From 起点(0.01度)
+  * @param  To 终点(0.01度)
+  * @param  DurationMs 时长，0表示下一次Step直接到终点
+  * @param  Profile TrajProfile
+  * @retval 无
+  */
+void Trajectory_Start(Trajectory *T, int16_t From, int16_t To, uint16_t DurationMs, uint8_t Profile)
+{
+	T->from = From;
+	T->to = To;
+	T->v0 = 0;
+	T->v1 = 0;
+	T->duration = DurationMs;
+	T->elapsed = 0;
+	T->profile = Profile;
+}
+
+/**
+  * @brief  设置三次Hermite的起止斜率
+  * @param  T 轨迹
+  * @param  V0 起点斜率，单位是"0.01度/整段时长"，即匀速走完整段时V0=To-From
+  * @param  V1 终点斜率
+  * @retval 无
+  * @detail 相邻两段在公共关键帧处的斜率按各自时长换算后相等，速度就连续
+  */
+void Trajectory_SetSlopes(Trajectory *T, int16_t V0, int16_t V1)
+{
+	T->v0 = V0;
+	T->v1 = V1;
+}
+
+/**
+  * @brief  求轨迹上一点
+  * @param  T 轨迹
+  * @param  S 0~65536表示从起点到终点
+  * @retval 角度(0.01度)
+  */
+int16_t Trajectory_Eval(const Trajectory *T, uint32_t S)
+{
+	int32_t x;
+
+	if (S >= TRAJ_ONE)
+	{
+		return T->to;
+	}
+	x = T->from + (((int32_t)(T->to - T->from) * Trajectory_Shape(T->profile, S)) >> 15);
+	if (T->profile == TRAJ_CUBIC && (T->v0 || T->v1))
+	{
+		x += ((int32_t)T->v0 * Q15Table_Lookup(Trajectory_TangentTable, S)) >> 15;
+		x -= ((int32_t)T->v1 * Q15Table_Lookup(Trajectory_TangentTable, TRAJ_ONE - S)) >> 15;
+	}
+	return (int16_t)x;
+}
+
+/**
+  * @brief  时间前进并求当前点（舵机帧回调里每帧调用一次）
+  * @param  T 轨迹
+  * @param  Ms 经过的时间(ms)
+  * @retval 角度(0.01度)，走完后一直是终点
+  */
+int16_t Trajectory_Step(Trajectory *T, uint16_t Ms)
+{
+	uint32_t e = (uint32_t)T->elapsed + Ms;
+
+	T->elapsed = (e >= T->duration) ? T->duration : (uint16_t)e;
+	if (T->elapsed >= T->duration)
+	{
+		return T->to;
+	}
+	return Trajectory_Eval(T, ((uint32_t)T->elapsed << 16) / T->duration);
+}
+
+uint8_t Trajectory_IsDone(const Trajectory *T)
+{
+	return T->elapsed >= T->duration;
+}
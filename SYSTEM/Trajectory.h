@@ -0,0 +1,37 @@
+#ifndef __TRAJECTORY_H
+#define __TRAJECTORY_H
+
+#include <stdint.h>
+
+// 两个关键帧之间的单关节插值轨迹，按舵机帧(20ms)逐帧求值：
+//   TRAJ_LINEAR    匀速，起止处速度突变
+//   TRAJ_CUBIC     三次Hermite，可给定起止斜率，经过中间关键帧时速度连续；斜率为0即3s^2-2s^3
+//   TRAJ_MIN_JERK  最小加加速度 10s^3-15s^4+6s^5，起止速度和加速度都为零，电流冲击最小
+// 基函数预先算成Q15表（64段，段内线性插值，见Q15Table），全部定点运算，只依赖stdint.h，主机测试见test/TrajectoryTest.c（make -C test）
+
+typedef enum
+{
+	TRAJ_LINEAR = 0,
+	TRAJ_CUBIC,
+	TRAJ_MIN_JERK
+} TrajProfile;
+
+typedef struct
+{
+	int16_t from;				//起点(0.01度)
+	int16_t to;					//终点(0.01度)
+	int16_t v0;					//起点斜率(0.01度/整段)，只用于TRAJ_CUBIC
+	int16_t v1;					//终点斜率
+	uint16_t duration;			//时长(ms)
+	uint16_t elapsed;			//已经过的时间(ms)
+	uint8_t profile;			//TrajProfile
+} Trajectory;
+
+void Trajectory_Start(Trajectory *T, int16_t From, int16_t To, uint16_t DurationMs, uint8_t Profile);
+void Trajectory_SetSlopes(Trajectory *T, int16_t V0, int16_t V1);
+int16_t Trajectory_Eval(const Trajectory *T, uint32_t S);
+int16_t Trajectory_Step(Trajectory *T, uint16_t Ms);
+uint8_t Trajectory_IsDone(const Trajectory *T);
+int16_t Trajectory_Shape(uint8_t Profile, uint32_t S);
+
+#endif
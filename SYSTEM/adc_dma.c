@@ -1,36 +1,60 @@
 /**********************************************
-*  ţ         v1.0
+*  ţ         v1.1
 *  ߣ         Ƕɷ
-*         ADCʼ
+*         ͨADCɨ裬DMA˫壬ƽ
 **********************************************/
 #include "adc_dma.h"
 #include "stm32f10x_adc.h"
 #include "stm32f10x_dma.h"
-u16 ADC_Value[10];
-  /* Configure PC.0-5 (ADC Channel10-15) as analog input -------------------------*/
+
+/* ѭDMAֳǰ룺DMAдʱCPUǰ루봫жϣ֮Ȼжϣ */
+static u16 ADC_Buffer[2][ADC_SCAN_DEPTH][ADC_CH_NUM];
+/* ָͨƽֵŴ16Сȡʱֱλ */
+static volatile u32 ADC_Average[ADC_CH_NUM];
+static volatile u32 ADC_Updates = 0;
+
+static const u8 ADC_Channels[ADC_CH_NUM] =
+{
+  ADC_BATTERY_CHANNEL,
+  ADC_Channel_17,       /* ڲοѹVDDA */
+  ADC_Channel_16,       /* ڲ¶ȴ */
+#if ADC_USE_CURRENT
+  ADC_CURRENT_CHANNEL,
+#endif
+};
 
 void ADC_DMA_Init(void)
 {
   ADC_InitTypeDef ADC_InitStructure;
   DMA_InitTypeDef DMA_InitStructure;
   GPIO_InitTypeDef GPIO_InitStructure;
+  NVIC_InitTypeDef NVIC_InitStructure;
+  u8 i;
+
+  /* ADCʱӲܳ14MHz72MHz/6 = 12MHz */
+  RCC_ADCCLKConfig(RCC_PCLK2_Div6);
 
   /* Enable DMA1 clock */
   RCC_AHBPeriphClockCmd(RCC_AHBPeriph_DMA1, ENABLE);
 
-  /* Enable ADC1 and GPIOC clock */
+  /* Enable ADC1 and GPIOB clock */
   RCC_APB2PeriphClockCmd(RCC_APB2Periph_ADC1 | RCC_APB2Periph_GPIOB, ENABLE);
   
-  /* Configure PC.0-5 (ADC Channel10-15) as analog input -------------------------*/
-  GPIO_InitStructure.GPIO_Pin = GPIO_Pin_1 ;
+  /* Configure analog inputs -------------------------------------------------*/
+  GPIO_InitStructure.GPIO_Pin = ADC_BATTERY_GPIO_PIN;
   GPIO_InitStructure.GPIO_Mode = GPIO_Mode_AIN;
-  GPIO_Init(GPIOB, &GPIO_InitStructure);
-    /* DMA1 channel1 configuration ----------------------------------------------*/
+  GPIO_Init(ADC_BATTERY_GPIO_PORT, &GPIO_InitStructure);
+#if ADC_USE_CURRENT
+  GPIO_InitStructure.GPIO_Pin = ADC_CURRENT_GPIO_PIN;
+  GPIO_Init(ADC_CURRENT_GPIO_PORT, &GPIO_InitStructure);
+#endif
+
+  /* DMA1 channel1 configuration ----------------------------------------------*/
   DMA_DeInit(DMA1_Channel1);
   DMA_InitStructure.DMA_PeripheralBaseAddr = ADC1_DR_Address;
-  DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t)ADC_Value;
+  DMA_InitStructure.DMA_MemoryBaseAddr = (uint32_t)ADC_Buffer;
   DMA_InitStructure.DMA_DIR = DMA_DIR_PeripheralSRC;
-  DMA_InitStructure.DMA_BufferSize = 10;
+  DMA_InitStructure.DMA_BufferSize = 2 * ADC_SCAN_DEPTH * ADC_CH_NUM;
   DMA_InitStructure.DMA_PeripheralInc = DMA_PeripheralInc_Disable;
   DMA_InitStructure.DMA_MemoryInc = DMA_MemoryInc_Enable;
   DMA_InitStructure.DMA_PeripheralDataSize = DMA_PeripheralDataSize_HalfWord;
@@ -39,6 +63,14 @@ void ADC_DMA_Init(void)
   DMA_InitStructure.DMA_Priority = DMA_Priority_High;
   DMA_InitStructure.DMA_M2M = DMA_M2M_Disable;
   DMA_Init(DMA1_Channel1, &DMA_InitStructure);
+
+  /* 봫ʹж */
+  DMA_ITConfig(DMA1_Channel1, DMA_IT_HT | DMA_IT_TC, ENABLE);
+  NVIC_InitStructure.NVIC_IRQChannel = DMA1_Channel1_IRQn;
+  NVIC_InitStructure.NVIC_IRQChannelPreemptionPriority = 2;
+  NVIC_InitStructure.NVIC_IRQChannelSubPriority = 1;
+  NVIC_InitStructure.NVIC_IRQChannelCmd = ENABLE;
+  NVIC_Init(&NVIC_InitStructure);
   
   /* Enable DMA1 channel1 */
   DMA_Cmd(DMA1_Channel1, ENABLE);
@@ -49,11 +81,15 @@ void ADC_DMA_Init(void)
   ADC_InitStructure.ADC_ContinuousConvMode = ENABLE;
   ADC_InitStructure.ADC_ExternalTrigConv = ADC_ExternalTrigConv_None;
   ADC_InitStructure.ADC_DataAlign = ADC_DataAlign_Right;
-  ADC_InitStructure.ADC_NbrOfChannel = 1;
+  ADC_InitStructure.ADC_NbrOfChannel = ADC_CH_NUM;
   ADC_Init(ADC1, &ADC_InitStructure);
 
-  /* ADC1 regular channel configuration */ 
-  ADC_RegularChannelConfig(ADC1, ADC_Channel_9, 1, ADC_SampleTime_55Cycles5);
+  /* ADC1 regular channel configuration¶ȴҪʱ>17.1usͳһ239.5 */
+  for(i = 0; i < ADC_CH_NUM; i++)
+  {
+    ADC_RegularChannelConfig(ADC1, ADC_Channels[i], i + 1, ADC_SampleTime_239Cycles5);
+  }
+  ADC_TempSensorVrefintCmd(ENABLE);
 
   /* Enable ADC1 DMA */
   ADC_DMACmd(ADC1, ENABLE);
@@ -75,11 +111,91 @@ void ADC_DMA_Init(void)
   ADC_SoftwareStartConvCmd(ADC1, ENABLE);
 }
 
-u16 GetADCValue(void)                     //ȡADCֵ
+/* ÿͨһΣٲָƽ */
+static void ADC_ProcessHalf(u8 Half)
+{
+  u32 sum;
+  u8 ch, n;
+
+  for(ch = 0; ch < ADC_CH_NUM; ch++)
+  {
+    sum = 0;
+    for(n = 0; n < ADC_SCAN_DEPTH; n++)
+      sum += ADC_Buffer[Half][n][ch];
+    sum = sum * 16 / ADC_SCAN_DEPTH;
+    if(ADC_Updates == 0)
+      ADC_Average[ch] = sum;        /* һֱΪֵ0 */
+    else
+      ADC_Average[ch] = ADC_Average[ch] - (ADC_Average[ch] >> ADC_EMA_SHIFT) + (sum >> ADC_EMA_SHIFT);
+  }
+  ADC_Updates++;
+}
+
+void DMA1_Channel1_IRQHandler(void)
+{
+  if(DMA_GetITStatus(DMA1_IT_HT1) != RESET)
+  {
+    DMA_ClearITPendingBit(DMA1_IT_HT1);
+    ADC_ProcessHalf(0);
+  }
+  if(DMA_GetITStatus(DMA1_IT_TC1) != RESET)
+  {
+    DMA_ClearITPendingBit(DMA1_IT_TC1);
+    ADC_ProcessHalf(1);
+  }
+}
+
+u16 ADC_GetRaw(ADC_ChannelIndex Channel)
+{
+  if(Channel >= ADC_CH_NUM)
+    return 0;
+  return (u16)((ADC_Average[Channel] + 8) >> 4);
+}
+
+u16 GetADCValue(void)                     //ȡADCֵ
+{
+  return ADC_GetRaw(ADC_CH_BATTERY);
+}
+
+/* ڲοѹ(1.20V)VDDAعʱ3.3Vѹһ׼ */
+u16 ADC_GetVdda_mV(void)
+{
+  u32 vref = ADC_Average[ADC_CH_VREFINT];
+  if(vref == 0)
+    return 3300;
+  return (u16)(1200UL * 4095 * 16 / vref);
+}
+
+static u32 ADC_ToMillivolt(ADC_ChannelIndex Channel)
+{
+  u32 vref = ADC_Average[ADC_CH_VREFINT];
+  if(vref == 0)
+    return (u32)ADC_GetRaw(Channel) * 3300 / 4095;
+  /* raw/vref * 1200mV߶Ŵ16ֱ */
+  return ADC_Average[Channel] * 1200 / vref;
+}
+
+u16 ADC_GetBattery_mV(void)
+{
+  return (u16)(ADC_ToMillivolt(ADC_CH_BATTERY) * (ADC_BATTERY_R_TOP + ADC_BATTERY_R_BOTTOM) / ADC_BATTERY_R_BOTTOM);
+}
+
+/* ֲֵ25ʱ1.43Vб4.3mV/棬¶ߵѹ½ */
+int16_t ADC_GetTemperature(void)
+{
+  int32_t mv = (int32_t)ADC_ToMillivolt(ADC_CH_TEMP);
+  return (int16_t)((1430 - mv) * 100 / 43 + 250);
+}
+
+#if ADC_USE_CURRENT
+int16_t ADC_GetCurrent_mA(void)
+{
+  int32_t mv = (int32_t)ADC_ToMillivolt(ADC_CH_CURRENT);
+  return (int16_t)((mv - ADC_GetVdda_mV() / 2) * 1000 / ADC_CURRENT_MV_PER_A);
+}
+#endif
+
+u32 ADC_GetUpdateCount(void)
 {
- u8 a;
- u32 tmp32;
- for(a=0;a<10;a++)
-	tmp32 +=ADC_Value[a];
- return (tmp32/10);
+  return ADC_Updates;
 }
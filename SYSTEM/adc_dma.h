@@ -4,9 +4,43 @@
 #define ADC3_DR_Address    ((u32)0x40013C4C)
 #define ADC1_DR_Address    ((uint32_t)0x4001244C)
 
-extern u16 ADC_Value[10];
-extern void ADC_DMA_Init(void);
-extern u16 GetADCValue(void);
+/* 扫描通道：PB1(ADC_IN9)是舵机1的PWM脚，不能再做模拟输入 */
+#define ADC_BATTERY_CHANNEL     ADC_Channel_8   /* PB0，电池电压分压 */
+#define ADC_BATTERY_GPIO_PORT   GPIOB
+#define ADC_BATTERY_GPIO_PIN    GPIO_Pin_0
+#define ADC_BATTERY_R_TOP       20              /* 分压电阻(kΩ)：电池 -- R_TOP -- PB0 -- R_BOTTOM -- GND */
+#define ADC_BATTERY_R_BOTTOM    10
+
+/* 舵机电源电流采样，4路舵机版本没有空闲的模拟引脚，默认不启用 */
+#define ADC_USE_CURRENT         0
+#define ADC_CURRENT_CHANNEL     ADC_Channel_9
+#define ADC_CURRENT_GPIO_PORT   GPIOB
+#define ADC_CURRENT_GPIO_PIN    GPIO_Pin_1
+#define ADC_CURRENT_MV_PER_A    185             /* 电流传感器灵敏度(mV/A)，零点按VDDA/2 */
+
+typedef enum
+{
+  ADC_CH_BATTERY = 0,
+  ADC_CH_VREFINT,
+  ADC_CH_TEMP,
+#if ADC_USE_CURRENT
+  ADC_CH_CURRENT,
+#endif
+  ADC_CH_NUM
+} ADC_ChannelIndex;
 
+#define ADC_SCAN_DEPTH   16   /* 每半个DMA缓冲区包含的扫描轮数 */
+#define ADC_EMA_SHIFT    3    /* 指数平均系数1/8，每半缓冲区更新一次（约1.3ms） */
+
+extern void ADC_DMA_Init(void);
+extern u16 GetADCValue(void);                     /* 兼容旧接口：电池通道原始值 */
+extern u16 ADC_GetRaw(ADC_ChannelIndex Channel);  /* 平均后的原始值0~4095，O(1) */
+extern u16 ADC_GetVdda_mV(void);
+extern u16 ADC_GetBattery_mV(void);
+extern int16_t ADC_GetTemperature(void);          /* 芯片温度，单位0.1℃ */
+#if ADC_USE_CURRENT
+extern int16_t ADC_GetCurrent_mA(void);
+#endif
+extern u32 ADC_GetUpdateCount(void);              /* 已处理的半缓冲区个数，0表示还没有数据 */
 
 #endif 
@@ -0,0 +1,81 @@
+#include "HostTest.h"
+#include "Format.h"
+
+// 主机测试：Format_UInt/Int/Fixed的输出、宽度和填充，包括INT32_MIN和UINT32_MAX
+// 缓冲区越界用 make -C test BUILD=build/asan CC="gcc -fsanitize=address,undefined" 检查
+
+// 输出缓冲区按最坏情况留足，后面放一段哨兵，检查没有写过界
+#define FORMAT_TEST_BUF		32
+#define FORMAT_TEST_GUARD	0x5A
+
+static char FormatTest_Buf[FORMAT_TEST_BUF + 8];
+
+static void FormatTest_Reset(void)
+{
+	memset(FormatTest_Buf, FORMAT_TEST_GUARD, sizeof(FormatTest_Buf));
+}
+
+static void FormatTest_Expect(const char *What, uint8_t Len, const char *Expected)
+{
+	uint8_t i;
+
+	CHECK(strcmp(FormatTest_Buf, Expected) == 0, "%s: \"%s\", expected \"%s\"", What, FormatTest_Buf, Expected);
+	CHECK(Len == strlen(Expected), "%s: returned %u, expected %u", What, Len, (unsigned)strlen(Expected));
+	for (i = FORMAT_TEST_BUF; i < sizeof(FormatTest_Buf); i++)
+	{
+		CHECK(FormatTest_Buf[i] == FORMAT_TEST_GUARD, "%s: wrote past the buffer", What);
+	}
+}
+
+#define FORMAT_TEST(Call, Expected) \
+	do \
+	{ \
+		FormatTest_Reset(); \
+		FormatTest_Expect(#Call, Call, Expected); \
+	} while (0)
+
+static void FormatTest_UInt(void)
+{
+	FORMAT_TEST(Format_UInt(FormatTest_Buf, 0, 0, ' '), "0");
+	FORMAT_TEST(Format_UInt(FormatTest_Buf, 42, 5, ' '), "   42");
+	FORMAT_TEST(Format_UInt(FormatTest_Buf, 42, 5, '0'), "00042");
+	FORMAT_TEST(Format_UInt(FormatTest_Buf, 12345, 3, '0'), "345");		//超宽只保留低位
+	FORMAT_TEST(Format_UInt(FormatTest_Buf, UINT32_MAX, 0, ' '), "4294967295");
+	FORMAT_TEST(Format_UInt(FormatTest_Buf, UINT32_MAX, 12, '0'), "004294967295");
+}
+
+static void FormatTest_Int(void)
+{
+	FORMAT_TEST(Format_Int(FormatTest_Buf, -7, 0, ' '), "-7");
+	FORMAT_TEST(Format_Int(FormatTest_Buf, -7, 4, ' '), "  -7");
+	FORMAT_TEST(Format_Int(FormatTest_Buf, -7, 4, '0'), "-007");
+	FORMAT_TEST(Format_Int(FormatTest_Buf, 7, 4, '0'), "0007");
+	FORMAT_TEST(Format_Int(FormatTest_Buf, INT32_MAX, 0, ' '), "2147483647");
+	FORMAT_TEST(Format_Int(FormatTest_Buf, INT32_MIN, 0, ' '), "-2147483648");
+	FORMAT_TEST(Format_Int(FormatTest_Buf, INT32_MIN, 13, ' '), "  -2147483648");
+	FORMAT_TEST(Format_Int(FormatTest_Buf, INT32_MIN, 13, '0'), "-002147483648");
+}
+
+static void FormatTest_Fixed(void)
+{
+	FORMAT_TEST(Format_Fixed(FormatTest_Buf, -1234, 2, 0), "-12.34");
+	FORMAT_TEST(Format_Fixed(FormatTest_Buf, 5, 2, 0), "0.05");
+	FORMAT_TEST(Format_Fixed(FormatTest_Buf, -5, 2, 0), "-0.05");
+	FORMAT_TEST(Format_Fixed(FormatTest_Buf, 1234, 0, 0), "1234");
+	FORMAT_TEST(Format_Fixed(FormatTest_Buf, 1234, 1, 8), "   123.4");
+	FORMAT_TEST(Format_Fixed(FormatTest_Buf, 1, 12, 0), "0.000000001");	//小数位数限制为9
+	FORMAT_TEST(Format_Fixed(FormatTest_Buf, INT32_MAX, 1, 0), "214748364.7");
+	FORMAT_TEST(Format_Fixed(FormatTest_Buf, INT32_MIN, 0, 0), "-2147483648");
+	FORMAT_TEST(Format_Fixed(FormatTest_Buf, INT32_MIN, 1, 0), "-214748364.8");
+	FORMAT_TEST(Format_Fixed(FormatTest_Buf, INT32_MIN, 2, 0), "-21474836.48");
+	FORMAT_TEST(Format_Fixed(FormatTest_Buf, INT32_MIN, 9, 0), "-2.147483648");
+	FORMAT_TEST(Format_Fixed(FormatTest_Buf, INT32_MIN, 2, 14), "  -21474836.48");
+}
+
+int main(void)
+{
+	FormatTest_UInt();
+	FormatTest_Int();
+	FormatTest_Fixed();
+	return HostTest_Finish("FormatTest");
+}
@@ -0,0 +1,205 @@
+#include <math.h>
+#include "HostTest.h"
+#include "GaitGen.h"
+
+// 主机测试：查表函数的精度，以及默认对角小跑一个周期内各腿的摆角、抬腿量和相位关系
+#define GAIT_TEST_FRAME_MS		20
+#define GAIT_TEST_PI			3.14159265358979
+
+static int GaitTest_Near(int32_t Value, int32_t Target, int32_t Tol)
+{
+	return Value >= Target - Tol && Value <= Target + Tol;
+}
+
+// 正弦和三次曲线与公式的偏差
+static void GaitTest_Tables(void)
+{
+	uint32_t x;
+	double Err, MaxSin = 0, MaxCubic = 0, S;
+
+	for (x = 0; x < 65536; x++)
+	{
+		Err = fabs(GaitGen_Sin((uint16_t)x) - sin(x * 2 * GAIT_TEST_PI / 65536) * 32767);
+		if (Err > MaxSin)
+		{
+			MaxSin = Err;
+		}
+		S = x / 65536.0;
+		Err = fabs(GaitGen_Cubic((uint16_t)x) - (3 * S * S - 2 * S * S * S) * 32767);
+		if (Err > MaxCubic)
+		{
+			MaxCubic = Err;
+		}
+	}
+	CHECK(MaxSin <= 16, "sin: max error %.1f Q15", MaxSin);
+	CHECK(MaxCubic <= 16, "cubic: max error %.1f Q15", MaxCubic);
+}
+
+// 2Hz、每帧20ms：每25帧走完一个周期
+static void GaitTest_Cycle(void)
+{
+	GaitGen G;
+	int Frame, Last = 0, Wraps = 0;
+
+	GaitGen_Init(&G, NULL);
+	for (Frame = 1; Frame <= 250; Frame++)
+	{
+		if (GaitGen_Advance(&G, GAIT_TEST_FRAME_MS))
+		{
+			CHECK(Frame - Last == 25, "cycle: wrapped after %d frames", Frame - Last);
+			Last = Frame;
+			Wraps++;
+		}
+	}
+	CHECK(Wraps == 10 && G.cycles == 10, "cycle: %d wraps, %u cycles in 5s", Wraps, (unsigned)G.cycles);
+}
+
+// 默认参数一个周期：摆幅不超过A，逐帧变化有上限（摆动相三次曲线峰值速度为平均的1.5倍），
+// 对角两腿同相、两组相差半周，支撑相不抬腿、摆动相中间抬到最高
+static void GaitTest_Trot(void)
+{
+	GaitGen G, Half;
+	int16_t Out[GAIT_LEGS], Prev[GAIT_LEGS], Lift[GAIT_LEGS], HalfOut[GAIT_LEGS];
+	int32_t MaxStep = 0, MaxLift = 0;
+	int Frame, i, Stance = 0, Swing = 0;
+
+	GaitGen_Init(&G, NULL);
+	GaitGen_Eval(&G, Prev, Lift);
+	CHECK(Prev[0] == 2000 && Lift[0] == 0, "trot: leg 0 starts at %d, lift %d", Prev[0], Lift[0]);
+	for (Frame = 0; Frame < 25 * 4; Frame++)
+	{
+		GaitGen_Advance(&G, GAIT_TEST_FRAME_MS / 4);
+		GaitGen_Eval(&G, Out, Lift);
+		Half = G;
+		Half.phase += 0x80000000u;
+		GaitGen_Eval(&Half, HalfOut, NULL);
+
+		CHECK(Out[0] == Out[3] && Out[1] == Out[2], "trot[%d]: diagonal legs %d/%d, %d/%d", Frame, Out[0], Out[3], Out[1], Out[2]);
+		CHECK(Out[1] == HalfOut[0], "trot[%d]: leg 1 %d is not leg 0 half a cycle later (%d)", Frame, Out[1], HalfOut[0]);
+		for (i = 0; i < GAIT_LEGS; i++)
+		{
+			CHECK(abs(Out[i]) <= 2000, "trot[%d]: leg %d at %d", Frame, i, Out[i]);
+			if (abs(Out[i] - Prev[i]) > MaxStep)
+			{
+				MaxStep = abs(Out[i] - Prev[i]);
+			}
+			Prev[i] = Out[i];
+		}
+		if (Lift[0] == 0)
+		{
+			Stance++;
+		}
+		else
+		{
+			Swing++;
+			MaxLift = Lift[0] > MaxLift ? Lift[0] : MaxLift;
+		}
+	}
+	CHECK(MaxStep * 4 <= 560, "trot: %d per frame at most, expected <= 533", MaxStep * 4);
+	CHECK(GaitTest_Near(Stance, 55, 2) && GaitTest_Near(Swing, 45, 2), "trot: %d stance / %d swing samples", Stance, Swing);
+	CHECK(MaxLift >= 32000, "trot: peak lift %d", MaxLift);
+}
+
+// 支撑相匀速从+A到-A；摆动相（两种曲线）回到+A，起止速度为零
+static void GaitTest_Stroke(uint8_t Profile)
+{
+	GaitGen G;
+	GaitParams P;
+	int16_t Out[GAIT_LEGS], Lift[GAIT_LEGS];
+	int32_t Duty = 550 * 65536 / 1000;
+
+	GaitGen_DefaultParams(&P);
+	P.profile = Profile;
+	GaitGen_Init(&G, &P);
+
+	G.phase = (uint32_t)(Duty / 2) << 16;
+	GaitGen_Eval(&G, Out, Lift);
+	CHECK(GaitTest_Near(Out[0], 0, 5), "stroke %u: mid stance at %d", Profile, Out[0]);
+	G.phase = (uint32_t)(Duty - 1) << 16;
+	GaitGen_Eval(&G, Out, Lift);
+	CHECK(GaitTest_Near(Out[0], -2000, 5), "stroke %u: end of stance at %d", Profile, Out[0]);
+	G.phase = (uint32_t)(Duty + 300) << 16;		//摆动相开始后约1%
+	GaitGen_Eval(&G, Out, Lift);
+	CHECK(GaitTest_Near(Out[0], -2000, 10), "stroke %u: swing left -A too fast, %d", Profile, Out[0]);
+	G.phase = (uint32_t)(Duty + (65536 - Duty) / 2) << 16;
+	GaitGen_Eval(&G, Out, Lift);
+	CHECK(GaitTest_Near(Out[0], 0, 10), "stroke %u: mid swing at %d", Profile, Out[0]);
+	CHECK(Lift[0] >= 32700, "stroke %u: mid swing lift %d", Profile, Lift[0]);
+	G.phase = 0xFFFFFFFFu - (300u << 16);
+	GaitGen_Eval(&G, Out, Lift);
+	CHECK(GaitTest_Near(Out[0], 2000, 10), "stroke %u: swing reached +A too fast, %d", Profile, Out[0]);
+}
+
+// 转向：turn=500左侧原地踏步，turn=1000左侧反向；右侧摆幅不变；负摆幅后退
+static void GaitTest_Turn(void)
+{
+	GaitGen Straight, Turn;
+	GaitParams P;
+	int16_t Ref[GAIT_LEGS], Out[GAIT_LEGS];
+	int Frame;
+
+	GaitGen_Init(&Straight, NULL);
+	for (Frame = 0; Frame < 25; Frame++)
+	{
+		GaitGen_Advance(&Straight, GAIT_TEST_FRAME_MS);
+		GaitGen_Eval(&Straight, Ref, NULL);
+
+		GaitGen_DefaultParams(&P);
+		P.turn = 500;
+		GaitGen_Init(&Turn, &P);
+		Turn.phase = Straight.phase;
+		GaitGen_Eval(&Turn, Out, NULL);
+		CHECK(Out[0] == 0 && Out[2] == 0 && Out[1] == Ref[1] && Out[3] == Ref[3],
+			  "turn 500[%d]: %d %d %d %d", Frame, Out[0], Out[1], Out[2], Out[3]);
+
+		Turn.p.turn = 1000;
+		GaitGen_Eval(&Turn, Out, NULL);
+		CHECK(GaitTest_Near(Out[0], -Ref[0], 1) && GaitTest_Near(Out[2], -Ref[2], 1) && Out[1] == Ref[1] && Out[3] == Ref[3],
+			  "turn 1000[%d]: %d %d %d %d", Frame, Out[0], Out[1], Out[2], Out[3]);
+
+		Turn.p.turn = 0;
+		Turn.p.amplitude = -2000;
+		GaitGen_Eval(&Turn, Out, NULL);
+		CHECK(GaitTest_Near(Out[0], -Ref[0], 1) && GaitTest_Near(Out[1], -Ref[1], 1),
+			  "backward[%d]: %d %d", Frame, Out[0], Out[1]);
+	}
+}
+
+// 走到一半改步频：相位连续，腿不跳
+static void GaitTest_FreqChange(void)
+{
+	GaitGen G;
+	int16_t Before[GAIT_LEGS], After[GAIT_LEGS];
+	int Frame, i;
+
+	GaitGen_Init(&G, NULL);
+	for (Frame = 0; Frame < 13; Frame++)
+	{
+		GaitGen_Advance(&G, GAIT_TEST_FRAME_MS);
+	}
+	GaitGen_Eval(&G, Before, NULL);
+	G.p.freq_mhz = 1000;
+	GaitGen_Eval(&G, After, NULL);
+	for (i = 0; i < GAIT_LEGS; i++)
+	{
+		CHECK(Before[i] == After[i], "freq change: leg %d jumped %d -> %d", i, Before[i], After[i]);
+	}
+	GaitGen_Advance(&G, GAIT_TEST_FRAME_MS);
+	GaitGen_Eval(&G, After, NULL);
+	for (i = 0; i < GAIT_LEGS; i++)
+	{
+		CHECK(abs(After[i] - Before[i]) <= 300, "freq change: leg %d moved %d in one frame", i, After[i] - Before[i]);
+	}
+}
+
+int main(void)
+{
+	GaitTest_Tables();
+	GaitTest_Cycle();
+	GaitTest_Trot();
+	GaitTest_Stroke(GAIT_PROFILE_CUBIC);
+	GaitTest_Stroke(GAIT_PROFILE_SINE);
+	GaitTest_Turn();
+	GaitTest_FreqChange();
+	return HostTest_Finish("GaitGenTest");
+}
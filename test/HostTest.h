@@ -0,0 +1,84 @@
+#ifndef __HOST_TEST_H
+#define __HOST_TEST_H
+
+// 主机测试的公共部分：断言计数和传感器序列读取，只在PC上编译
+// 序列文件在test/data下，每行若干个逗号分隔的整数，'#'开头的行是说明
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifndef TEST_DATA_DIR
+#define TEST_DATA_DIR	"data"
+#endif
+
+static int HostTest_Failures = 0;
+
+#define CHECK(Cond, ...) \
+	do \
+	{ \
+		if (!(Cond)) \
+		{ \
+			printf("FAIL %s:%d: ", __FILE__, __LINE__); \
+			printf(__VA_ARGS__); \
+			printf("\n"); \
+			HostTest_Failures++; \
+		} \
+	} while (0)
+
+static inline FILE *HostTest_Open(const char *Name)
+{
+	char Path[256];
+	FILE *File;
+
+	snprintf(Path, sizeof(Path), "%s/%s", TEST_DATA_DIR, Name);
+	File = fopen(Path, "r");
+	if (!File)
+	{
+		printf("FAIL cannot open %s\n", Path);
+		exit(1);
+	}
+	return File;
+}
+
+/**
+  * @brief  读一行数据，跳过说明行和空行
+  * @retval 读到的整数个数，0表示文件结束
+  */
+static inline int HostTest_ReadRow(FILE *File, int32_t *Values, int Max)
+{
+	char Line[256], *p, *End;
+	int n;
+
+	while (fgets(Line, sizeof(Line), File))
+	{
+		if (Line[0] == '#' || Line[0] == '\n' || Line[0] == '\r')
+		{
+			continue;
+		}
+		for (n = 0, p = Line; n < Max; n++, p = End + 1)
+		{
+			Values[n] = (int32_t)strtol(p, &End, 10);
+			if (End == p)
+			{
+				break;
+			}
+			if (*End != ',')
+			{
+				n++;
+				break;
+			}
+		}
+		return n;
+	}
+	return 0;
+}
+
+static inline int HostTest_Finish(const char *Name)
+{
+	printf("%s: %s\n", Name, HostTest_Failures ? "FAILED" : "ok");
+	return HostTest_Failures ? 1 : 0;
+}
+
+#endif
@@ -0,0 +1,132 @@
+#include "HostTest.h"
+#include "IMU.h"
+
+// 回放test/data/imu_*.csv，采样率与MPU6050_SAMPLE_HZ相同
+#define IMU_TEST_RATE_HZ	200
+
+typedef void (*IMUTest_Probe)(int Frame, const IMU_Attitude *Att);
+
+// 逐帧送入IMU_Update，每帧之后调用Probe；返回帧数，Last为最后一帧之后的姿态
+static int IMUTest_Replay(const char *Name, IMUTest_Probe Probe, IMU_Attitude *Last)
+{
+	FILE *File = HostTest_Open(Name);
+	int32_t Row[6];
+	int16_t Accel[3], Gyro[3];
+	int i, n = 0;
+
+	IMU_Init(IMU_TEST_RATE_HZ);
+	while (HostTest_ReadRow(File, Row, 6) == 6)
+	{
+		for (i = 0; i < 3; i++)
+		{
+			Accel[i] = (int16_t)Row[i];
+			Gyro[i] = (int16_t)Row[3 + i];
+		}
+		IMU_Update(Accel, Gyro);
+		IMU_GetAttitude(Last);
+		if (Probe)
+		{
+			Probe(n, Last);
+		}
+		n++;
+	}
+	fclose(File);
+	return n;
+}
+
+static int IMUTest_Near(int32_t Value, int32_t Target, int32_t Tol)
+{
+	return Value >= Target - Tol && Value <= Target + Tol;
+}
+
+// 水平静止：倾角接近0，零偏估计后航向几乎不漂
+static void IMUTest_Level(void)
+{
+	IMU_Attitude Att;
+	int n = IMUTest_Replay("imu_level.csv", NULL, &Att);
+
+	CHECK(n == 20 * IMU_TEST_RATE_HZ, "imu_level: %d frames", n);
+	CHECK(Att.calibrated, "imu_level: gyro bias not calibrated");
+	CHECK(IMUTest_Near(Att.pitch, 0, 500), "imu_level: pitch %d mdeg", Att.pitch);
+	CHECK(IMUTest_Near(Att.roll, 0, 500), "imu_level: roll %d mdeg", Att.roll);
+	CHECK(IMUTest_Near(Att.yaw, 0, 300), "imu_level: yaw drifted %d mdeg in 20s", Att.yaw);
+}
+
+// 慢速转动：0.198度/秒低于每帧1毫度的分辨率，只靠积分余数才能累计出来
+static void IMUTest_SlowYaw(void)
+{
+	IMU_Attitude Att;
+	int32_t Expected = 13 * 10000 * 30 / IMU_GYRO_LSB_PER_DPS_X10;	//30秒，毫度
+	int n = IMUTest_Replay("imu_slow_yaw.csv", NULL, &Att);
+
+	CHECK(n == 31 * IMU_TEST_RATE_HZ, "imu_slow_yaw: %d frames", n);
+	CHECK(IMUTest_Near(Att.yaw, Expected, 300), "imu_slow_yaw: yaw %d mdeg, expected %d", Att.yaw, Expected);
+	CHECK(IMUTest_Near(Att.yaw_rate, 198, 150), "imu_slow_yaw: yaw rate %d mdeg/s", Att.yaw_rate);
+	CHECK(IMUTest_Near(Att.pitch, 0, 500) && IMUTest_Near(Att.roll, 0, 500),
+		  "imu_slow_yaw: tilt %d/%d mdeg", Att.pitch, Att.roll);
+}
+
+// 俯仰/横滚：转动过程中靠陀螺仪跟上（方向正确），静止后与加速度计一致
+static void IMUTest_TiltProbe(int Frame, const IMU_Attitude *Att)
+{
+	const int Hz = IMU_TEST_RATE_HZ;
+
+	if (Frame == 2 * Hz)		//抬头过程中间（1秒静止 + 1秒 x 10度/秒）
+	{
+		CHECK(IMUTest_Near(Att->pitch, 10000, 1000), "imu_tilt: mid pitch-up %d mdeg", Att->pitch);
+		CHECK(IMUTest_Near(Att->pitch_rate, 10000, 500), "imu_tilt: pitch rate %d mdeg/s", Att->pitch_rate);
+	}
+	if (Frame == 6 * Hz - 1)	//抬头后保持3秒
+	{
+		CHECK(IMUTest_Near(Att->pitch, 20000, 700), "imu_tilt: pitch %d mdeg after hold", Att->pitch);
+		CHECK(IMUTest_Near(Att->roll, 0, 500), "imu_tilt: roll %d mdeg after pitch-up", Att->roll);
+	}
+	if (Frame == 6 * Hz + 3 * Hz / 4)	//横滚过程中间
+	{
+		CHECK(IMUTest_Near(Att->roll, -7500, 1000), "imu_tilt: mid roll %d mdeg", Att->roll);
+	}
+}
+
+static void IMUTest_Tilt(void)
+{
+	IMU_Attitude Att;
+	int n = IMUTest_Replay("imu_tilt.csv", IMUTest_TiltProbe, &Att);
+
+	CHECK(n == 21 * IMU_TEST_RATE_HZ / 2, "imu_tilt: %d frames", n);
+	CHECK(IMUTest_Near(Att.pitch, 20000, 700), "imu_tilt: final pitch %d mdeg", Att.pitch);
+	CHECK(IMUTest_Near(Att.roll, -15000, 700), "imu_tilt: final roll %d mdeg", Att.roll);
+	CHECK(IMUTest_Near(Att.yaw, 0, 500), "imu_tilt: yaw %d mdeg", Att.yaw);
+}
+
+// 合加速度峰值：读后清零，两组轮换几次后仍然只报上次读取以来的峰值
+static void IMUTest_Peak(void)
+{
+	const int16_t Rest[3] = {0, 0, IMU_ACCEL_LSB_PER_G}, Impact[3] = {0, 0, 3 * IMU_ACCEL_LSB_PER_G}, Gyro[3] = {0, 0, 0};
+	uint32_t Peak;
+	int i;
+
+	IMU_Init(IMU_TEST_RATE_HZ);
+	IMU_TakePeakAccel();
+	CHECK(IMU_TakePeakAccel() == 0, "peak: not cleared after init");
+	for (i = 0; i < 4; i++)
+	{
+		IMU_Update(Rest, Gyro);
+		IMU_Update(Impact, Gyro);
+		IMU_Update(Rest, Gyro);
+		Peak = IMU_TakePeakAccel();
+		CHECK(Peak == 3000, "peak[%d]: %u mg after a 3g sample", i, (unsigned)Peak);
+		IMU_Update(Rest, Gyro);
+		Peak = IMU_TakePeakAccel();
+		CHECK(Peak == 1000, "peak[%d]: %u mg at rest", i, (unsigned)Peak);
+		CHECK(IMU_TakePeakAccel() == 0, "peak[%d]: not cleared", i);
+	}
+}
+
+int main(void)
+{
+	IMUTest_Level();
+	IMUTest_SlowYaw();
+	IMUTest_Tilt();
+	IMUTest_Peak();
+	return HostTest_Finish("IMUTest");
+}
@@ -0,0 +1,122 @@
+#include "HostTest.h"
+#include "RangeFilter.h"
+
+// 回放test/data/range_*.csv，参数与Ultrasonic.c相同（默认参数）
+#define RANGE_TRACE_MAX		256
+
+typedef struct
+{
+	int32_t ms;
+	int32_t raw;
+	RangeEstimate est;
+} RangeStep;
+
+static RangeStep Steps[RANGE_TRACE_MAX];
+
+static int RangeTest_Replay(const char *Name)
+{
+	RangeFilter Filter;
+	FILE *File = HostTest_Open(Name);
+	int32_t Row[2];
+	int n = 0;
+
+	RangeFilter_Init(&Filter, NULL);
+	while (n < RANGE_TRACE_MAX && HostTest_ReadRow(File, Row, 2) == 2)
+	{
+		Steps[n].ms = Row[0];
+		Steps[n].raw = Row[1];
+		RangeFilter_Update(&Filter, Row[1], (uint32_t)Row[0]);
+		RangeFilter_Get(&Filter, &Steps[n].est);
+		n++;
+	}
+	fclose(File);
+	return n;
+}
+
+static int RangeTest_Near(const RangeEstimate *Est, int Target, int Tol)
+{
+	return abs((int)Est->distance_mm - Target) <= Tol;
+}
+
+// 静止目标：收敛到真实距离，方差收敛到卡尔曼稳态（Q=100、R=400时约156mm^2）
+static void RangeTest_Static(void)
+{
+	int i, n = RangeTest_Replay("range_static.csv");
+	const RangeEstimate *Last = &Steps[n - 1].est;
+
+	CHECK(n == 100, "range_static: %d samples", n);
+	for (i = 5; i < n; i++)
+	{
+		CHECK(RangeTest_Near(&Steps[i].est, 1000, 15), "range_static[%d]: %u mm", i, Steps[i].est.distance_mm);
+		CHECK(Steps[i].est.status == RANGE_FILTER_OK, "range_static[%d]: status %d", i, Steps[i].est.status);
+	}
+	CHECK(RangeTest_Near(Last, 1000, 10), "range_static: final %u mm", Last->distance_mm);
+	CHECK(Last->variance >= 140 && Last->variance <= 170, "range_static: variance %u", Last->variance);
+	CHECK(Last->confidence >= 90, "range_static: confidence %u", Last->confidence);
+}
+
+// 回波丢失：距离保持最后的估计，方差逐次增大、置信度逐次下降；回波恢复后重新收敛
+static void RangeTest_Lost(void)
+{
+	int i, n = RangeTest_Replay("range_lost.csv");
+
+	CHECK(n == 80, "range_lost: %d samples", n);
+	for (i = 40; i < 50; i++)
+	{
+		CHECK(Steps[i].raw < 0, "range_lost[%d]: trace should be a lost echo", i);
+		CHECK(Steps[i].est.status == RANGE_FILTER_LOST, "range_lost[%d]: status %d", i, Steps[i].est.status);
+		CHECK(Steps[i].est.distance_mm == Steps[39].est.distance_mm, "range_lost[%d]: distance moved to %u", i, Steps[i].est.distance_mm);
+		CHECK(Steps[i].est.variance > Steps[i - 1].est.variance, "range_lost[%d]: variance did not grow", i);
+		CHECK(Steps[i].est.confidence <= Steps[i - 1].est.confidence, "range_lost[%d]: confidence rose", i);
+	}
+	CHECK(RangeTest_Near(&Steps[49].est, 500, 10), "range_lost: held %u mm", Steps[49].est.distance_mm);
+	CHECK(Steps[49].est.variance >= 10 * 1600, "range_lost: variance %u after 10 misses", Steps[49].est.variance);
+	CHECK(Steps[49].est.confidence <= 15, "range_lost: confidence %u after 10 misses", Steps[49].est.confidence);
+	CHECK(Steps[50].est.status == RANGE_FILTER_OK, "range_lost: first echo back, status %d", Steps[50].est.status);
+	CHECK(Steps[n - 1].est.confidence >= 90, "range_lost: confidence %u after recovery", Steps[n - 1].est.confidence);
+	CHECK(RangeTest_Near(&Steps[n - 1].est, 500, 10), "range_lost: final %u mm", Steps[n - 1].est.distance_mm);
+}
+
+// 单点尖峰（多径反射、近处串扰）：中值窗口去掉，输出不跟着跳
+static void RangeTest_Spike(void)
+{
+	int i, n = RangeTest_Replay("range_spike.csv");
+
+	CHECK(n == 120, "range_spike: %d samples", n);
+	for (i = 3; i < n; i++)
+	{
+		CHECK(RangeTest_Near(&Steps[i].est, 800, 20), "range_spike[%d]: raw %d -> %u mm", i, Steps[i].raw, Steps[i].est.distance_mm);
+		CHECK(Steps[i].est.confidence >= 80, "range_spike[%d]: confidence %u", i, Steps[i].est.confidence);
+	}
+}
+
+// 阶跃（障碍物突然出现）：中值窗口延迟1次，门限再拒绝max_rejects(2)次，第4个样本采用新距离
+static void RangeTest_Step(void)
+{
+	int i, Gated = 0, n = RangeTest_Replay("range_step.csv");
+
+	CHECK(n == 80, "range_step: %d samples", n);
+	CHECK(RangeTest_Near(&Steps[39].est, 1500, 15), "range_step: before %u mm", Steps[39].est.distance_mm);
+	CHECK(RangeTest_Near(&Steps[40].est, 1500, 15), "range_step: median should hold the first new sample, got %u mm", Steps[40].est.distance_mm);
+	for (i = 41; i < 43; i++)
+	{
+		Gated += Steps[i].est.status == RANGE_FILTER_GATED;
+		CHECK(RangeTest_Near(&Steps[i].est, 1500, 15), "range_step[%d]: gated sample moved to %u mm", i, Steps[i].est.distance_mm);
+	}
+	CHECK(Gated == 2, "range_step: %d gated samples, expected 2", Gated);
+	for (i = 43; i < n; i++)
+	{
+		CHECK(RangeTest_Near(&Steps[i].est, 400, 30), "range_step[%d]: %u mm", i, Steps[i].est.distance_mm);
+		CHECK(Steps[i].est.status == RANGE_FILTER_OK, "range_step[%d]: status %d", i, Steps[i].est.status);
+	}
+	CHECK(Steps[n - 1].est.confidence >= 90, "range_step: confidence %u", Steps[n - 1].est.confidence);
+}
+
+int main(void)
+{
+	RangeTest_Static();
+	RangeTest_Lost();
+	RangeTest_Spike();
+	RangeTest_Step();
+	return HostTest_Finish("RangeFilterTest");
+}
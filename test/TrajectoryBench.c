@@ -0,0 +1,119 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "Trajectory.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define TRAJ_BENCH_TSC			1
+#else
+#define TRAJ_BENCH_TSC			0
+#endif
+
+// 主机基准：三种曲线（和带斜率的三次Hermite）每次求值的耗时，并把逐帧轨迹写成CSV。
+// make -C test bench 运行，CSV在build/trajectory_trace.csv，格式与板上HARDWARE/TrajectoryTest.c
+// 从蓝牙输出的相同，可以直接对照；周期数是主机的TSC计数，只用于比较几种曲线和改动前后
+#define TRAJ_BENCH_COUNT		1000000		//每轮求值次数
+#define TRAJ_BENCH_ROUNDS		5			//取最快的一轮
+#define TRAJ_BENCH_TRACE_MS		600			//与板上的轨迹时长相同
+#define TRAJ_BENCH_FRAME_MS		20
+
+static const char *const TrajBench_Names[4] = {"linear", "cubic", "minjerk", "hermite"};
+static volatile int16_t TrajBench_Sink;		//防止求值被优化掉
+
+static uint64_t TrajBench_Now(void)
+{
+	struct timespec Ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &Ts);
+	return (uint64_t)Ts.tv_sec * 1000000000u + Ts.tv_nsec;
+}
+
+static uint64_t TrajBench_Cycles(void)
+{
+#if TRAJ_BENCH_TSC
+	return __rdtsc();
+#else
+	return 0;
+#endif
+}
+
+// 0度到90度，最后一条是带起止斜率的三次Hermite（途经点情形），与板上相同
+static void TrajBench_Setup(Trajectory *T)
+{
+	uint8_t i;
+
+	for (i = 0; i < 3; i++)
+	{
+		Trajectory_Start(&T[i], 0, 9000, TRAJ_BENCH_TRACE_MS, i);
+	}
+	Trajectory_Start(&T[3], 0, 9000, TRAJ_BENCH_TRACE_MS, TRAJ_CUBIC);
+	Trajectory_SetSlopes(&T[3], 4500, 4500);
+}
+
+static void TrajBench_Run(const Trajectory *T, const char *Name)
+{
+	uint64_t Ns, Cycles, BestNs = UINT64_MAX, BestCycles = UINT64_MAX;
+	uint32_t i;
+	int Round;
+
+	for (Round = 0; Round < TRAJ_BENCH_ROUNDS; Round++)
+	{
+		Ns = TrajBench_Now();
+		Cycles = TrajBench_Cycles();
+		for (i = 0; i < TRAJ_BENCH_COUNT; i++)
+		{
+			TrajBench_Sink = Trajectory_Eval(T, i & 0xFFFF);
+		}
+		Cycles = TrajBench_Cycles() - Cycles;
+		Ns = TrajBench_Now() - Ns;
+		BestNs = Ns < BestNs ? Ns : BestNs;
+		BestCycles = Cycles < BestCycles ? Cycles : BestCycles;
+	}
+	printf("BENCH %-8s %6.2f ns/eval", Name, (double)BestNs / TRAJ_BENCH_COUNT);
+	if (TRAJ_BENCH_TSC)
+	{
+		printf("  %6.2f cyc/eval", (double)BestCycles / TRAJ_BENCH_COUNT);
+	}
+	printf("\n");
+}
+
+// 每个舵机帧一行：ms,linear,cubic,minjerk,hermite，角度单位0.01度
+static void TrajBench_Trace(const Trajectory *T, const char *Path)
+{
+	FILE *File = fopen(Path, "w");
+	uint32_t Ms;
+	uint8_t i;
+
+	if (!File)
+	{
+		printf("FAIL cannot write %s\n", Path);
+		exit(1);
+	}
+	fprintf(File, "ms,linear,cubic,minjerk,hermite\n");
+	for (Ms = 0; Ms <= TRAJ_BENCH_TRACE_MS; Ms += TRAJ_BENCH_FRAME_MS)
+	{
+		fprintf(File, "%u", (unsigned)Ms);
+		for (i = 0; i < 4; i++)
+		{
+			fprintf(File, ",%d", Trajectory_Eval(&T[i], (Ms << 16) / TRAJ_BENCH_TRACE_MS));
+		}
+		fprintf(File, "\n");
+	}
+	fclose(File);
+	printf("TRACE %s\n", Path);
+}
+
+int main(int argc, char **argv)
+{
+	Trajectory T[4];
+	uint8_t i;
+
+	TrajBench_Setup(T);
+	for (i = 0; i < 4; i++)
+	{
+		TrajBench_Run(&T[i], TrajBench_Names[i]);
+	}
+	TrajBench_Trace(T, argc > 1 ? argv[1] : "trajectory_trace.csv");
+	return 0;
+}
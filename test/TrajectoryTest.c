@@ -0,0 +1,108 @@
+#include <math.h>
+#include "HostTest.h"
+#include "Trajectory.h"
+
+// 主机测试：查表插值的精度、逐帧求值的端点和单调性、经过关键帧时的速度连续
+// 板上的耗时测量和轨迹输出见HARDWARE/TrajectoryTest.c
+#define TRAJ_TEST_FRAME_MS		20
+
+static double TrajTest_Reference(uint8_t Profile, double S)
+{
+	switch (Profile)
+	{
+		case TRAJ_CUBIC: return 3 * S * S - 2 * S * S * S;
+		case TRAJ_MIN_JERK: return S * S * S * (10 - 15 * S + 6 * S * S);
+		default: return S;
+	}
+}
+
+// 三种曲线与公式的偏差不超过Q15的0.05%
+static void TrajTest_Shape(void)
+{
+	uint8_t Profile;
+	uint32_t S;
+	double Err, MaxErr;
+
+	for (Profile = TRAJ_LINEAR; Profile <= TRAJ_MIN_JERK; Profile++)
+	{
+		MaxErr = 0;
+		for (S = 0; S <= 65536; S += 7)
+		{
+			Err = fabs(Trajectory_Shape(Profile, S) - TrajTest_Reference(Profile, S / 65536.0) * 32767);
+			if (Err > MaxErr)
+			{
+				MaxErr = Err;
+			}
+		}
+		CHECK(MaxErr <= 16, "shape %u: max error %.1f Q15", Profile, MaxErr);
+		CHECK(Trajectory_Shape(Profile, 0) == 0 && Trajectory_Shape(Profile, 65536) == 32767,
+			  "shape %u: endpoints %d/%d", Profile, Trajectory_Shape(Profile, 0), Trajectory_Shape(Profile, 65536));
+		CHECK(Trajectory_Shape(Profile, 100000) == 32767, "shape %u: S past the end is not clamped", Profile);
+	}
+}
+
+// 逐帧走完：单调、终点准确、IsDone；最小加加速度起步比匀速慢
+static void TrajTest_Step(void)
+{
+	Trajectory T;
+	int16_t Prev, X, First[3];
+	uint8_t Profile;
+	int Frames;
+
+	for (Profile = TRAJ_LINEAR; Profile <= TRAJ_MIN_JERK; Profile++)
+	{
+		Trajectory_Start(&T, -18000, 18000, 600, Profile);	//整个int16范围内不溢出
+		Prev = -18000;
+		for (Frames = 0; !Trajectory_IsDone(&T) && Frames < 100; Frames++)
+		{
+			X = Trajectory_Step(&T, TRAJ_TEST_FRAME_MS);
+			if (Frames == 0)
+			{
+				First[Profile] = X;
+			}
+			CHECK(X >= Prev, "step %u: frame %d went back %d -> %d", Profile, Frames, Prev, X);
+			Prev = X;
+		}
+		CHECK(Frames == 600 / TRAJ_TEST_FRAME_MS, "step %u: %d frames", Profile, Frames);
+		CHECK(Prev == 18000, "step %u: ended at %d", Profile, Prev);
+		CHECK(Trajectory_Step(&T, TRAJ_TEST_FRAME_MS) == 18000, "step %u: moved after the end", Profile);
+	}
+	CHECK(First[TRAJ_MIN_JERK] - (-18000) < First[TRAJ_CUBIC] - (-18000) &&
+		  First[TRAJ_CUBIC] - (-18000) < First[TRAJ_LINEAR] - (-18000),
+		  "first frame: min-jerk %d, cubic %d, linear %d", First[TRAJ_MIN_JERK], First[TRAJ_CUBIC], First[TRAJ_LINEAR]);
+
+	Trajectory_Start(&T, 100, 200, 0, TRAJ_MIN_JERK);
+	CHECK(Trajectory_Step(&T, TRAJ_TEST_FRAME_MS) == 200 && Trajectory_IsDone(&T), "zero duration does not jump to the end");
+}
+
+// 两段三次Hermite经过中间关键帧：斜率按DogActions的方法（Catmull-Rom）给定，两侧速度相同
+static void TrajTest_Via(void)
+{
+	Trajectory A, B;
+	int16_t X, Prev = 0, LastA = 0, FirstB;
+	double Rate = 3000.0 / 800;		//0 -> 3000 共800ms，0.01度/ms
+	int16_t V = (int16_t)(Rate * 400);
+
+	Trajectory_Start(&A, 0, 1000, 400, TRAJ_CUBIC);
+	Trajectory_SetSlopes(&A, 0, V);
+	Trajectory_Start(&B, 1000, 3000, 400, TRAJ_CUBIC);
+	Trajectory_SetSlopes(&B, V, 0);
+	while (!Trajectory_IsDone(&A))
+	{
+		X = Trajectory_Step(&A, TRAJ_TEST_FRAME_MS);
+		LastA = X - Prev;
+		Prev = X;
+	}
+	CHECK(Prev == 1000, "via: first segment ended at %d", Prev);
+	FirstB = Trajectory_Step(&B, TRAJ_TEST_FRAME_MS) - Prev;
+	CHECK(fabs(LastA - Rate * TRAJ_TEST_FRAME_MS) <= 15 && fabs(FirstB - Rate * TRAJ_TEST_FRAME_MS) <= 15,
+		  "via: %d and %d per frame around the key frame, expected %.0f", LastA, FirstB, Rate * TRAJ_TEST_FRAME_MS);
+}
+
+int main(void)
+{
+	TrajTest_Shape();
+	TrajTest_Step();
+	TrajTest_Via();
+	return HostTest_Finish("TrajectoryTest");
+}
@@ -0,0 +1,91 @@
+#!/usr/bin/env python3
+# 生成test/data下的传感器序列，格式与板上采集的记录相同，主机测试逐行回放。
+# 序列按已知的运动和噪声模型合成（固定随机种子，重新生成结果不变），
+# 有实测记录时直接放进test/data，按同样的格式命名即可。
+import math
+import os
+import random
+
+DATA = os.path.join(os.path.dirname(os.path.abspath(__file__)), "data")
+RANGE_PERIOD_MS = 60  # 与ULTRASONIC_PERIOD_MS相同
+
+
+def write(name, header, rows):
+    with open(os.path.join(DATA, name), "w", newline="\n") as f:
+        for line in header:
+            f.write("# " + line + "\n")
+        for row in rows:
+            f.write(",".join(str(v) for v in row) + "\n")
+
+
+# 测距：每行 "时刻ms,原始距离mm"，-1表示回波丢失
+def range_traces():
+    rnd = random.Random(30)
+    noise = lambda: int(round(rnd.gauss(0, 8)))
+
+    rows = [(i * RANGE_PERIOD_MS, 1000 + noise()) for i in range(100)]
+    write("range_static.csv", ["1000mm static target, 8mm rms noise"], rows)
+
+    rows = [(i * RANGE_PERIOD_MS, 500 + noise()) for i in range(40)]
+    rows += [((40 + i) * RANGE_PERIOD_MS, -1) for i in range(10)]
+    rows += [((50 + i) * RANGE_PERIOD_MS, 500 + noise()) for i in range(30)]
+    write("range_lost.csv", ["500mm target, echoes lost for samples 40~49"], rows)
+
+    rows = []
+    for i in range(120):
+        raw = 800 + noise()
+        if i % 20 == 10:
+            raw = 3000  # 多径反射
+        elif i % 20 == 15:
+            raw = 60    # 近处串扰
+        rows.append((i * RANGE_PERIOD_MS, raw))
+    write("range_spike.csv", ["800mm target, single-sample spikes every 20 samples from 10 and 15"], rows)
+
+    rows = [(i * RANGE_PERIOD_MS, 1500 + noise()) for i in range(40)]
+    rows += [((40 + i) * RANGE_PERIOD_MS, 400 + noise()) for i in range(40)]
+    write("range_step.csv", ["obstacle steps from 1500mm to 400mm at sample 40"], rows)
+
+
+# IMU：每行 "ax,ay,az,gx,gy,gz" 原始值，IMU_RATE_HZ一行，量程与MPU6050.c的配置相同
+IMU_RATE_HZ = 200
+ACCEL_LSB_PER_G = 8192
+GYRO_LSB_PER_DPS = 65.5
+GYRO_BIAS = (21.4, -13.7, 7.3)  # 零偏带小数，平均值不是整数LSB
+
+
+def imu_rows(rnd, segments):
+    """segments: [(秒数, 俯仰速度度/秒, 横滚速度度/秒, 航向速度度/秒)]，从水平静止开始"""
+    pitch = roll = 0.0
+    rows = []
+    for seconds, pitch_dps, roll_dps, yaw_dps in segments:
+        for _ in range(int(seconds * IMU_RATE_HZ)):
+            pitch += pitch_dps / IMU_RATE_HZ
+            roll += roll_dps / IMU_RATE_HZ
+            p, r = math.radians(pitch), math.radians(roll)
+            acc = (math.sin(p), math.cos(p) * math.sin(r), math.cos(p) * math.cos(r))
+            # IMU_Update：roll_rate = gx，pitch_rate = -gy，yaw_rate = gz
+            rate = (roll_dps, -pitch_dps, yaw_dps)
+            row = [int(round(a * ACCEL_LSB_PER_G + rnd.gauss(0, 40))) for a in acc]
+            row += [int(round(w * GYRO_LSB_PER_DPS + b + rnd.gauss(0, 3))) for w, b in zip(rate, GYRO_BIAS)]
+            rows.append(row)
+    return rows
+
+
+def imu_traces():
+    rnd = random.Random(34)
+    header = "ax,ay,az,gx,gy,gz raw at %dHz, +-4g and +-500dps" % IMU_RATE_HZ
+
+    rows = imu_rows(rnd, [(20, 0, 0, 0)])
+    write("imu_level.csv", [header, "20s level and still"], rows)
+
+    rows = imu_rows(rnd, [(1, 0, 0, 0), (30, 0, 0, 13 / GYRO_LSB_PER_DPS)])
+    write("imu_slow_yaw.csv", [header, "1s still, then 30s yaw at 13 LSB (0.198 deg/s)"], rows)
+
+    rows = imu_rows(rnd, [(1, 0, 0, 0), (2, 10, 0, 0), (3, 0, 0, 0), (1.5, 0, -10, 0), (3, 0, 0, 0)])
+    write("imu_tilt.csv", [header, "1s still, pitch up 20deg over 2s, hold 3s, roll -15deg over 1.5s, hold 3s"], rows)
+
+
+if __name__ == "__main__":
+    os.makedirs(DATA, exist_ok=True)
+    range_traces()
+    imu_traces()